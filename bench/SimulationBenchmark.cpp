@@ -0,0 +1,607 @@
+// Headless simulation benchmarks - no window or GL context required.
+// Usage: ./SimulationBenchmark [section]   (runs every section when omitted)
+#include "simulation/SimulationEngine.h"
+#include "simulation/SpatialGrid.h"
+#include "audio/AudioEventQueue.h"
+#include "core/SimulationClock.h"
+#include "core/ByteStream.h"
+#include "ai/AISystem.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdlib>
+#include <cstdio>
+#include <functional>
+
+using namespace TS;
+
+namespace {
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Random mixed-team population at constant density (~one unit per 30x30 area)
+void MakeUnits(UnitStore& store, int count, unsigned seed) {
+    std::mt19937 gen(seed);
+    float extent = std::sqrt((float)count) * 30.0f * 0.5f;
+    std::uniform_real_distribution<float> pos(-extent, extent);
+    
+    store.Clear();
+    store.Reserve(count);
+    for (int i = 0; i < count; ++i) {
+        UnitType type = static_cast<UnitType>(i % 4);
+        store.Add(i + 1, type, glm::vec3(pos(gen), 0.0f, pos(gen)), i % 2 == 0);
+    }
+}
+
+void BenchContactScaling() {
+    std::cout << "\n=== Contact queries (linear scan vs uniform grid) ===" << std::endl;
+    
+    const int counts[] = {10, 100, 1000, 10000, 100000};
+    const int bruteForceLimit = 10000;
+    
+    for (int count : counts) {
+        UnitStore store;
+        MakeUnits(store, count, 42);
+        
+        SpatialGrid grid(Unit::ContactRange);
+        auto start = std::chrono::steady_clock::now();
+        grid.Build(store);
+        int gridContacts = 0;
+        std::vector<int> gridResult(count);
+        for (int i = 0; i < count; ++i) {
+            gridResult[i] = Unit(&store, i).FindContact(grid);
+            gridContacts += gridResult[i] >= 0;
+        }
+        double gridSeconds = SecondsSince(start);
+        
+        std::cout << std::setw(7) << count << " units: grid " << std::fixed << std::setprecision(3)
+                  << std::setw(9) << gridSeconds * 1000.0 << " ms";
+        
+        if (count <= bruteForceLimit) {
+            start = std::chrono::steady_clock::now();
+            int mismatches = 0;
+            for (int i = 0; i < count; ++i) {
+                mismatches += Unit(&store, i).FindContact() != gridResult[i];
+            }
+            double linearSeconds = SecondsSince(start);
+            std::cout << " | linear " << std::setw(9) << linearSeconds * 1000.0 << " ms"
+                      << " | speedup " << std::setprecision(1) << linearSeconds / gridSeconds << "x"
+                      << (mismatches ? " | MISMATCH" : "");
+        } else {
+            std::cout << " | linear (skipped, quadratic)";
+        }
+        std::cout << " | " << gridContacts << " in contact" << std::endl;
+    }
+}
+
+// Heap-allocated unit with the pre-SoA field layout, used as the tick baseline
+struct LegacyUnit {
+    int id;
+    UnitType type;
+    bool isAllied;
+    glm::vec3 position;
+    glm::vec3 destination;
+    glm::vec3 targetPosition;
+    float health;
+    float maxHealth;
+    float movementSpeed;
+    UnitState state;
+    std::string lastCommand;
+    float commandFeedbackTimer;
+    int commandExecutionCount;
+};
+
+void BenchUnitStorage() {
+    std::cout << "\n=== Unit storage (unique_ptr AoS vs SoA store) ===" << std::endl;
+    
+    const int counts[] = {10000, 100000};
+    const int ticks = 100;
+    const float dt = 1.0f / 60.0f;
+    
+    for (int count : counts) {
+        UnitStore store;
+        MakeUnits(store, count, 7);
+        for (int i = 0; i < count; ++i) {
+            store.destination[i] = -store.position[i];
+            store.commands[i].lastCommand = "PATROLLING";
+        }
+        
+        // Interleave allocations with strings so the legacy objects scatter like long-lived ones do
+        std::vector<std::unique_ptr<LegacyUnit>> legacy(count);
+        std::vector<std::unique_ptr<std::string>> padding;
+        for (int i = 0; i < count; ++i) {
+            legacy[i] = std::make_unique<LegacyUnit>(LegacyUnit{
+                store.id[i], store.type[i], store.allied[i] != 0, store.position[i], store.destination[i],
+                store.destination[i], store.health[i], store.maxHealth[i], store.movementSpeed[i],
+                UnitState::MOVING, "PATROLLING", 0.0f, 0});
+            padding.push_back(std::make_unique<std::string>(64 + i % 64, 'x'));
+        }
+        std::shuffle(legacy.begin(), legacy.end(), std::mt19937(3));
+        
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < ticks; ++t) {
+            for (auto& u : legacy) {
+                if (u->health <= 0.0f) continue;
+                glm::vec3 direction = u->destination - u->position;
+                float distance = glm::length(direction);
+                if (distance > 2.0f) {
+                    u->position += direction / distance * u->movementSpeed * dt;
+                }
+                if (u->commandFeedbackTimer > 0.0f) u->commandFeedbackTimer -= dt;
+            }
+        }
+        double legacySeconds = SecondsSince(start) / ticks;
+        
+        start = std::chrono::steady_clock::now();
+        for (int t = 0; t < ticks; ++t) {
+            for (size_t i = 0; i < store.Size(); ++i) {
+                if (store.health[i] <= 0.0f) continue;
+                glm::vec3 direction = store.destination[i] - store.position[i];
+                float distance = glm::length(direction);
+                if (distance > 2.0f) {
+                    store.position[i] += direction / distance * store.movementSpeed[i] * dt;
+                }
+                if (store.commandFeedbackTimer[i] > 0.0f) store.commandFeedbackTimer[i] -= dt;
+            }
+        }
+        double storeSeconds = SecondsSince(start) / ticks;
+        
+        std::cout << std::setw(7) << count << " units: AoS " << std::fixed << std::setprecision(3)
+                  << legacySeconds * 1000.0 << " ms/tick | SoA " << storeSeconds * 1000.0
+                  << " ms/tick | speedup " << std::setprecision(1) << legacySeconds / storeSeconds << "x" << std::endl;
+        
+        // Full engine tick over the store (one team only, so no contact feedback spam)
+        std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+        SimulationEngine engine;
+        for (int i = 0; i < count; ++i) {
+            engine.AddUnit(store.type[i], store.position[i], true);
+        }
+        engine.Start();
+        const int engineTicks = 10;
+        start = std::chrono::steady_clock::now();
+        for (int t = 0; t < engineTicks; ++t) {
+            engine.Update(dt);
+        }
+        double engineSeconds = SecondsSince(start) / engineTicks;
+        std::cout.rdbuf(coutBuffer);
+        
+        std::cout << std::setw(7) << count << " units: SimulationEngine::Update "
+                  << std::setprecision(3) << engineSeconds * 1000.0 << " ms/tick" << std::endl;
+    }
+}
+
+// 500 blue and 500 red units packed inside contact range of each other
+void MakeContactScenario(SimulationEngine& engine, int count) {
+    std::mt19937 gen(99);
+    std::uniform_real_distribution<float> pos(-8.0f, 8.0f);
+    for (int i = 0; i < count; ++i) {
+        engine.AddUnit(static_cast<UnitType>(i % 4), glm::vec3(pos(gen), 0.0f, pos(gen)), i % 2 == 0);
+    }
+    engine.Start();
+}
+
+void BenchAudioQueue() {
+    std::cout << "\n=== Contact tick latency (direct afplay vs audio queue) ===" << std::endl;
+    
+    const int contactUnits = 1000;
+    const int ticks = 5;
+    const float dt = 1.0f / 60.0f;
+    
+    // After: every contact posts into the queue and the tick moves on
+    AudioEventQueue queue(std::make_unique<NullAudioBackend>());
+    double queuedSeconds = 0.0;
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    {
+        SimulationEngine engine;
+        engine.SetAudioQueue(&queue);
+        MakeContactScenario(engine, contactUnits);
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < ticks; ++t) {
+            engine.Update(dt);
+        }
+        queuedSeconds = SecondsSince(start) / ticks;
+    }
+    
+    // Before: the same ticks with no sound, plus one blocking fork per sound as the old
+    // system("afplay ... &") calls did on the simulation thread
+    double silentSeconds = 0.0;
+    {
+        SimulationEngine engine;
+        MakeContactScenario(engine, contactUnits);
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < ticks; ++t) {
+            engine.Update(dt);
+        }
+        silentSeconds = SecondsSince(start) / ticks;
+    }
+    std::cout.rdbuf(coutBuffer);
+    
+    // Give the consumer a moment to drain before reading its counters
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    AudioEventQueue::Stats stats = queue.GetStats();
+    uint64_t soundsPerTick = stats.posted / ticks;
+    
+    const int forkSamples = 50;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < forkSamples; ++i) {
+        system("afplay /System/Library/Sounds/Ping.aiff > /dev/null 2>&1 &");
+    }
+    double forkSeconds = SecondsSince(start) / forkSamples;
+    double directSeconds = silentSeconds + forkSeconds * soundsPerTick;
+    
+    std::cout << contactUnits << " units in contact, " << soundsPerTick << " sounds/tick" << std::endl;
+    std::cout << "Direct afplay: " << std::fixed << std::setprecision(3) << directSeconds * 1000.0
+              << " ms/tick (" << forkSeconds * 1000.0 << " ms per fork)" << std::endl;
+    std::cout << "Audio queue:   " << queuedSeconds * 1000.0 << " ms/tick | speedup "
+              << std::setprecision(1) << directSeconds / queuedSeconds << "x" << std::endl;
+    std::cout << "Queue: " << stats.posted << " posted, " << stats.dispatched << " played, "
+              << stats.coalesced << " coalesced, " << stats.dropped << " dropped" << std::endl;
+}
+
+const int DeterminismUnits = 3000;
+const int DeterminismTicks = 10000;     // Hashes are compared after this many ticks
+const int DeterminismTimedTicks = 600;  // Tick time is taken over the first ones, while every unit is alive
+const int DeterminismOrderTicks = 120;  // The blue team is sent somewhere new this often
+const int DeterminismTerrainSize = 256;
+const float DeterminismStep = 1.0f / 60.0f;
+
+struct ScenarioResult {
+    uint64_t hash = 0;
+    double secondsPerTick = 0.0;  // Over the first DeterminismTimedTicks
+    size_t survivors = 0;
+};
+
+// Both teams spread over generated terrain, one unit in 32 a sensor, blue routed to a new point
+// every few seconds
+ScenarioResult RunScenario(int threads) {
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    TerrainEngine terrain;
+    terrain.GenerateRandomTerrain(DeterminismTerrainSize, DeterminismTerrainSize, 77);
+    SimulationEngine engine;
+    engine.SetTerrain(&terrain);
+    engine.SetSeed(12345);
+    engine.SetThreadCount(threads);
+    std::mt19937 gen(2024);
+    const float extent = DeterminismTerrainSize * 0.45f;
+    std::uniform_real_distribution<float> pos(-extent, extent);
+    for (int i = 0; i < DeterminismUnits; ++i) {
+        UnitType type = i % 32 == 3 ? UnitType::SENSOR : static_cast<UnitType>(i % 3);
+        engine.AddUnit(type, glm::vec3(pos(gen), 0.0f, pos(gen)), i % 2 == 0);
+    }
+    engine.Start();
+    ScenarioResult result;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < DeterminismTicks; ++t) {
+        if (t % DeterminismOrderTicks == 0) {
+            engine.CommandAlliedTo(glm::vec3(pos(gen), 0.0f, pos(gen)));
+        }
+        engine.Update(DeterminismStep);
+        if (t + 1 == DeterminismTimedTicks) {
+            result.secondsPerTick = SecondsSince(start) / DeterminismTimedTicks;
+        }
+    }
+    
+    std::cout.rdbuf(coutBuffer);
+    result.hash = engine.ComputeStateHash();
+    result.survivors = engine.GetUnitStore().Size();
+    return result;
+}
+
+// Each run happens in a fresh child process so no process-wide state leaks between runs
+ScenarioResult RunScenarioInChild(const std::string& self, int threads) {
+    std::string command = "\"" + self + "\" determinism-run " + std::to_string(threads);
+    ScenarioResult result;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) return result;
+    
+    char buffer[96] = {};
+    if (fgets(buffer, sizeof(buffer), pipe)) {
+        char* rest = nullptr;
+        result.hash = std::strtoull(buffer, &rest, 16);
+        result.secondsPerTick = std::strtod(rest, &rest);
+        result.survivors = std::strtoull(rest, nullptr, 10);
+    }
+    pclose(pipe);
+    return result;
+}
+
+// The same run at each thread count must end in the same state. Think, contact damage and unit
+// removal stay serial (they print and post sounds in slot order), so the tick time scales only
+// with the movement, contact search and sensor sweeps, and only up to the cores present.
+bool BenchDeterminism(const std::string& self) {
+    std::cout << "\n=== Parallel tick determinism ===" << std::endl;
+    
+    const int cores = std::max(1, (int)std::thread::hardware_concurrency());
+    const int threadCounts[] = {1, 2, 4, std::max(8, cores)};
+    std::cout << DeterminismUnits << " units on " << DeterminismTerrainSize << "x" << DeterminismTerrainSize
+              << " terrain, hashed after " << DeterminismTicks << " ticks, timed over the first " << DeterminismTimedTicks
+              << ", path orders every " << DeterminismOrderTicks << " ticks, " << cores << " hardware thread(s)" << std::endl;
+    
+    bool identical = true;
+    uint64_t reference = 0;
+    double referenceSeconds = 0.0;
+    for (int threads : threadCounts) {
+        ScenarioResult run = RunScenarioInChild(self, threads);
+        const double seconds = run.secondsPerTick;
+        if (threads == 1) {
+            reference = run.hash;
+            referenceSeconds = seconds;
+        }
+        bool match = run.hash != 0 && run.hash == reference;
+        identical = identical && match;
+        std::ostringstream line;
+        line << std::setw(2) << threads << " thread(s): " << std::hex << run.hash << std::dec << " (" << run.survivors
+             << " units left)" << std::fixed << std::setprecision(2) << "  " << seconds * 1000.0 << " ms/tick, speedup "
+             << (seconds > 0.0 ? referenceSeconds / seconds : 0.0) << "x"
+             << (threads > cores ? " (more threads than cores)" : "") << (match ? "  OK" : "  MISMATCH");
+        std::cout << line.str() << std::endl;
+    }
+    
+    return identical;
+}
+
+// Frame pacing against the simulation at 100x time compression: the raw frame delta as the
+// step, versus SimulationClock's fixed steps under steady and under jittery frames
+void BenchSimulationClock() {
+    std::cout << "\n=== Fixed-step clock at 100x ===" << std::endl;
+    
+    const float speed = 100.0f;
+    const int unitCount = 96;
+    const uint64_t steps = 3000;  // 50 simulated seconds at the default step
+    auto makeEngine = [&](SimulationEngine& engine) {
+        engine.SetSeed(12345);
+        std::mt19937 gen(2024);
+        std::uniform_real_distribution<float> pos(-30.0f, 30.0f);
+        for (int i = 0; i < unitCount; ++i) {
+            engine.AddUnit(static_cast<UnitType>(i % 4), glm::vec3(pos(gen), 0.0f, pos(gen)), i % 2 == 0);
+        }
+        engine.Start();
+    };
+    auto largestMove = [](const UnitStore& store) {
+        float largest = 0.0f;
+        for (size_t i = 0; i < store.Size(); ++i) {
+            largest = std::max(largest, glm::distance(store.position[i], store.previousPosition[i]));
+        }
+        return largest;
+    };
+    
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    
+    // Variable step: one simulation update per 60 Hz frame, whatever the frame delta
+    float variableMove = 0.0f;
+    {
+        SimulationEngine engine;
+        makeEngine(engine);
+        const float frame = 1.0f / 60.0f;
+        for (int f = 0; f * frame * speed < steps * SimulationClock::DefaultStep; ++f) {
+            engine.Update(frame * speed);
+            variableMove = std::max(variableMove, largestMove(engine.GetUnitStore()));
+        }
+    }
+    
+    struct Pacing {
+        const char* name;
+        std::function<float(int)> frame;
+    };
+    std::mt19937 jitter(5);
+    std::uniform_real_distribution<float> jitterFrame(0.004f, 0.040f);
+    const Pacing pacings[] = {
+        {"steady 60 Hz", [](int) { return 1.0f / 60.0f; }},
+        {"jittered 4-40 ms, 200 ms hitch every 50 frames", [&](int f) { return f % 50 == 49 ? 0.2f : jitterFrame(jitter); }},
+    };
+    struct Outcome {
+        ClockStats stats;
+        float largest = 0.0f;
+        double wallPerFrame = 0.0;
+        uint64_t hash = 0;
+    };
+    std::vector<Outcome> outcomes;
+    for (const Pacing& pacing : pacings) {
+        SimulationEngine engine;
+        makeEngine(engine);
+        SimulationClock clock;
+        clock.SetSpeed(speed);
+        Outcome outcome;
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; clock.GetStats().totalSteps < steps; ++f) {
+            clock.BeginFrame(pacing.frame(f));
+            while (clock.GetStats().totalSteps < steps && clock.NextStep()) {
+                engine.Update(clock.GetStep());
+                outcome.largest = std::max(outcome.largest, largestMove(engine.GetUnitStore()));
+            }
+        }
+        outcome.stats = clock.GetStats();
+        outcome.wallPerFrame = SecondsSince(start) / outcome.stats.frames;
+        outcome.hash = engine.ComputeStateHash();
+        outcomes.push_back(outcome);
+    }
+    
+    // One long stall: the clock runs its budget of steps and drops the rest
+    SimulationClock stalled;
+    stalled.SetSpeed(speed);
+    stalled.BeginFrame(5.0f);
+    int stallSteps = 0;
+    while (stalled.NextStep()) stallSteps++;
+    
+    std::cout.rdbuf(coutBuffer);
+    std::cout << unitCount << " units, " << steps << " steps of " << std::fixed << std::setprecision(4)
+              << SimulationClock::DefaultStep << " s (contact range " << std::setprecision(0) << Unit::ContactRange << ")"
+              << std::endl;
+    std::cout << "variable step, steady 60 Hz: " << std::setprecision(2) << speed / 60.0f
+              << " s per update, units jump up to " << std::setprecision(1) << variableMove << " per update" << std::endl;
+    for (size_t i = 0; i < outcomes.size(); ++i) {
+        const Outcome& o = outcomes[i];
+        std::cout << "fixed step, " << pacings[i].name << ": " << std::setprecision(1) << o.stats.SubstepsPerFrame()
+                  << " steps/frame (peak " << o.stats.peakSubsteps << "), " << o.stats.totalDroppedTime
+                  << " s dropped, " << std::setprecision(2) << o.wallPerFrame * 1000.0 << " ms/frame, jumps up to "
+                  << std::setprecision(1) << o.largest << ", hash " << std::hex << o.hash << std::dec
+                  << (o.hash == outcomes[0].hash ? "  OK" : "  MISMATCH") << std::endl;
+    }
+    std::cout << "5 s stall at " << std::setprecision(0) << speed << "x: " << stallSteps << " steps run, "
+              << std::setprecision(1) << stalled.GetStats().droppedTime << " s dropped" << std::endl;
+}
+
+// Save and restore of a running scenario: 100k units through memory and disk against the
+// 50 ms budget, then a routed scenario on terrain restored mid-run and checked against the
+// original as both run on
+void BenchSnapshot() {
+    std::cout << "\n=== Simulation snapshots ===" << std::endl;
+    
+    const int unitCount = 100000;
+    const double budgetSeconds = 0.050;
+    const int repeats = 5;
+    const std::string path = "simulation_bench.tssn";
+    
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    SimulationEngine engine;
+    engine.SetSeed(777);
+    std::mt19937 gen(2024);
+    float extent = std::sqrt((float)unitCount) * 30.0f * 0.5f;
+    std::uniform_real_distribution<float> pos(-extent, extent);
+    // One team, as in the throughput runs: once moving, everyone is held inside the patrol area,
+    // where two teams would spend the whole run in contact
+    for (int i = 0; i < unitCount; ++i) {
+        engine.AddUnit(static_cast<UnitType>(i % 4), glm::vec3(pos(gen), 0.0f, pos(gen)), true);
+    }
+    engine.Start();
+    for (int t = 0; t < 150; ++t) {
+        engine.Update(1.0f / 60.0f);
+    }
+    AISystem ai;
+    ai.Initialize();
+    ai.Update(10.0f);
+    
+    double writeSeconds = 1e9, saveSeconds = 1e9, loadSeconds = 1e9;
+    ByteWriter out;
+    for (int r = 0; r < repeats; ++r) {
+        out.Clear();
+        auto start = std::chrono::steady_clock::now();
+        engine.WriteSnapshot(out, &ai);
+        writeSeconds = std::min(writeSeconds, SecondsSince(start));
+        
+        start = std::chrono::steady_clock::now();
+        engine.SaveSnapshot(path, &ai);
+        saveSeconds = std::min(saveSeconds, SecondsSince(start));
+    }
+    SimulationEngine restored;
+    AISystem restoredAI;
+    bool loaded = true;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        loaded = restored.LoadSnapshot(path, &restoredAI) && loaded;
+        loadSeconds = std::min(loadSeconds, SecondsSince(start));
+    }
+    std::remove(path.c_str());
+    uint64_t savedHash = engine.ComputeStateHash();
+    uint64_t loadedHash = restored.ComputeStateHash();
+    for (int t = 0; t < 120; ++t) {
+        engine.Update(1.0f / 60.0f);
+        restored.Update(1.0f / 60.0f);
+    }
+    bool continued = engine.ComputeStateHash() == restored.ComputeStateHash();
+    
+    // Units routed over terrain, saved once while the path graph is still being built, once while
+    // their routes are being planned and once after the answers arrived; every restore must track
+    // the original. Group sizes put the red team on shared flow fields and the blue team on routes
+    // of their own.
+    const int routedUnits = 1000;
+    TerrainEngine terrain;
+    terrain.GenerateRandomTerrain(256, 256, 99);
+    auto makeRouted = [&](SimulationEngine& routed) {
+        routed.SetTerrain(&terrain);
+        routed.SetFlowFieldGroupSize(100);
+    };
+    SimulationEngine routed;
+    makeRouted(routed);
+    routed.SetSeed(4242);
+    std::mt19937 placement(11);
+    std::uniform_real_distribution<float> patrol(-30.0f, 30.0f);
+    for (int i = 0; i < routedUnits; ++i) {
+        routed.AddUnit(static_cast<UnitType>(i % 4), glm::vec3(patrol(placement), 0.0f, patrol(placement)), i % 2 == 0);
+    }
+    routed.Start();
+    const int saveTicks[] = {10, 122, 130};
+    const int saves = (int)(sizeof(saveTicks) / sizeof(saveTicks[0]));
+    const int endTick = 730;
+    ByteWriter routedOut[saves];
+    size_t withFlow = 0, withWaypoints = 0;
+    for (int t = 1; t <= endTick; ++t) {
+        routed.Update(1.0f / 60.0f);
+        for (int k = 0; k < saves; ++k) {
+            if (t == saveTicks[k]) routed.WriteSnapshot(routedOut[k]);
+        }
+        if (t == saveTicks[saves - 1]) {
+            for (const UnitPath& path : routed.GetUnitStore().paths) {
+                withFlow += path.flow != nullptr;
+                withWaypoints += !path.waypoints.empty();
+            }
+        }
+    }
+    bool routedOk = true;
+    double routedLoadSeconds = 0.0;
+    for (int k = 0; k < saves; ++k) {
+        SimulationEngine restoredRoutes;
+        makeRouted(restoredRoutes);
+        auto start = std::chrono::steady_clock::now();
+        routedOk = restoredRoutes.ReadSnapshot(routedOut[k].bytes.data(), routedOut[k].Size()) && routedOk;
+        routedLoadSeconds = std::max(routedLoadSeconds, SecondsSince(start));
+        for (int t = saveTicks[k]; t < endTick; ++t) {
+            restoredRoutes.Update(1.0f / 60.0f);
+        }
+        routedOk = routedOk && restoredRoutes.ComputeStateHash() == routed.ComputeStateHash();
+    }
+    std::cout.rdbuf(coutBuffer);
+    
+    // Every column as it sits in memory, for comparison
+    const size_t rawBytesPerUnit = sizeof(int) + sizeof(UnitType) + 1 + sizeof(UnitState) + 5 * sizeof(glm::vec3)
+                                   + 7 * sizeof(float) + sizeof(uint64_t);
+    auto verdict = [&](double seconds) { return seconds <= budgetSeconds ? "  OK" : "  OVER BUDGET"; };
+    std::cout << unitCount << " units: " << std::fixed << std::setprecision(2) << out.Size() / (1024.0 * 1024.0)
+              << " MB, " << std::setprecision(1) << (double)out.Size() / unitCount << " bytes/unit (columns in memory "
+              << rawBytesPerUnit << ")" << std::endl;
+    std::cout << "write to memory: " << std::setprecision(2) << writeSeconds * 1000.0 << " ms" << verdict(writeSeconds) << std::endl;
+    std::cout << "save to disk:    " << saveSeconds * 1000.0 << " ms" << verdict(saveSeconds) << std::endl;
+    std::cout << "load from disk:  " << loadSeconds * 1000.0 << " ms" << verdict(loadSeconds)
+              << (loaded ? "" : "  LOAD FAILED") << std::endl;
+    std::cout << "restored hash " << std::hex << loadedHash << std::dec << (loadedHash == savedHash ? "  OK" : "  MISMATCH")
+              << ", 120 ticks on" << (continued ? "  OK" : "  MISMATCH") << std::endl;
+    std::cout << "routed, " << routedUnits << " units on 256x256 terrain (path graph due at tick "
+              << SimulationEngine::PathLatencyTicks + 256 * 256 / SimulationEngine::PathFinderCellsPerTick
+              << "), saved at ticks " << saveTicks[0] << ", " << saveTicks[1] << " and " << saveTicks[2] << " ("
+              << withWaypoints << " on waypoints, " << withFlow << " on flow fields): " << routedOut[saves - 1].Size()
+              << " bytes, restored in up to " << routedLoadSeconds * 1000.0 << " ms, tick "
+              << endTick << (routedOk ? "  OK" : "  MISMATCH") << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string section = argc > 1 ? argv[1] : "";
+    
+    if (section == "determinism-run" && argc > 2) {
+        ScenarioResult run = RunScenario(std::atoi(argv[2]));
+        std::cout << std::hex << run.hash << " " << std::scientific << run.secondsPerTick << " " << std::dec
+                  << run.survivors << std::endl;
+        return 0;
+    }
+    
+    if (section.empty() || section == "contact") BenchContactScaling();
+    if (section.empty() || section == "storage") BenchUnitStorage();
+    if (section.empty() || section == "audio") BenchAudioQueue();
+    if (section.empty() || section == "clock") BenchSimulationClock();
+    if (section.empty() || section == "snapshot") BenchSnapshot();
+    
+    bool ok = true;
+    if (section.empty() || section == "determinism") ok = BenchDeterminism(argv[0]) && ok;
+    
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,1329 @@
+// Headless terrain benchmarks - no window or GL context required.
+// Usage: ./TerrainBenchmark [section]   (runs every section when omitted)
+#include "terrain/TerrainEngine.h"
+#include "graphics/Camera.h"
+#include "terrain/CompactTerrainMesh.h"
+#include "terrain/TerrainGenerator.h"
+#include "terrain/TerrainLOD.h"
+#include "terrain/PathService.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include <unistd.h>
+
+using namespace TS;
+
+namespace {
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BenchLineOfSight() {
+    std::cout << "\n=== Line of sight (batched heightfield DDA) ===" << std::endl;
+    
+    const int gridSizes[] = {256, 1024, 4096};
+    const size_t rayCount = 200000;
+    const float maxRange = 200.0f;  // Cells between observer and target
+    // Ground observers, and observers on towers or aircraft whose rays pass high over most nodes
+    const float eyeHeights[] = {2.0f, 50.0f};
+    
+    for (int size : gridSizes) {
+        TerrainEngine terrain;
+        terrain.GenerateRandomTerrain(size, size, 20240611);  // Fixed, so runs compare like for like
+        
+        for (float eyeHeight : eyeHeights) {
+            std::mt19937 gen(1234);
+            std::uniform_real_distribution<float> pos(-size * 0.5f, size * 0.5f - 1.0f);
+            std::uniform_real_distribution<float> offset(-maxRange, maxRange);
+            
+            std::vector<std::pair<glm::vec3, glm::vec3>> rays(rayCount);
+            for (auto& ray : rays) {
+                float fx = pos(gen), fz = pos(gen);
+                float tx = std::clamp(fx + offset(gen), -size * 0.5f, size * 0.5f - 1.0f);
+                float tz = std::clamp(fz + offset(gen), -size * 0.5f, size * 0.5f - 1.0f);
+                ray.first = glm::vec3(fx, terrain.GetElevationAt(fx, fz) + eyeHeight, fz);
+                ray.second = glm::vec3(tx, terrain.GetElevationAt(tx, tz) + 2.0f, tz);
+            }
+            std::vector<uint8_t> visible(rayCount), visibleFlat(rayCount);
+            
+            // Every cell along each ray, as before the min/max pyramid
+            terrain.SetHierarchicalLineOfSight(false);
+            auto start = std::chrono::steady_clock::now();
+            terrain.HasLineOfSight(rays, visibleFlat);
+            double flatSeconds = SecondsSince(start);
+            
+            terrain.SetHierarchicalLineOfSight(true);
+            start = std::chrono::steady_clock::now();
+            terrain.HasLineOfSight(rays, visible);
+            double seconds = SecondsSince(start);
+            
+            size_t visibleCount = 0, agree = 0;
+            for (size_t i = 0; i < rayCount; ++i) {
+                visibleCount += visible[i];
+                agree += visible[i] == visibleFlat[i];
+            }
+            
+            std::cout << std::setw(5) << size << "^2 grid, eye +" << std::setw(2) << std::setprecision(0) << eyeHeight
+                      << ": " << std::fixed << std::setprecision(0) << rayCount / seconds << " rays/s  ("
+                      << std::setprecision(1) << 100.0 * visibleCount / rayCount << "% visible, " << std::setprecision(3)
+                      << seconds * 1000.0 << " ms; every cell " << flatSeconds * 1000.0 << " ms, "
+                      << std::setprecision(2) << flatSeconds / seconds << "x; " << agree << "/" << rayCount
+                      << " agree)" << std::endl;
+        }
+        
+        // Region queries: pyramid against a scan of the same rectangle
+        const HeightPyramid& pyramid = terrain.GetHeightPyramid();
+        const glm::vec3 extent = terrain.GetTerrainSize();
+        // Same heights as the engine's, regenerated from its seed
+        std::vector<float> heights((size_t)size * size);
+        TerrainGenerator(terrain.GetSeed()).GenerateBlock(0, 0, size, size, heights.data(), size);
+        std::mt19937 gen(99);
+        std::uniform_int_distribution<int> corner(0, size - 1), span(1, std::min(size, 256));
+        std::vector<GridRect> rects(20000);
+        for (GridRect& rect : rects) {
+            rect.x0 = corner(gen);
+            rect.z0 = corner(gen);
+            rect.x1 = rect.x0 + span(gen);
+            rect.z1 = rect.z0 + span(gen);
+        }
+        double checksum = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for (const GridRect& rect : rects) {
+            float lo = 0.0f, hi = 0.0f;
+            terrain.RegionMinMax(rect, lo, hi);
+            checksum += hi - lo;
+        }
+        double pyramidSeconds = SecondsSince(start);
+        double scanChecksum = 0.0;
+        start = std::chrono::steady_clock::now();
+        for (const GridRect& rect : rects) {
+            float lo = std::numeric_limits<float>::infinity(), hi = -lo;
+            for (int z = rect.z0; z <= std::min(rect.z1, size - 1); ++z) {
+                for (int x = rect.x0; x <= std::min(rect.x1, size - 1); ++x) {
+                    lo = std::min(lo, heights[(size_t)z * size + x]);
+                    hi = std::max(hi, heights[(size_t)z * size + x]);
+                }
+            }
+            scanChecksum += hi - lo;
+        }
+        double scanSeconds = SecondsSince(start);
+        std::cout << "       RegionMinMax (up to 256^2): " << std::setprecision(2)
+                  << pyramidSeconds * 1e6 / rects.size() << " us vs scan " << scanSeconds * 1e6 / rects.size()
+                  << " us per rect, " << (checksum == scanChecksum ? "same ranges" : "MISMATCH") << ", pyramid "
+                  << std::setprecision(1) << pyramid.GetMemoryBytes() / (1024.0 * 1024.0) << " MB for "
+                  << pyramid.GetLevelCount() << " levels over " << extent.x << "^2" << std::endl;
+    }
+}
+
+void BenchViewshed() {
+    std::cout << "\n=== Viewshed (R2 radial sweep vs per-cell LOS) ===" << std::endl;
+    
+    const int size = 1024;
+    const int sensorCount = 48;
+    const int radius = 128;
+    const float mastHeight = 10.0f;
+    
+    TerrainEngine terrain;
+    terrain.GenerateRandomTerrain(size, size);
+    
+    std::mt19937 gen(99);
+    std::uniform_real_distribution<float> pos(-size * 0.4f, size * 0.4f);
+    std::vector<glm::vec3> sensors(sensorCount);
+    for (auto& s : sensors) {
+        s.x = pos(gen);
+        s.z = pos(gen);
+        s.y = terrain.GetElevationAt(s.x, s.z) + mastHeight;
+    }
+    
+    std::vector<Viewshed> viewsheds(sensorCount);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < sensorCount; ++i) {
+        terrain.ComputeViewshed(sensors[i], radius, viewsheds[i]);
+    }
+    double sweepSeconds = SecondsSince(start);
+    
+    // Reference: one LOS ray per cell, for a handful of sensors only
+    const int rayCheckSensors = 4;
+    const int side = 2 * radius + 1;
+    std::vector<std::pair<glm::vec3, glm::vec3>> rays;
+    rays.reserve((size_t)side * side);
+    std::vector<uint8_t> visible((size_t)side * side);
+    size_t agree = 0, total = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rayCheckSensors; ++i) {
+        const Viewshed& v = viewsheds[i];
+        rays.clear();
+        for (int z = 0; z < side; ++z) {
+            for (int x = 0; x < side; ++x) {
+                float wx = (v.centerX - radius + x) - v.gridOffsetX;
+                float wz = (v.centerZ - radius + z) - v.gridOffsetZ;
+                glm::vec3 eye(v.centerX - v.gridOffsetX, sensors[i].y, v.centerZ - v.gridOffsetZ);
+                rays.emplace_back(eye, glm::vec3(wx, terrain.GetElevationAt(wx, wz) + 0.01f, wz));
+            }
+        }
+        terrain.HasLineOfSight(rays, visible);
+        for (size_t c = 0; c < visible.size(); ++c) {
+            agree += (visible[c] != 0) == (v.mask[c] != 0);
+        }
+        total += visible.size();
+    }
+    double raySeconds = SecondsSince(start) / rayCheckSensors * sensorCount;
+    
+    // Incremental mode: sub-cell jitter should not trigger recomputation
+    int recomputed = 0;
+    start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < 100; ++tick) {
+        for (int i = 0; i < sensorCount; ++i) {
+            glm::vec3 jittered = sensors[i] + glm::vec3(0.3f * (tick % 3), 0.0f, 0.0f);
+            recomputed += terrain.UpdateViewshed(jittered, radius, viewsheds[i]) ? 1 : 0;
+        }
+    }
+    double incrementalSeconds = SecondsSince(start) / 100.0;
+    
+    std::cout << std::fixed << std::setprecision(2)
+              << size << "^2 grid, " << sensorCount << " sensors, radius " << radius << std::endl
+              << "  radial sweep:      " << sweepSeconds * 1000.0 << " ms per tick" << std::endl
+              << "  per-cell LOS rays: " << raySeconds * 1000.0 << " ms per tick (extrapolated)" << std::endl
+              << "  incremental:       " << incrementalSeconds * 1000.0 << " ms per tick ("
+              << recomputed << " recomputes in 100 ticks)" << std::endl
+              << "  agreement with LOS rays: " << 100.0 * agree / total << "%" << std::endl;
+}
+
+
+void PrintLoad(const std::string& label, const HeightmapLoadStats& stats) {
+    std::cout << std::setw(30) << std::left << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << stats.bytesRead / (1024.0 * 1024.0) << " MB in "
+              << std::setprecision(3) << stats.seconds * 1000.0 << " ms = " << std::setprecision(0)
+              << stats.MegabytesPerSecond() << " MB/s | peak RSS "
+              << stats.peakResidentBytes / (1024 * 1024) << " MB" << (stats.zeroCopy ? " (zero-copy)" : "")
+              << std::endl;
+}
+
+void BenchHeightmapLoad() {
+    std::cout << "\n=== Heightmap loading (mmap raw, ESRI ASCII, windowed) ===" << std::endl;
+    
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path();
+    std::string hugePath = (dir / "ts_bench_huge.r32").string();
+    std::string floatPath = (dir / "ts_bench_4096.r32").string();
+    std::string shortPath = (dir / "ts_bench_4096.r16").string();
+    std::string asciiPath = (dir / "ts_bench_1024.asc").string();
+    
+    // 32768^2 float32 = 4 GB, created sparse so it costs no disk; only the window is paged in.
+    // Runs first so the RSS high-water mark reflects the window alone.
+    const int hugeSide = 32768;
+    {
+        FILE* file = std::fopen(hugePath.c_str(), "wb");
+        bool sized = file && ftruncate(fileno(file), (off_t)hugeSide * hugeSide * sizeof(float)) == 0;
+        if (file) std::fclose(file);
+        if (sized) {
+            HeightmapLoadOptions options;
+            options.windowX = hugeSide / 2;
+            options.windowZ = hugeSide / 2;
+            options.windowWidth = 1024;
+            options.windowHeight = 1024;
+            
+            size_t before = HeightmapLoader::PeakResidentBytes();
+            std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+            TerrainEngine terrain;
+            HeightmapLoadStats stats;
+            bool loaded = terrain.LoadTerrain(hugePath, options, &stats);
+            std::cout.rdbuf(coutBuffer);
+            if (loaded) {
+                PrintLoad("4 GB float32, 1024^2 window", stats);
+                std::cout << "  RSS grew by " << (stats.peakResidentBytes - std::min(before, stats.peakResidentBytes)) / (1024 * 1024)
+                          << " MB for a " << hugeSide << "^2 file" << std::endl;
+            }
+        }
+        std::remove(hugePath.c_str());
+    }
+    
+    // Source heights from the generator, written out in each format
+    const int side = 4096;
+    TerrainEngine source;
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    source.GenerateRandomTerrain(side, side);
+    std::cout.rdbuf(coutBuffer);
+    
+    std::vector<float> heights((size_t)side * side);
+    std::vector<uint16_t> shorts((size_t)side * side);
+    for (int z = 0; z < side; ++z) {
+        for (int x = 0; x < side; ++x) {
+            float h = source.GetElevationAt(x - side * 0.5f, z - side * 0.5f);
+            heights[(size_t)z * side + x] = h;
+            shorts[(size_t)z * side + x] = (uint16_t)std::clamp(h + 1000.0f, 0.0f, 65535.0f);
+        }
+    }
+    std::ofstream(floatPath, std::ios::binary).write(reinterpret_cast<const char*>(heights.data()), heights.size() * sizeof(float));
+    std::ofstream(shortPath, std::ios::binary).write(reinterpret_cast<const char*>(shorts.data()), shorts.size() * sizeof(uint16_t));
+    {
+        const int asciiSide = 1024;
+        std::ofstream ascii(asciiPath);
+        ascii << "ncols " << asciiSide << "\nnrows " << asciiSide
+              << "\nxllcorner 0\nyllcorner 0\ncellsize 30\nNODATA_value -9999\n" << std::setprecision(6);
+        for (int z = 0; z < asciiSide; ++z) {
+            for (int x = 0; x < asciiSide; ++x) {
+                ascii << heights[(size_t)z * side + x] << (x + 1 < asciiSide ? ' ' : '\n');
+            }
+        }
+    }
+    
+    struct Case {
+        const char* label;
+        std::string path;
+        HeightmapLoadOptions options;
+    };
+    HeightmapLoadOptions window;
+    window.windowX = 1024;
+    window.windowZ = 1024;
+    window.windowWidth = 512;
+    window.windowHeight = 512;
+    const Case cases[] = {
+        {"float32 4096^2 (full)", floatPath, HeightmapLoadOptions()},
+        {"uint16 4096^2 (full)", shortPath, HeightmapLoadOptions()},
+        {"float32 4096^2, 512^2 window", floatPath, window},
+        {"ESRI ASCII 1024^2", asciiPath, HeightmapLoadOptions()},
+    };
+    
+    for (const Case& c : cases) {
+        TerrainEngine terrain;
+        HeightmapLoadStats stats;
+        coutBuffer = std::cout.rdbuf(nullptr);
+        auto start = std::chrono::steady_clock::now();
+        bool loaded = terrain.LoadTerrain(c.path, c.options, &stats);
+        double engineSeconds = SecondsSince(start);
+        std::cout.rdbuf(coutBuffer);
+        if (loaded) {
+            PrintLoad(c.label, stats);
+            // The engine's share: the pyramid pass, which also gives mapped grids their height range
+            const HeightPyramid& pyramid = terrain.GetHeightPyramid();
+            std::cout << "  loaded with pyramid in " << std::setprecision(3) << engineSeconds * 1000.0 << " ms, pyramid "
+                      << pyramid.GetMemoryBytes() / 1024 << " KB from level " << pyramid.GetBaseLevel()
+                      << ", height span " << std::setprecision(1) << terrain.GetTerrainSize().y << std::endl;
+        } else {
+            std::cout << c.label << ": load failed" << std::endl;
+        }
+    }
+    std::cout << "(files were just written, so they load from the page cache)" << std::endl;
+    
+    std::remove(floatPath.c_str());
+    std::remove(shortPath.c_str());
+    std::remove(asciiPath.c_str());
+}
+
+void BenchTiledTerrain() {
+    std::cout << "\n=== Tiled terrain (LRU tile cache over a raw file) ===" << std::endl;
+    
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path();
+    std::string smallPath = (dir / "ts_bench_tiles_4096.r32").string();
+    std::string hugePath = (dir / "ts_bench_tiles_huge.r32").string();
+    
+    // Tiled queries must match the in-memory grid exactly, even with a cache far smaller than the map
+    const int side = 4096;
+    TerrainEngine dense;
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    dense.GenerateRandomTerrain(side, side);
+    std::cout.rdbuf(coutBuffer);
+    {
+        std::vector<float> heights((size_t)side * side);
+        for (int z = 0; z < side; ++z) {
+            for (int x = 0; x < side; ++x) {
+                heights[(size_t)z * side + x] = dense.GetElevationAt(x - side * 0.5f, z - side * 0.5f);
+            }
+        }
+        std::ofstream(smallPath, std::ios::binary).write(reinterpret_cast<const char*>(heights.data()), heights.size() * sizeof(float));
+    }
+    
+    auto makeRays = [](TerrainEngine& terrain, int size, size_t count, float maxRange, unsigned seed) {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> pos(-size * 0.5f, size * 0.5f - 1.0f);
+        std::uniform_real_distribution<float> offset(-maxRange, maxRange);
+        std::vector<std::pair<glm::vec3, glm::vec3>> rays(count);
+        for (auto& ray : rays) {
+            float fx = pos(gen), fz = pos(gen);
+            float tx = std::clamp(fx + offset(gen), -size * 0.5f, size * 0.5f - 1.0f);
+            float tz = std::clamp(fz + offset(gen), -size * 0.5f, size * 0.5f - 1.0f);
+            ray.first = glm::vec3(fx, terrain.GetElevationAt(fx, fz) + 2.0f, fz);
+            ray.second = glm::vec3(tx, terrain.GetElevationAt(tx, tz) + 2.0f, tz);
+        }
+        return rays;
+    };
+    
+    {
+        TerrainEngine tiled;
+        coutBuffer = std::cout.rdbuf(nullptr);
+        bool opened = tiled.LoadTiledTerrain(smallPath, HeightmapLoadOptions(), (size_t)16 << 20);
+        std::cout.rdbuf(coutBuffer);
+        if (opened) {
+            const size_t rayCount = 200000;
+            auto rays = makeRays(dense, side, rayCount, 200.0f, 1234);
+            std::vector<uint8_t> expected(rayCount), actual(rayCount);
+            
+            auto start = std::chrono::steady_clock::now();
+            dense.HasLineOfSight(rays, expected);
+            double denseSeconds = SecondsSince(start);
+            start = std::chrono::steady_clock::now();
+            tiled.HasLineOfSight(rays, actual);
+            double tiledSeconds = SecondsSince(start);
+            
+            size_t agree = 0;
+            for (size_t i = 0; i < rayCount; ++i) agree += expected[i] == actual[i];
+            TileStore::Stats stats = tiled.GetTileStore()->GetStats();
+            std::cout << std::fixed << side << "^2, 16 MB cache: " << std::setprecision(0)
+                      << rayCount / denseSeconds << " rays/s in memory vs " << rayCount / tiledSeconds
+                      << " rays/s tiled, " << std::setprecision(2) << 100.0 * agree / rayCount << "% agreement, "
+                      << 100.0 * stats.HitRate() << "% hits, " << stats.evictions << " evictions" << std::endl;
+        }
+    }
+    std::remove(smallPath.c_str());
+    
+    // 32768^2 float32 = 4 GB, sparse on disk. Queries cluster around a few hotspots the way a
+    // theatre's units do, plus a uniform background that keeps the cache cycling.
+    const int hugeSide = 32768;
+    const size_t budget = (size_t)512 << 20;
+    FILE* file = std::fopen(hugePath.c_str(), "wb");
+    bool sized = file && ftruncate(fileno(file), (off_t)hugeSide * hugeSide * sizeof(float)) == 0;
+    if (file) std::fclose(file);
+    if (sized) {
+        size_t rssBefore = HeightmapLoader::PeakResidentBytes();
+        TerrainEngine tiled;
+        coutBuffer = std::cout.rdbuf(nullptr);
+        bool opened = tiled.LoadTiledTerrain(hugePath, HeightmapLoadOptions(), budget);
+        std::cout.rdbuf(coutBuffer);
+        if (opened) {
+            const size_t queryCount = 400000;
+            std::mt19937 gen(77);
+            std::uniform_real_distribution<float> anywhere(-hugeSide * 0.5f, hugeSide * 0.5f - 1.0f);
+            std::normal_distribution<float> spread(0.0f, 600.0f);
+            std::uniform_real_distribution<float> offset(-200.0f, 200.0f);
+            glm::vec3 hotspots[8];
+            for (auto& h : hotspots) h = glm::vec3(anywhere(gen), 0.0f, anywhere(gen));
+            
+            std::vector<std::pair<glm::vec3, glm::vec3>> rays(queryCount);
+            for (size_t i = 0; i < queryCount; ++i) {
+                glm::vec3 base = i % 10 == 0 ? glm::vec3(anywhere(gen), 0.0f, anywhere(gen))
+                                             : hotspots[i % 8] + glm::vec3(spread(gen), 0.0f, spread(gen));
+                float fx = std::clamp(base.x, -hugeSide * 0.5f, hugeSide * 0.5f - 1.0f);
+                float fz = std::clamp(base.z, -hugeSide * 0.5f, hugeSide * 0.5f - 1.0f);
+                float tx = std::clamp(fx + offset(gen), -hugeSide * 0.5f, hugeSide * 0.5f - 1.0f);
+                float tz = std::clamp(fz + offset(gen), -hugeSide * 0.5f, hugeSide * 0.5f - 1.0f);
+                rays[i] = {glm::vec3(fx, 2.0f, fz), glm::vec3(tx, 2.0f, tz)};
+            }
+            
+            const TileStore& store = *tiled.GetTileStore();
+            auto report = [&](const char* label, double seconds, const TileStore::Stats& before) {
+                TileStore::Stats after = store.GetStats();
+                uint64_t hits = after.hits - before.hits;
+                uint64_t misses = after.misses - before.misses;
+                std::cout << "  " << std::left << std::setw(16) << label << std::right << std::fixed << std::setprecision(0)
+                          << queryCount / seconds << " queries/s, " << std::setprecision(1)
+                          << 100.0 * hits / std::max<uint64_t>(hits + misses, 1) << "% hits, " << misses << " misses, "
+                          << (after.bytesPagedIn - before.bytesPagedIn) / (1024.0 * 1024.0) << " MB paged in" << std::endl;
+            };
+            std::cout << hugeSide << "^2 (4 GB), " << (budget >> 20) << " MB cache (" << store.GetCapacity()
+                      << " tiles)" << std::endl;
+            
+            TileStore::Stats before = store.GetStats();
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < queryCount; ++i) {
+                tiled.GetElevationAt(rays[i].first.x, rays[i].first.z);
+            }
+            report("GetElevationAt", SecondsSince(start), before);
+            
+            std::vector<uint8_t> visible(queryCount);
+            before = store.GetStats();
+            start = std::chrono::steady_clock::now();
+            tiled.HasLineOfSight(rays, visible);
+            report("HasLineOfSight", SecondsSince(start), before);
+            
+            size_t peak = HeightmapLoader::PeakResidentBytes();
+            std::cout << "  " << store.GetStats().residentBytes / (1024 * 1024) << " MB of tiles resident, RSS grew by "
+                      << (peak - std::min(rssBefore, peak)) / (1024 * 1024) << " MB" << std::endl;
+        }
+    }
+    std::remove(hugePath.c_str());
+}
+
+
+void BenchGeneration() {
+    std::cout << "\n=== Procedural generation (separable octaves, row-parallel) ===" << std::endl;
+    
+    const int size = 4096;
+    const uint64_t seed = 20240611;
+    std::vector<int> threadCounts = {1, 4};
+    int hardware = (int)std::max(1u, std::thread::hardware_concurrency());
+    if (hardware != 1 && hardware != 4) threadCounts.push_back(hardware);
+    
+    uint64_t referenceHash = 0;
+    for (int threads : threadCounts) {
+        TerrainEngine terrain;
+        terrain.SetThreadCount(threads);
+        
+        std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+        auto start = std::chrono::steady_clock::now();
+        terrain.GenerateRandomTerrain(size, size, seed);
+        double seconds = SecondsSince(start);
+        std::cout.rdbuf(coutBuffer);
+        
+        // FNV-1a over the heights: must not depend on the thread count
+        uint64_t hash = 1469598103934665603ull;
+        for (int z = 0; z < size; ++z) {
+            for (int x = 0; x < size; ++x) {
+                float h = terrain.GetElevationAt(x - size * 0.5f, z - size * 0.5f);
+                uint32_t bits;
+                std::memcpy(&bits, &h, sizeof(bits));
+                hash = (hash ^ bits) * 1099511628211ull;
+            }
+        }
+        if (referenceHash == 0) referenceHash = hash;
+        
+        std::cout << size << "^2, " << std::setw(2) << threads << " thread(s): " << std::fixed << std::setprecision(1)
+                  << seconds * 1000.0 << " ms = " << std::setprecision(0) << (double)size * size / seconds
+                  << " cells/s  hash " << std::hex << hash << std::dec << (hash == referenceHash ? "  OK" : "  MISMATCH")
+                  << std::endl;
+    }
+}
+
+
+void BenchOnDemandTerrain() {
+    std::cout << "\n=== On-demand procedural terrain (startup vs full pre-generation) ===" << std::endl;
+    
+    const uint64_t seed = 20240611;
+    std::streambuf* coutBuffer;
+    
+    // On-demand heights must be bit-identical to pre-generated ones, tile seams included
+    {
+        const int size = 2048;
+        TerrainEngine dense, lazy;
+        coutBuffer = std::cout.rdbuf(nullptr);
+        dense.GenerateRandomTerrain(size, size, seed);
+        lazy.GenerateProceduralTerrain(size, size, seed, (size_t)64 << 20);
+        std::cout.rdbuf(coutBuffer);
+        
+        std::mt19937 gen(5);
+        std::uniform_real_distribution<float> pos(-size * 0.5f, size * 0.5f - 1.0f);
+        std::uniform_real_distribution<float> offset(-200.0f, 200.0f);
+        size_t pointsEqual = 0;
+        const size_t pointCount = 100000;
+        std::vector<std::pair<glm::vec3, glm::vec3>> rays(pointCount);
+        for (size_t i = 0; i < pointCount; ++i) {
+            float x = pos(gen), z = pos(gen);
+            pointsEqual += dense.GetElevationAt(x, z) == lazy.GetElevationAt(x, z);
+            float tx = std::clamp(x + offset(gen), -size * 0.5f, size * 0.5f - 1.0f);
+            float tz = std::clamp(z + offset(gen), -size * 0.5f, size * 0.5f - 1.0f);
+            rays[i] = {glm::vec3(x, dense.GetElevationAt(x, z) + 2.0f, z), glm::vec3(tx, dense.GetElevationAt(tx, tz) + 2.0f, tz)};
+        }
+        std::vector<uint8_t> expected(pointCount), actual(pointCount);
+        dense.HasLineOfSight(rays, expected);
+        lazy.HasLineOfSight(rays, actual);
+        size_t losEqual = 0;
+        for (size_t i = 0; i < pointCount; ++i) losEqual += expected[i] == actual[i];
+        std::cout << size << "^2 check: " << std::fixed << std::setprecision(2) << 100.0 * pointsEqual / pointCount
+                  << "% identical heights, " << 100.0 * losEqual / pointCount << "% identical LOS" << std::endl;
+    }
+    
+    // Startup to the first simulation tick: 200 units in a 600-cell patrol area each need their
+    // elevation, LOS to 8 neighbours and, for 16 of them, a sensor viewshed
+    auto firstTick = [](TerrainEngine& terrain) {
+        std::mt19937 gen(11);
+        std::uniform_real_distribution<float> pos(-300.0f, 300.0f);
+        std::vector<glm::vec3> units(200);
+        for (auto& u : units) {
+            u.x = pos(gen);
+            u.z = pos(gen);
+            u.y = terrain.GetElevationAt(u.x, u.z) + 2.0f;
+        }
+        std::vector<std::pair<glm::vec3, glm::vec3>> rays;
+        for (size_t i = 0; i < units.size(); ++i) {
+            for (size_t k = 1; k <= 8; ++k) rays.emplace_back(units[i], units[(i + k * 7) % units.size()]);
+        }
+        std::vector<uint8_t> visible(rays.size());
+        terrain.HasLineOfSight(rays, visible);
+        Viewshed viewshed;
+        for (int i = 0; i < 16; ++i) terrain.ComputeViewshed(units[i] + glm::vec3(0.0f, 8.0f, 0.0f), 64, viewshed);
+    };
+    
+    std::cout << std::setw(8) << "world" << std::setw(22) << "pre-generated" << std::setw(22) << "on demand"
+              << std::setw(16) << "tiles built" << std::endl;
+    const int worldSizes[] = {4096, 8192, 65536};
+    for (int size : worldSizes) {
+        std::cout << std::setw(6) << size << "^2" << std::fixed << std::setprecision(1);
+        
+        // 65536^2 would need 16 GB pre-generated
+        if ((size_t)size * size * sizeof(float) <= ((size_t)1 << 30)) {
+            TerrainEngine full;
+            coutBuffer = std::cout.rdbuf(nullptr);
+            auto start = std::chrono::steady_clock::now();
+            full.GenerateRandomTerrain(size, size, seed);
+            firstTick(full);
+            double seconds = SecondsSince(start);
+            std::cout.rdbuf(coutBuffer);
+            std::cout << std::setw(19) << seconds * 1000.0 << " ms";
+        } else {
+            std::cout << std::setw(22) << "(16 GB, skipped)";
+        }
+        
+        TerrainEngine lazy;
+        coutBuffer = std::cout.rdbuf(nullptr);
+        auto start = std::chrono::steady_clock::now();
+        lazy.GenerateProceduralTerrain(size, size, seed);
+        firstTick(lazy);
+        double seconds = SecondsSince(start);
+        std::cout.rdbuf(coutBuffer);
+        
+        TileStore::Stats stats = lazy.GetTileStore()->GetStats();
+        std::cout << std::setw(19) << seconds * 1000.0 << " ms" << std::setw(10) << stats.misses << " of "
+                  << (size_t)((size + 254) / 256) * ((size + 254) / 256) << std::endl;
+    }
+}
+
+
+void BenchElevationSampling() {
+    std::cout << "\n=== Elevation sampling (bilinear, per point vs batched) ===" << std::endl;
+    
+    const size_t sampleCount = 1000000;
+    const int gridSizes[] = {1024, 4096};
+    for (int size : gridSizes) {
+        TerrainEngine terrain;
+        std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+        terrain.GenerateRandomTerrain(size, size, 7);
+        std::cout.rdbuf(coutBuffer);
+        
+        // Unit-like positions, a few off the map to exercise the edge clamp
+        std::mt19937 gen(3);
+        std::uniform_real_distribution<float> pos(-size * 0.52f, size * 0.52f);
+        std::vector<float> xs(sampleCount), zs(sampleCount);
+        for (size_t i = 0; i < sampleCount; ++i) {
+            xs[i] = pos(gen);
+            zs[i] = pos(gen);
+        }
+        std::vector<float> single(sampleCount), batched(sampleCount);
+        
+        const int repeats = 5;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            for (size_t i = 0; i < sampleCount; ++i) {
+                single[i] = terrain.GetElevationAt(xs[i], zs[i]);
+            }
+        }
+        double singleSeconds = SecondsSince(start) / repeats;
+        
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            terrain.GetElevationBatch(xs.data(), zs.data(), batched.data(), sampleCount);
+        }
+        double batchSeconds = SecondsSince(start) / repeats;
+        
+        size_t equal = 0;
+        for (size_t i = 0; i < sampleCount; ++i) equal += single[i] == batched[i];
+        
+        std::cout << std::setw(5) << size << "^2, 1M samples: " << std::fixed << std::setprecision(2)
+                  << singleSeconds * 1000.0 << " ms per point, " << batchSeconds * 1000.0 << " ms batched ("
+                  << std::setprecision(1) << singleSeconds / batchSeconds << "x), "
+                  << 100.0 * equal / sampleCount << "% identical" << std::endl;
+    }
+}
+
+
+void BenchMeshBuild() {
+    std::cout << "\n=== Mesh build (CPU side, no GL): 44-byte vertices vs compact patches ===" << std::endl;
+    
+    const int size = 4096;
+    const float scale = 3.0f;  // TerrainEngine::Render's vertical scale
+    std::vector<float> heights((size_t)size * size);
+    TerrainGenerator(20240611).GenerateBlock(0, 0, size, size, heights.data(), (size_t)size);
+    
+    // What the old triangle list held: one TerrainVertex per vertex and 6 indices per quad
+    const double megabyte = 1024.0 * 1024.0;
+    double listBytes = (double)size * size * sizeof(TerrainVertex) + (double)(size - 1) * (size - 1) * 6 * sizeof(unsigned int);
+    std::cout << size << "^2 triangle list: " << std::fixed << std::setprecision(1) << listBytes / megabyte << " MB" << std::endl;
+    
+    TerrainMesh full;
+    auto start = std::chrono::steady_clock::now();
+    full.BuildGeometry(heights.data(), size, size, scale);
+    double fullSeconds = SecondsSince(start);
+    std::cout << size << "^2 full strip:    " << full.GetMemoryBytes() / megabyte << " MB, "
+              << full.GetIndexCount() << " indices, built in " << fullSeconds * 1000.0 << " ms" << std::endl;
+    
+    CompactTerrainMesh compact;
+    start = std::chrono::steady_clock::now();
+    compact.Build(heights.data(), size, size, scale);
+    double compactSeconds = SecondsSince(start);
+    std::cout << size << "^2 compact:       " << compact.GetMemoryBytes() / megabyte << " MB, "
+              << compact.GetPatches().size() << " patches, " << compact.GetIndexCount()
+              << " shared 16-bit indices, built in " << compactSeconds * 1000.0 << " ms" << std::endl;
+    
+    // Decoded vertices against the full-precision mesh
+    std::mt19937 gen(9);
+    std::uniform_int_distribution<int> cell(0, size - 1);
+    float heightError = 0.0f, normalError = 0.0f;
+    size_t colorMismatches = 0;
+    const size_t checks = 200000;
+    for (size_t i = 0; i < checks; ++i) {
+        int x = cell(gen), z = cell(gen);
+        TerrainVertex decoded = compact.DecodeAt(x, z);
+        // Full-precision reference, computed the way TerrainMesh::BuildGeometry does
+        const float* row = &heights[(size_t)z * size];
+        float y = row[x] * scale;
+        glm::vec3 normal(0.0f, 1.0f, 0.0f);
+        if (x > 0 && x < size - 1 && z > 0 && z < size - 1) {
+            normal = glm::normalize(glm::vec3((row[x - 1] - row[x + 1]) * 0.5f, 2.0f, (row[x - size] - row[x + size]) * 0.5f));
+        }
+        heightError = std::max(heightError, std::fabs(decoded.position.y - y));
+        normalError = std::max(normalError, std::acos(std::min(1.0f, glm::dot(normal, decoded.normal))));
+        colorMismatches += decoded.color != TerrainPalette[TerrainPaletteIndex(y)];
+    }
+    std::cout << "compact vs full: max height error " << std::setprecision(4) << heightError << ", max normal error "
+              << std::setprecision(2) << normalError * 57.29578f << " deg, " << colorMismatches << " color mismatches; "
+              << std::setprecision(1) << fullSeconds / compactSeconds << "x faster, "
+              << full.GetMemoryBytes() / (double)compact.GetMemoryBytes() << "x smaller" << std::endl;
+}
+
+
+void BenchTerrainLOD() {
+    std::cout << "\n=== Chunked quadtree LOD (selection and background chunk builds) ===" << std::endl;
+    
+    const int size = 4096;
+    const float scale = 3.0f;  // TerrainEngine's mesh vertical scale
+    std::vector<float> procedural((size_t)size * size);
+    TerrainGenerator(20240611).GenerateBlock(0, 0, size, size, procedural.data(), (size_t)size);
+    
+    // The generator adds per-vertex hash noise, so even its level 1 chunks are tens of units off.
+    // Real elevation models are much smoother vertex to vertex; two 9-wide box passes stand in for one.
+    std::vector<float> smoothed = procedural, pass((size_t)size * size);
+    for (int iteration = 0; iteration < 2; ++iteration) {
+        for (int z = 0; z < size; ++z) {
+            for (int x = 0; x < size; ++x) {
+                float sum = 0.0f;
+                for (int k = -4; k <= 4; ++k) sum += smoothed[(size_t)z * size + std::clamp(x + k, 0, size - 1)];
+                pass[(size_t)z * size + x] = sum / 9.0f;
+            }
+        }
+        for (int z = 0; z < size; ++z) {
+            for (int x = 0; x < size; ++x) {
+                float sum = 0.0f;
+                for (int k = -4; k <= 4; ++k) sum += pass[(size_t)std::clamp(z + k, 0, size - 1) * size + x];
+                smoothed[(size_t)z * size + x] = sum / 9.0f;
+            }
+        }
+    }
+    
+    WorkerPool workers((int)std::max(1u, std::thread::hardware_concurrency()));
+    std::cout << size << "^2, full mesh " << std::fixed << std::setprecision(1) << 2.0 * (size - 1) * (size - 1) / 1e6
+              << "M triangles; eye 200 units above the ground, 600 frames at 1 unit per frame" << std::endl;
+    
+    auto run = [&](const char* name, const std::vector<float>& heights) {
+        auto start = std::chrono::steady_clock::now();
+        TerrainLOD lod(heights.data(), size, size, scale, TerrainLODSettings(), &workers);
+        double setupSeconds = SecondsSince(start);
+        std::cout << name << ": " << lod.GetLevelCount() << " levels of " << lod.GetChunkCells()
+                  << "^2-quad chunks, errors and bounds in " << std::setprecision(1) << setupSeconds * 1000.0
+                  << " ms on " << workers.GetThreadCount() << " thread(s)" << std::endl;
+        
+        // Low pass across the map
+        auto eyeAt = [&](int frame) {
+            float x = -size * 0.4f + frame * 1.0f, z = -size * 0.1f + frame * 0.3f;
+            int gx = std::clamp((int)(x + size * 0.5f), 0, size - 1), gz = std::clamp((int)(z + size * 0.5f), 0, size - 1);
+            return glm::vec3(x, heights[(size_t)gz * size + gx] * scale + 200.0f, z);
+        };
+        
+        // Shared edges must meet exactly: every grid point on a chunk edge gets the same height from both sides
+        auto countCracks = [&]() {
+            std::unordered_map<uint64_t, float> edgeHeights;
+            size_t cracks = 0;
+            for (const TerrainLOD::DrawItem& item : lod.GetSelection()) {
+                const TerrainLOD::Chunk& chunk = *item.chunk;
+                const int cells = lod.GetChunkCells(), step = 1 << chunk.level, side = cells + 1;
+                for (int edge = 0; edge < 4; ++edge) {
+                    // West, east, north, south, as the stitch bits
+                    int spacing = (item.stitch >> edge & 1) ? 2 : 1;
+                    for (int t = 0; t < cells * step; ++t) {
+                        int k = t / (step * spacing) * spacing;
+                        float f = (float)(t % (step * spacing)) / (step * spacing);
+                        int i0 = edge == 0 ? 0 : edge == 1 ? cells : k, j0 = edge < 2 ? k : edge == 2 ? 0 : cells;
+                        int i1 = edge < 2 ? i0 : k + spacing, j1 = edge < 2 ? k + spacing : j0;
+                        int x = edge < 2 ? chunk.x0 + i0 * step : chunk.x0 + t, z = edge < 2 ? chunk.z0 + t : chunk.z0 + j0 * step;
+                        int x1 = chunk.x0 + i1 * step, z1 = chunk.z0 + j1 * step;
+                        if (x1 > size - 1 || z1 > size - 1) continue;  // Clamped onto the grid edge
+                        float h = chunk.vertices[j0 * side + i0].position.y * (1.0f - f) +
+                                  chunk.vertices[j1 * side + i1].position.y * f;
+                        auto [it, inserted] = edgeHeights.emplace((uint64_t)z << 32 | (uint32_t)x, h);
+                        if (!inserted && std::fabs(it->second - h) > 1e-3f) cracks++;
+                    }
+                }
+            }
+            return cracks;
+        };
+        
+        const int frames = 600;
+        const float tolerances[] = {2.0f, 8.0f};
+        for (float tolerance : tolerances) {
+            lod.SetPixelTolerance(tolerance);
+            double totalSelect = 0.0, worstSelect = 0.0;
+            size_t totalTriangles = 0, maxQueued = 0;
+            for (int frame = 0; frame < frames; ++frame) {
+                lod.Select(eyeAt(frame));
+                const TerrainLOD::FrameStats& stats = lod.GetFrameStats();
+                totalSelect += stats.selectSeconds;
+                worstSelect = std::max(worstSelect, stats.selectSeconds);
+                totalTriangles += stats.triangles;
+                maxQueued = std::max(maxQueued, stats.queuedBuilds);
+            }
+            
+            // Settled view once the builders have caught up
+            lod.WaitForBuilds();
+            lod.Select(eyeAt(frames));
+            lod.WaitForBuilds();
+            lod.Select(eyeAt(frames));
+            const TerrainLOD::FrameStats& settled = lod.GetFrameStats();
+            size_t cracks = countCracks();
+            
+            std::cout << "  " << std::setprecision(0) << tolerance << " px: " << std::setprecision(3)
+                      << totalSelect / frames * 1000.0 << " ms select (worst " << worstSelect * 1000.0 << "), "
+                      << std::setprecision(2) << totalTriangles / frames / 1e6 << "M triangles/frame, queue max "
+                      << maxQueued << "; settled " << settled.chunks << " chunks, " << settled.triangles / 1e6
+                      << "M triangles, finest level " << settled.finestLevel << ", " << cracks << " cracks" << std::endl;
+        }
+    };
+    run("procedural", procedural);
+    run("smoothed", smoothed);
+}
+
+
+void BenchContours() {
+    std::cout << "\n=== Contour extraction (marching squares into polylines) ===" << std::endl;
+    
+    const int size = 1024;
+    const int levelCount = 100;
+    std::vector<float> heights((size_t)size * size);
+    TerrainGenerator(20240611).GenerateBlock(0, 0, size, size, heights.data(), (size_t)size);
+    auto [lo, hi] = std::minmax_element(heights.begin(), heights.end());
+    std::vector<float> elevations(levelCount);
+    for (int i = 0; i < levelCount; ++i) elevations[i] = *lo + (*hi - *lo) * (i + 0.5f) / levelCount;
+    
+    // What the per-frame immediate-mode loop did on the CPU: every cell tested for every level
+    auto start = std::chrono::steady_clock::now();
+    size_t cellSegments = 0;
+    for (float elevation : elevations) {
+        for (int z = 0; z < size - 1; ++z) {
+            for (int x = 0; x < size - 1; ++x) {
+                const float* row0 = &heights[(size_t)z * size + x];
+                const float* row1 = row0 + size;
+                int corners = (row0[0] >= elevation) + (row0[1] >= elevation) + (row1[0] >= elevation) + (row1[1] >= elevation);
+                bool saddle = corners == 2 && (row0[0] >= elevation) == (row1[1] >= elevation);
+                cellSegments += corners == 0 || corners == 4 ? 0 : saddle ? 2 : 1;
+            }
+        }
+    }
+    double scanSeconds = SecondsSince(start);
+    std::cout << size << "^2, " << levelCount << " levels: per-cell scan " << std::fixed << std::setprecision(1)
+              << scanSeconds * 1000.0 << " ms for " << cellSegments << " segments (one glBegin/glEnd per cell per frame before)"
+              << std::endl;
+    
+    std::vector<int> threadCounts = {1};
+    int hardware = (int)std::max(1u, std::thread::hardware_concurrency());
+    if (hardware > 1) threadCounts.push_back(hardware);
+    for (int threads : threadCounts) {
+        WorkerPool workers(threads);
+        ContourSet contours;
+        start = std::chrono::steady_clock::now();
+        ContourExtractor::Extract(heights.data(), size, size, elevations, contours, &workers);
+        double seconds = SecondsSince(start);
+        
+        // Every cell segment must appear exactly once in the polylines
+        size_t segments = 0, closed = 0;
+        for (const ContourLevel& level : contours.levels) {
+            for (size_t i = 0; i < level.PolylineCount(); ++i) {
+                uint32_t begin = level.starts[i], end = level.PolylineEnd(i);
+                segments += end - begin - 1;
+                closed += level.points[begin] == level.points[end - 1];
+            }
+        }
+        std::cout << std::setw(2) << threads << " thread(s): " << seconds * 1000.0 << " ms, " << contours.PolylineCount()
+                  << " polylines (" << closed << " closed), " << contours.PointCount() << " points, " << segments
+                  << " segments" << (segments == cellSegments ? "  OK" : "  MISMATCH") << std::endl;
+    }
+    
+    // Single pass over the cells for every level at once, at survey intervals
+    auto sortedLevel = [](const ContourLevel& level) {
+        std::vector<std::pair<float, float>> points;
+        for (const glm::vec2& p : level.points) points.emplace_back(p.x, p.y);
+        std::sort(points.begin(), points.end());
+        return points;
+    };
+    const float range = *hi - *lo;
+    const float intervals[] = {range / levelCount, 5.0f, 1.0f};
+    for (float interval : intervals) {
+        int count = (int)(range / interval) + 1;
+        std::vector<float> even(count);
+        for (int k = 0; k < count; ++k) even[k] = *lo + k * interval;
+        
+        ContourSet perLevel, singlePass;
+        start = std::chrono::steady_clock::now();
+        ContourExtractor::Extract(heights.data(), size, size, even, perLevel);
+        double perLevelSeconds = SecondsSince(start);
+        start = std::chrono::steady_clock::now();
+        ContourExtractor::ExtractEvenlySpaced(heights.data(), size, size, *lo, interval, count, singlePass);
+        double singlePassSeconds = SecondsSince(start);
+        
+        // Same crossing points level by level; only the order of the polylines may differ
+        size_t levelsEqual = 0;
+        for (int k = 0; k < count; ++k) {
+            levelsEqual += perLevel.levels[k].starts.size() == singlePass.levels[k].starts.size() &&
+                           sortedLevel(perLevel.levels[k]) == sortedLevel(singlePass.levels[k]);
+        }
+        std::cout << std::setw(5) << std::setprecision(2) << interval << "-unit interval, " << std::setw(4) << count
+                  << " levels: per level " << std::setprecision(1) << std::setw(7) << perLevelSeconds * 1000.0
+                  << " ms, single pass " << std::setw(6) << singlePassSeconds * 1000.0 << " ms ("
+                  << perLevelSeconds / singlePassSeconds << "x), " << singlePass.PointCount() << " points, "
+                  << levelsEqual << "/" << count << " levels identical" << std::endl;
+    }
+    
+    // Cached: later frames reuse the lines until the heights change
+    TerrainEngine terrain;
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    terrain.GenerateRandomTerrain(size, size, 20240611);
+    std::cout.rdbuf(coutBuffer);
+    start = std::chrono::steady_clock::now();
+    size_t levels = terrain.GetContours().levels.size();
+    double firstSeconds = SecondsSince(start);
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < 100; ++frame) levels = terrain.GetContours().levels.size();
+    double cachedSeconds = SecondsSince(start) / 100;
+    std::cout << "TerrainEngine::GetContours (" << levels << " levels every " << terrain.GetContourInterval()
+              << " units): first " << firstSeconds * 1000.0 << " ms, cached " << std::setprecision(4)
+              << cachedSeconds * 1000.0 << " ms" << std::endl;
+}
+
+}
+
+void BenchPicking() {
+    std::cout << "\n=== Mouse picking (screen ray against the heightfield) ===" << std::endl;
+    
+    const int size = 4096;
+    const int cameraCount = 200, clicksPerCamera = 50;
+    const float viewportWidth = 1280.0f, viewportHeight = 720.0f;
+    
+    TerrainEngine terrain;
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    terrain.GenerateRandomTerrain(size, size, 20240611);
+    std::cout.rdbuf(coutBuffer);
+    
+    // Cameras above the ground looking down at the map, clicks anywhere in the window
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> pos(-size * 0.45f, size * 0.45f);
+    std::uniform_real_distribution<float> altitude(20.0f, 400.0f), look(50.0f, 800.0f), angle(0.0f, 6.2831853f);
+    std::uniform_real_distribution<float> pixelX(0.0f, viewportWidth), pixelY(0.0f, viewportHeight);
+    std::vector<std::pair<glm::vec3, glm::vec3>> rays;
+    for (int c = 0; c < cameraCount; ++c) {
+        float x = pos(gen), z = pos(gen);
+        Camera camera(glm::vec3(x, terrain.GetElevationAt(x, z) + altitude(gen), z));
+        float a = angle(gen), d = look(gen);
+        float tx = x + std::cos(a) * d, tz = z + std::sin(a) * d;
+        camera.LookAt(glm::vec3(tx, terrain.GetElevationAt(tx, tz), tz));
+        for (int i = 0; i < clicksPerCamera; ++i) {
+            glm::vec3 origin, direction;
+            camera.ScreenRay(pixelX(gen), pixelY(gen), viewportWidth, viewportHeight, origin, direction);
+            rays.emplace_back(origin, direction);
+        }
+    }
+    
+    std::vector<glm::vec3> hits(rays.size());
+    std::vector<uint8_t> found(rays.size());
+    std::vector<double> micros(rays.size());
+    for (size_t i = 0; i < rays.size(); ++i) {
+        auto start = std::chrono::steady_clock::now();
+        found[i] = terrain.Raycast(rays[i].first, rays[i].second, hits[i]);
+        micros[i] = SecondsSince(start) * 1e6;
+    }
+    std::vector<double> sorted = micros;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    size_t hitCount = 0;
+    for (size_t i = 0; i < rays.size(); ++i) {
+        total += micros[i];
+        hitCount += found[i];
+    }
+    
+    // Reference: march each ray in 0.05-unit steps. A hit must lie on the surface and come no later
+    // than the march; it may come earlier, where the ray clips a ridge thinner than one step.
+    size_t agree = 0, earlier = 0;
+    for (size_t i = 0; i < rays.size(); ++i) {
+        const glm::vec3 origin = rays[i].first, direction = rays[i].second;
+        const float step = 0.05f, limit = 8000.0f;
+        float marched = -1.0f;
+        for (float t = 0.0f; t < limit; t += step) {
+            glm::vec3 p = origin + direction * t;
+            if (std::abs(p.x) > size * 0.5f - 1.0f || std::abs(p.z) > size * 0.5f - 1.0f) {
+                if (direction.y >= 0.0f || p.y < -1000.0f) break;
+                continue;
+            }
+            if (p.y <= terrain.GetElevationAt(p.x, p.z)) {
+                marched = t;
+                break;
+            }
+        }
+        if (!found[i]) {
+            agree += marched < 0.0f;
+            continue;
+        }
+        float t = glm::length(hits[i] - origin);
+        bool onSurface = std::abs(hits[i].y - terrain.GetElevationAt(hits[i].x, hits[i].z)) < 0.01f;
+        if (onSurface && (marched < 0.0f || t <= marched + step)) {
+            agree++;
+            earlier += marched < 0.0f || t < marched - step;
+        }
+    }
+    
+    std::cout << size << "^2, " << rays.size() << " clicks from " << cameraCount << " cameras: " << std::fixed
+              << std::setprecision(2) << total / rays.size() << " us mean, " << sorted[sorted.size() / 2]
+              << " us median, " << sorted[sorted.size() * 99 / 100] << " us p99, " << sorted.back() << " us max; "
+              << hitCount << " hits; " << agree << "/" << rays.size() << " consistent with a 0.05-unit march ("
+              << earlier << " on ridges it stepped over)" << std::endl;
+    
+    // Round trip through the render transform: place a ground point where Application draws the
+    // grid, project it to a pixel with the camera's matrices (any zoom, any window shape) and pick
+    // that pixel. A point behind nearer ground picks the nearer ground; those are counted apart.
+    const GroundPlacement placement = ContourGridPlacement;
+    const glm::vec2 viewports[] = {{1280.0f, 720.0f}, {1024.0f, 1024.0f}, {2560.0f, 1080.0f}, {720.0f, 1280.0f}};
+    std::uniform_real_distribution<float> scroll(-40.0f, 75.0f);
+    size_t projected = 0, pickedBack = 0, hidden = 0;
+    float worst = 0.0f;
+    for (int c = 0; c < cameraCount; ++c) {
+        float x = pos(gen), z = pos(gen);
+        Camera camera(glm::vec3(x, terrain.GetElevationAt(x, z) * placement.scale + placement.offset + altitude(gen), z));
+        float a = angle(gen), d = look(gen);
+        float tx = x + std::cos(a) * d, tz = z + std::sin(a) * d;
+        camera.LookAt(glm::vec3(tx, terrain.GetElevationAt(tx, tz) * placement.scale + placement.offset, tz));
+        camera.ProcessMouseScroll(scroll(gen));
+        const glm::vec2 viewport = viewports[c % 4];
+        const glm::mat4 transform = camera.GetProjectionMatrix(viewport.x / viewport.y) * camera.GetViewMatrix();
+        for (int i = 0; i < clicksPerCamera; ++i) {
+            float b = angle(gen), r = look(gen);
+            float px = x + std::cos(b) * r, pz = z + std::sin(b) * r;
+            if (std::abs(px) > size * 0.5f - 1.0f || std::abs(pz) > size * 0.5f - 1.0f) continue;
+            glm::vec3 drawn(px, terrain.GetElevationAt(px, pz) * placement.scale + placement.offset, pz);
+            glm::vec4 clip = transform * glm::vec4(drawn, 1.0f);
+            if (clip.w <= 0.0f || std::abs(clip.x) > clip.w || std::abs(clip.y) > clip.w) continue;
+            projected++;
+            float screenX = (clip.x / clip.w + 1.0f) * 0.5f * viewport.x;
+            float screenY = (1.0f - clip.y / clip.w) * 0.5f * viewport.y;
+            
+            glm::vec3 origin, direction, hit;
+            camera.ScreenRay(screenX, screenY, viewport.x, viewport.y, origin, direction);
+            if (!terrain.Raycast(origin, direction, hit, std::numeric_limits<float>::infinity(), placement)) continue;
+            // Float pixels still carry rounding that grows with range and grazing angle
+            float distance = glm::length(drawn - origin);
+            float error = glm::length(hit - drawn);
+            if (error <= 1e-4f * distance) {
+                pickedBack++;
+                worst = std::max(worst, error / distance);
+            } else {
+                hidden += glm::length(hit - origin) < distance;
+            }
+        }
+    }
+    std::cout << "Pick-back through the render transform: " << pickedBack << "/" << projected - hidden
+              << " visible ground points within " << std::scientific << std::setprecision(1) << worst
+              << " of their range (" << hidden << " hidden behind nearer ground)" << std::defaultfloat
+              << (pickedBack == projected - hidden ? "  OK" : "  MISMATCH") << std::endl;
+}
+
+void BenchTerrainRasters() {
+    std::cout << "\n=== Slope, aspect and traversal cost rasters ===" << std::endl;
+    
+    const int size = 4096;
+    const uint64_t seed = 20240611;
+    std::vector<float> heights((size_t)size * size);
+    TerrainGenerator(seed).GenerateBlock(0, 0, size, size, heights.data(), (size_t)size);
+    
+    std::vector<int> threadCounts = {1};
+    int hardware = (int)std::max(1u, std::thread::hardware_concurrency());
+    if (hardware != 1) threadCounts.push_back(hardware);
+    
+    TerrainRasters rasters;
+    for (int threads : threadCounts) {
+        WorkerPool pool(threads);
+        double best = std::numeric_limits<double>::infinity();
+        for (int run = 0; run < 3; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            rasters.Build(heights.data(), size, size, threads > 1 ? &pool : nullptr);
+            best = std::min(best, SecondsSince(start));
+        }
+        std::cout << size << "^2, " << std::setw(2) << threads << " thread(s): " << std::fixed << std::setprecision(1)
+                  << best * 1000.0 << " ms = " << std::setprecision(0) << (double)size * size / best / 1e6
+                  << " M vertices/s, " << (rasters.GetMemoryBytes() >> 20) << " MB" << std::endl;
+    }
+    
+    const char* names[MobilityCount] = {"foot", "vehicle"};
+    const std::vector<float>& slope = rasters.GetSlope();
+    double meanSlope = 0.0;
+    for (float s : slope) meanSlope += s;
+    std::cout << "Mean slope " << std::setprecision(3) << meanSlope / slope.size() << ";";
+    for (int m = 0; m < MobilityCount; ++m) {
+        const std::vector<float>& cost = rasters.GetCost((Mobility)m);
+        size_t blocked = std::count_if(cost.begin(), cost.end(), [](float c) { return std::isinf(c); });
+        std::cout << " " << names[m] << " impassable " << std::setprecision(1) << 100.0 * blocked / cost.size() << "%";
+    }
+    std::cout << std::endl;
+    
+    // Through the engine: built once per terrain revision, then served from the cache
+    TerrainEngine terrain;
+    terrain.SetThreadCount(hardware);
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+    terrain.GenerateRandomTerrain(size, size, seed);
+    std::cout.rdbuf(coutBuffer);
+    auto start = std::chrono::steady_clock::now();
+    const TerrainRasters& first = terrain.GetRasters();
+    double firstSeconds = SecondsSince(start);
+    start = std::chrono::steady_clock::now();
+    const TerrainRasters& cached = terrain.GetRasters();
+    double cachedSeconds = SecondsSince(start);
+    bool same = &first == &cached && first.GetSlope() == slope;
+    std::cout << "TerrainEngine::GetRasters: first " << std::setprecision(1) << firstSeconds * 1000.0 << " ms, cached "
+              << std::setprecision(2) << cachedSeconds * 1e6 << " us" << (same ? "  OK" : "  MISMATCH") << std::endl;
+}
+
+void BenchPathfinding() {
+    std::cout << "\n=== Pathfinding (HPA* over the cost rasters) ===" << std::endl;
+    
+    const uint64_t seed = 20240611;
+    const int hardware = (int)std::max(1u, std::thread::hardware_concurrency());
+    const char* names[MobilityCount] = {"foot", "vehicle"};
+    struct Case {
+        int size;
+        size_t queries;
+        size_t exactQueries;  // Plain A* is far slower; compared on a few pairs only
+    };
+    const Case cases[] = {{1024, 2000, 40}, {4096, 500, 0}};
+    
+    for (const Case& c : cases) {
+        TerrainEngine terrain;
+        terrain.SetThreadCount(hardware);
+        std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+        terrain.GenerateRandomTerrain(c.size, c.size, seed);
+        std::cout.rdbuf(coutBuffer);
+        
+        auto start = std::chrono::steady_clock::now();
+        terrain.GetRasters();
+        double rasterSeconds = SecondsSince(start);
+        start = std::chrono::steady_clock::now();
+        std::shared_ptr<const PathFinder> finder = terrain.GetPathFinder();
+        double buildSeconds = SecondsSince(start);
+        std::cout << c.size << "^2: graph built in " << std::fixed << std::setprecision(0) << buildSeconds * 1000.0
+                  << " ms on " << hardware << " thread(s) (rasters " << rasterSeconds * 1000.0 << " ms), "
+                  << (finder->GetMemoryBytes() >> 20) << " MB;";
+        for (int m = 0; m < MobilityCount; ++m) {
+            std::cout << " " << names[m] << " " << finder->GetNodeCount((Mobility)m) << " entrances / "
+                      << finder->GetEdgeCount((Mobility)m) << " edges";
+        }
+        std::cout << std::endl;
+        
+        for (int m = 0; m < MobilityCount; ++m) {
+            const Mobility mobility = (Mobility)m;
+            const TerrainRasters& rasters = terrain.GetRasters();
+            const std::vector<float>& cost = rasters.GetCost(mobility);
+            
+            // Random pairs on passable ground anywhere on the map
+            std::mt19937 rng(7);
+            std::uniform_int_distribution<int> coord(0, c.size - 1);
+            auto passablePoint = [&]() {
+                while (true) {
+                    int x = coord(rng), z = coord(rng);
+                    if (!std::isinf(cost[(size_t)z * c.size + x])) {
+                        return glm::vec3(x - c.size * 0.5f, 0.0f, z - c.size * 0.5f);
+                    }
+                }
+            };
+            std::vector<std::pair<glm::vec3, glm::vec3>> pairs(c.queries);
+            for (auto& pair : pairs) pair = {passablePoint(), passablePoint()};
+            
+            std::vector<glm::vec3> waypoints;
+            std::vector<float> costs(pairs.size(), -1.0f);
+            size_t found = 0;
+            double length = 0.0;
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < pairs.size(); ++i) {
+                if (finder->FindPath(mobility, pairs[i].first, pairs[i].second, waypoints, &costs[i])) {
+                    found++;
+                    length += glm::distance(pairs[i].first, pairs[i].second);
+                } else {
+                    costs[i] = -1.0f;
+                }
+            }
+            double seconds = SecondsSince(start);
+            std::cout << "  " << std::setw(7) << names[m] << ": " << std::setprecision(0) << pairs.size() / seconds
+                      << " paths/s on 1 thread (" << std::setprecision(1) << seconds * 1e6 / pairs.size()
+                      << " us mean), " << found << "/" << pairs.size() << " reachable, mean straight-line length "
+                      << std::setprecision(0) << (found ? length / found : 0.0) << std::endl;
+            
+            // The same queries through the background service
+            PathService service(hardware);
+            start = std::chrono::steady_clock::now();
+            std::vector<uint64_t> tickets;
+            tickets.reserve(pairs.size());
+            for (const auto& pair : pairs) tickets.push_back(service.Submit(finder, mobility, pair.first, pair.second));
+            size_t agree = 0;
+            for (size_t i = 0; i < tickets.size(); ++i) {
+                PathResult result = service.Take(tickets[i]);
+                agree += result.found == (costs[i] >= 0.0f) && (!result.found || result.cost == costs[i]);
+            }
+            seconds = SecondsSince(start);
+            std::cout << "           " << std::setprecision(0) << pairs.size() / seconds << " paths/s through PathService ("
+                      << service.GetThreadCount() << " thread(s)), " << agree << "/" << pairs.size() << " identical"
+                      << std::endl;
+            
+            if (c.exactQueries == 0) continue;
+            double hierarchical = 0.0, exact = 0.0, ratio = 0.0;
+            size_t compared = 0, mismatched = 0;
+            for (size_t i = 0; i < c.exactQueries; ++i) {
+                float exactCost = 0.0f, approxCost = 0.0f;
+                start = std::chrono::steady_clock::now();
+                bool approxFound = finder->FindPath(mobility, pairs[i].first, pairs[i].second, waypoints, &approxCost);
+                hierarchical += SecondsSince(start);
+                start = std::chrono::steady_clock::now();
+                bool exactFound = finder->FindGridPath(mobility, pairs[i].first, pairs[i].second, waypoints, &exactCost);
+                exact += SecondsSince(start);
+                if (approxFound != exactFound) mismatched++;
+                if (approxFound && exactFound && exactCost > 0.0f) {
+                    ratio += approxCost / exactCost;
+                    compared++;
+                }
+            }
+            std::cout << "           vs plain A* on " << c.exactQueries << " pairs: " << std::setprecision(1)
+                      << exact / hierarchical << "x faster (" << exact * 1000.0 / c.exactQueries << " ms mean), cost "
+                      << std::setprecision(3) << (compared ? ratio / compared : 0.0) << "x optimal, "
+                      << mismatched << " reachability mismatches" << std::endl;
+        }
+    }
+}
+void BenchFlowFields() {
+    std::cout << "\n=== Flow fields (one order, many units) ===" << std::endl;
+    
+    const uint64_t seed = 20240611;
+    const Mobility mobility = Mobility::Foot;
+    const size_t groupSizes[] = {10, 1000, 50000};
+    const size_t maxRoutes = 2000;  // Per-unit routing beyond this is extrapolated
+    
+    for (int size : {256, 1024}) {
+        TerrainEngine terrain;
+        std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+        terrain.GenerateRandomTerrain(size, size, seed);
+        std::cout.rdbuf(coutBuffer);
+        std::shared_ptr<const PathFinder> finder = terrain.GetPathFinder();
+        const std::vector<float>& cost = terrain.GetRasters().GetCost(mobility);
+        
+        std::mt19937 rng(11);
+        std::uniform_int_distribution<int> coord(0, size - 1);
+        auto passablePoint = [&]() {
+            while (true) {
+                int x = coord(rng), z = coord(rng);
+                if (!std::isinf(cost[(size_t)z * size + x])) return glm::vec3(x - size * 0.5f, 0.0f, z - size * 0.5f);
+            }
+        };
+        const glm::vec3 goal = passablePoint();
+        std::vector<glm::vec3> units(groupSizes[2]);
+        for (glm::vec3& unit : units) unit = passablePoint();
+        
+        std::cout << size << "^2:" << std::endl;
+        for (size_t count : groupSizes) {
+            std::vector<glm::vec3> waypoints;
+            size_t routed = std::min(count, maxRoutes);
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < routed; ++i) finder->FindPath(mobility, units[i], goal, waypoints);
+            double routeSeconds = SecondsSince(start) * count / routed;
+            
+            // Order latency for the shared field: build it, then give every unit its heading
+            start = std::chrono::steady_clock::now();
+            auto field = std::make_shared<FlowField>();
+            finder->BuildFlowField(mobility, goal, *field);
+            double buildSeconds = SecondsSince(start);
+            glm::vec3 heading;
+            size_t headed = 0;
+            for (size_t i = 0; i < count; ++i) headed += field->Sample(units[i], heading);
+            double flowSeconds = SecondsSince(start);
+            
+            // A repeat order to the same cell only looks the field up
+            FlowFieldCache cache;
+            cache.Insert(field);
+            start = std::chrono::steady_clock::now();
+            std::shared_ptr<const FlowField> cached = cache.Find(mobility, finder->NearestVertex(goal), finder->GetRevision());
+            size_t cachedHeaded = 0;
+            for (size_t i = 0; i < count; ++i) cachedHeaded += cached->Sample(units[i], heading);
+            double cachedSeconds = SecondsSince(start);
+            
+            std::cout << "  " << std::setw(6) << count << " units: per-unit routes " << std::fixed << std::setprecision(1)
+                      << routeSeconds * 1000.0 << " ms" << (routed < count ? " (est.)" : "") << ", flow field "
+                      << flowSeconds * 1000.0 << " ms (build " << buildSeconds * 1000.0 << " ms), "
+                      << std::setprecision(1) << routeSeconds / flowSeconds << "x; cached "
+                      << std::setprecision(3) << cachedSeconds * 1000.0 << " ms; " << headed << "/" << count
+                      << " with a heading" << (cachedHeaded == headed ? "" : "  MISMATCH") << std::endl;
+        }
+        
+        // Following the field is as cheap as the optimal route
+        auto field = std::make_shared<FlowField>();
+        finder->BuildFlowField(mobility, goal, *field);
+        double ratio = 0.0;
+        size_t compared = 0, arrived = 0;
+        const size_t walks = 20;
+        for (size_t i = 0; i < walks; ++i) {
+            int v = finder->NearestVertex(units[i]);
+            float walked = 0.0f;
+            glm::vec3 heading;
+            auto at = [&](int vertex) { return glm::vec3(vertex % size - size * 0.5f, 0.0f, vertex / size - size * 0.5f); };
+            for (int steps = 0; steps < size * size && field->Sample(at(v), heading); ++steps) {
+                int dx = (heading.x > 0.1f) - (heading.x < -0.1f), dz = (heading.z > 0.1f) - (heading.z < -0.1f);
+                int next = v + dz * size + dx;
+                walked += (dx && dz ? 1.41421356f : 1.0f) * 0.5f * (cost[v] + cost[next]);
+                v = next;
+            }
+            if (v != field->goalVertex) continue;
+            arrived++;
+            float optimal = 0.0f;
+            std::vector<glm::vec3> waypoints;
+            if (finder->FindGridPath(mobility, units[i], goal, waypoints, &optimal) && optimal > 0.0f) {
+                ratio += walked / optimal;
+                compared++;
+            }
+        }
+        std::cout << "  walking the field from " << walks << " units: " << arrived << " arrive, cost "
+                  << std::setprecision(3) << (compared ? ratio / compared : 0.0) << "x optimal, "
+                  << (field->GetMemoryBytes() >> 10) << " KB per field" << std::endl;
+    }
+}
+
+
+int main(int argc, char** argv) {
+    std::string section = argc > 1 ? argv[1] : "";
+    
+    if (section.empty() || section == "los") BenchLineOfSight();
+    if (section.empty() || section == "viewshed") BenchViewshed();
+    if (section.empty() || section == "load") BenchHeightmapLoad();
+    if (section.empty() || section == "tiles") BenchTiledTerrain();
+    if (section.empty() || section == "generate") BenchGeneration();
+    if (section.empty() || section == "ondemand") BenchOnDemandTerrain();
+    if (section.empty() || section == "elevation") BenchElevationSampling();
+    if (section.empty() || section == "mesh") BenchMeshBuild();
+    if (section.empty() || section == "lod") BenchTerrainLOD();
+    if (section.empty() || section == "contours") BenchContours();
+    if (section.empty() || section == "pick") BenchPicking();
+    if (section.empty() || section == "rasters") BenchTerrainRasters();
+    if (section.empty() || section == "paths") BenchPathfinding();
+    if (section.empty() || section == "flow") BenchFlowFields();
+    
+    return 0;
+}
@@ -2,12 +2,15 @@
 
 echo "=== Building Enhanced Terrain Simulator ==="
 
-mk        echo "Enhanced terrain simulator with strategic features! 🚀"ir -p build
+mkdir -p build
 cd build
 
 if command -v clang++ &> /dev/null; then
     COMPILER="clang++"
     echo "Using Clang++: $(clang++ --version | head -n1)"
+elif command -v g++ &> /dev/null; then
+    COMPILER="g++"
+    echo "Using G++: $(g++ --version | head -n1)"
 else
     echo "Error: No suitable C++ compiler found"
     exit 1
@@ -40,13 +43,31 @@ if [[ "$OSTYPE" == "darwin"* ]]; then
         -O2 \
         ../src/main.cpp \
         ../src/core/Application.cpp \
+        ../src/core/SimulationClock.cpp \
+        ../src/core/Replay.cpp \
+        ../src/core/WorkerPool.cpp \
         ../src/graphics/Camera.cpp \
         ../src/graphics/EntitySymbols.cpp \
         ../src/terrain/TerrainEngine.cpp \
+        ../src/terrain/TerrainRender.cpp \
+        ../src/terrain/HeightmapLoader.cpp \
+        ../src/terrain/TileStore.cpp \
+        ../src/terrain/TerrainGenerator.cpp \
+        ../src/terrain/CompactTerrainMesh.cpp \
+        ../src/terrain/TerrainLOD.cpp \
+        ../src/terrain/ContourExtractor.cpp \
+        ../src/terrain/HeightPyramid.cpp \
+        ../src/terrain/TerrainRasters.cpp \
+        ../src/terrain/FlowField.cpp \
+        ../src/terrain/PathFinder.cpp \
+        ../src/terrain/PathService.cpp \
         ../src/simulation/Unit.cpp \
+        ../src/simulation/UnitStore.cpp \
+        ../src/simulation/SpatialGrid.cpp \
         ../src/simulation/SimulationEngine.cpp \
         ../src/data/DatabaseManager.cpp \
         ../src/ai/AISystem.cpp \
+        ../src/audio/AudioEventQueue.cpp \
         -lglfw \
         -framework Cocoa -framework IOKit -framework CoreVideo -framework OpenGL \
         -o TerrainSimulator
@@ -63,12 +84,112 @@ if [[ "$OSTYPE" == "darwin"* ]]; then
         echo "   🤖  AI opponent with reactive behavior"
         echo "   �️  Unit health and attrition system"
         echo ""
-        echo "To run: cd build && ./TerrainSimulator"
+        echo "To run: cd build && ./TerrainSimulator [--sim-threads N] [--seed N] [--record FILE]"
         echo ""
         echo "Enhanced terrain simulator with tactical features! �"
     else
         echo "❌ Build failed"
     fi
+else
+    echo "Skipping the windowed simulator: it needs macOS (GLFW and OpenGL.framework)"
+fi
+
+# The batch runner and the benchmarks need no display, GL headers or GL libraries, so they
+# build anywhere a C++20 compiler and GLM are available, e.g. on a Linux build farm
+HEADLESS_FLAGS="-std=c++20 -I../include -O2"
+if [[ "$OSTYPE" == "darwin"* ]]; then
+    HEADLESS_FLAGS="$HEADLESS_FLAGS -I/opt/homebrew/include"
+fi
+
+echo "Compiling headless batch runner..."
+
+$COMPILER $HEADLESS_FLAGS \
+    ../src/headless_main.cpp \
+    ../src/core/BatchRunner.cpp \
+    ../src/core/Replay.cpp \
+    ../src/core/WorkerPool.cpp \
+    ../src/terrain/TerrainEngine.cpp \
+    ../src/terrain/TerrainRenderHeadless.cpp \
+    ../src/terrain/HeightmapLoader.cpp \
+    ../src/terrain/TileStore.cpp \
+    ../src/terrain/TerrainGenerator.cpp \
+    ../src/terrain/CompactTerrainMesh.cpp \
+    ../src/terrain/TerrainLOD.cpp \
+    ../src/terrain/ContourExtractor.cpp \
+    ../src/terrain/HeightPyramid.cpp \
+    ../src/terrain/TerrainRasters.cpp \
+    ../src/terrain/FlowField.cpp \
+    ../src/terrain/PathFinder.cpp \
+    ../src/terrain/PathService.cpp \
+    ../src/simulation/Unit.cpp \
+    ../src/simulation/UnitStore.cpp \
+    ../src/simulation/SpatialGrid.cpp \
+    ../src/simulation/SimulationEngine.cpp \
+    ../src/ai/AISystem.cpp \
+    ../src/audio/AudioEventQueue.cpp \
+    -lpthread \
+    -o TerrainSimulatorHeadless
+
+if [ $? -eq 0 ]; then
+    echo "To batch run: cd build && ./TerrainSimulatorHeadless [--ticks N] [--until eliminated|idle] [--units N]"
+    echo "To replay a recorded session: cd build && ./TerrainSimulatorHeadless --replay FILE"
+    echo ""
+else
+    echo "❌ Headless build failed"
+fi
+
+echo "Compiling headless benchmarks..."
+
+$COMPILER $HEADLESS_FLAGS \
+    ../bench/TerrainBenchmark.cpp \
+    ../src/core/WorkerPool.cpp \
+    ../src/graphics/Camera.cpp \
+    ../src/terrain/TerrainEngine.cpp \
+    ../src/terrain/TerrainRenderHeadless.cpp \
+    ../src/terrain/HeightmapLoader.cpp \
+    ../src/terrain/TileStore.cpp \
+    ../src/terrain/TerrainGenerator.cpp \
+    ../src/terrain/CompactTerrainMesh.cpp \
+    ../src/terrain/TerrainLOD.cpp \
+    ../src/terrain/ContourExtractor.cpp \
+    ../src/terrain/HeightPyramid.cpp \
+    ../src/terrain/TerrainRasters.cpp \
+    ../src/terrain/FlowField.cpp \
+    ../src/terrain/PathFinder.cpp \
+    ../src/terrain/PathService.cpp \
+    -lpthread \
+    -o TerrainBenchmark && \
+$COMPILER $HEADLESS_FLAGS \
+    ../bench/SimulationBenchmark.cpp \
+    ../src/core/SimulationClock.cpp \
+    ../src/core/WorkerPool.cpp \
+    ../src/simulation/Unit.cpp \
+    ../src/simulation/UnitStore.cpp \
+    ../src/simulation/SpatialGrid.cpp \
+    ../src/simulation/SimulationEngine.cpp \
+    ../src/ai/AISystem.cpp \
+    ../src/audio/AudioEventQueue.cpp \
+    ../src/terrain/TerrainEngine.cpp \
+    ../src/terrain/TerrainRenderHeadless.cpp \
+    ../src/terrain/HeightmapLoader.cpp \
+    ../src/terrain/TileStore.cpp \
+    ../src/terrain/TerrainGenerator.cpp \
+    ../src/terrain/CompactTerrainMesh.cpp \
+    ../src/terrain/TerrainLOD.cpp \
+    ../src/terrain/ContourExtractor.cpp \
+    ../src/terrain/HeightPyramid.cpp \
+    ../src/terrain/TerrainRasters.cpp \
+    ../src/terrain/FlowField.cpp \
+    ../src/terrain/PathFinder.cpp \
+    ../src/terrain/PathService.cpp \
+    -lpthread \
+    -o SimulationBenchmark
+
+if [ $? -eq 0 ]; then
+    echo "To benchmark: cd build && ./TerrainBenchmark [los|viewshed|load|tiles|generate|ondemand|elevation|mesh|lod|contours|pick|rasters|paths|flow]"
+    echo "              cd build && ./SimulationBenchmark [contact|storage|audio|clock|snapshot|determinism]"
+else
+    echo "❌ Benchmark build failed"
 fi
 
 echo ""
@@ -1,9 +1,14 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 #include <string>
 
 namespace TS {
 
+class AudioEventQueue;
+class ByteWriter;
+class ByteReader;
+
 class AISystem {
 private:
     float m_updateTimer;
@@ -11,6 +16,12 @@ private:
     int m_experience;
     std::vector<std::string> m_strategies;
     int m_currentStrategy;
+    AudioEventQueue* m_audio;
+    // Counter-based random stream (see core/Random.h), so decisions replay exactly
+    uint64_t m_seed;
+    uint64_t m_rngCounter;
+    
+    int Roll(int sides);
     
     void LearnAndAdapt();
     void MakeStrategicDecision();
@@ -22,7 +33,16 @@ public:
     void Initialize();
     void Update(float deltaTime);
     void SetComplexity(int level);
+    void SetAudioQueue(AudioEventQueue* audio) { m_audio = audio; }
+    void SetSeed(uint64_t seed) { m_seed = seed; }
+    uint64_t GetSeed() const { return m_seed; }
     void ReactToPlayerInstruction(const std::string& command);
+    
+    // Timers, experience, current strategy and random stream, for simulation snapshots
+    void WriteSnapshot(ByteWriter& out) const;
+    bool ReadSnapshot(ByteReader& in);
+    // FNV-1a over the same state
+    uint64_t ComputeStateHash() const;
 };
 
 }
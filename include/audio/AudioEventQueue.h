@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace TS {
+
+enum class SoundEvent : uint8_t {
+    STARTUP,
+    COMMAND_ISSUED,
+    AI_REACTION,
+    HEAVY_MOVEMENT,
+    BLUE_MANEUVER,
+    RED_MANEUVER,
+    BLUE_CONTACT,
+    RED_CONTACT,
+    UNIT_LOST,
+    COUNT
+};
+
+// Where sounds actually go. Play is only ever called from the queue's consumer thread.
+class AudioBackend {
+public:
+    virtual ~AudioBackend() = default;
+    virtual void Play(SoundEvent sound) = 0;
+    virtual void StopAll() {}
+};
+
+// Discards everything - for headless runs and benchmarks
+class NullAudioBackend : public AudioBackend {
+public:
+    void Play(SoundEvent) override {}
+};
+
+// macOS system sounds through a background afplay process
+class AfplayAudioBackend : public AudioBackend {
+public:
+    void Play(SoundEvent sound) override;
+    void StopAll() override;
+};
+
+// Multi-producer, single-consumer sound queue. Post() is lock-free and never blocks the
+// simulation; a consumer thread drains it, merges repeats of the same sound, enforces a
+// minimum interval per sound and hands the survivors to the backend.
+class AudioEventQueue {
+public:
+    struct Stats {
+        uint64_t posted;
+        uint64_t dispatched;
+        uint64_t coalesced;   // Merged with a repeat or inside the rate limit
+        uint64_t dropped;     // Queue was full
+    };
+    
+    explicit AudioEventQueue(std::unique_ptr<AudioBackend> backend, size_t capacity = 4096,
+                             std::chrono::milliseconds minInterval = std::chrono::milliseconds(150));
+    ~AudioEventQueue();
+    
+    AudioEventQueue(const AudioEventQueue&) = delete;
+    AudioEventQueue& operator=(const AudioEventQueue&) = delete;
+    
+    // Safe from any thread; returns false if the event was dropped
+    bool Post(SoundEvent sound);
+    void StopAll();
+    
+    Stats GetStats() const;
+    
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        SoundEvent sound;
+    };
+    
+    std::unique_ptr<AudioBackend> m_backend;
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask;
+    std::chrono::milliseconds m_minInterval;
+    
+    alignas(64) std::atomic<size_t> m_enqueuePos;
+    alignas(64) size_t m_dequeuePos;  // Consumer thread only
+    
+    std::atomic<uint64_t> m_posted;
+    std::atomic<uint64_t> m_dispatched;
+    std::atomic<uint64_t> m_coalesced;
+    std::atomic<uint64_t> m_dropped;
+    
+    std::atomic<bool> m_running;
+    std::thread m_consumer;
+    
+    bool Pop(SoundEvent& sound);
+    void ConsumerLoop();
+};
+
+}
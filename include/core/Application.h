@@ -3,6 +3,9 @@
 #include <memory>
 #include <string>
 #include <chrono>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "SimulationClock.h"
 
 namespace TS {
 
@@ -11,6 +14,9 @@ class TerrainEngine;
 class SimulationEngine;
 class DatabaseManager;
 class AISystem;
+class AudioEventQueue;
+class ReplayRecorder;
+enum class SoundEvent : uint8_t;
 
 class Application {
     GLFWwindow* m_window;
@@ -23,6 +29,7 @@ class Application {
     std::unique_ptr<SimulationEngine> m_simulationEngine;
     std::unique_ptr<DatabaseManager> m_database;
     std::unique_ptr<AISystem> m_aiSystem;
+    std::unique_ptr<AudioEventQueue> m_audio;
     
     // Input state
     bool m_keys[1024];
@@ -34,13 +41,22 @@ class Application {
     float m_commandFeedbackTimer;
     int m_commandExecutionCount;
     
-    // Simulation speed control
-    float m_simulationSpeed;
+    // Fixed simulation steps paid out of frame time, scaled by the speed multiplier
+    SimulationClock m_clock;
     std::chrono::steady_clock::time_point m_lastSpeedChange;
+    int m_simulationThreads;
+    
+    // Session log for ReplayRunner; no path records nothing
+    std::unique_ptr<ReplayRecorder> m_recorder;
+    std::string m_recordPath;
+    uint64_t m_seed;  // 0: random terrain each launch
     
 public:
     Application();
     ~Application();
+    void SetSimulationThreads(int threads) { m_simulationThreads = threads; }
+    void SetRecordPath(const std::string& path) { m_recordPath = path; }
+    void SetSeed(uint64_t seed) { m_seed = seed; }
     bool Initialize();
     void Run();
     void Shutdown();
@@ -50,11 +66,14 @@ public:
     void ProcessKeyboard(float deltaTime);
     void ProcessMouse(double xpos, double ypos);
     void CommandBlueForces(const std::string& command);
+    // Move order to a picked ground point
+    void CommandBlueForcesTo(const glm::vec3& target);
     void RenderContoured3DGrid();
-    void PlaySound(const std::string& soundType);
+    void PlaySound(SoundEvent sound);
     
     static void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mode);
     static void MouseCallback(GLFWwindow* window, double xpos, double ypos);
+    static void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 };
 
 }
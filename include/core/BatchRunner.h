@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace TS {
+
+class TerrainEngine;
+class SimulationEngine;
+class AISystem;
+
+enum class BatchStopCondition {
+    TICKS_ONLY,      // Run the full tick budget
+    TEAM_ELIMINATED, // Stop once either side has no units left
+    ALL_IDLE         // Stop once no unit is moving
+};
+
+struct BatchConfig {
+    int maxTicks = 10000;
+    float timestep = 1.0f / 60.0f;
+    int threads = 1;
+    uint64_t seed = 1;
+    int extraUnits = 0;      // Seeded random units added on top of the default scenario
+    int terrainSize = 256;
+    BatchStopCondition stopCondition = BatchStopCondition::TICKS_ONLY;
+    bool verbose = false;    // Keep the simulation's console chatter
+    std::string recordPath;  // Replay log to write; empty records nothing
+};
+
+struct BatchResult {
+    int ticks = 0;
+    double wallSeconds = 0.0;
+    float simulationTime = 0.0f;
+    std::string stopReason;
+    int blueUnits = 0;
+    int redUnits = 0;
+    float blueHealth = 0.0f; // Summed over surviving units
+    float redHealth = 0.0f;
+    uint64_t stateHash = 0;
+    
+    double TicksPerSecond() const { return wallSeconds > 0.0 ? ticks / wallSeconds : 0.0; }
+};
+
+// Drives SimulationEngine and AISystem at a fixed timestep as fast as the CPU allows.
+// No window, GL context or audio is created.
+class BatchRunner {
+private:
+    BatchConfig m_config;
+    std::unique_ptr<TerrainEngine> m_terrain;
+    std::unique_ptr<SimulationEngine> m_simulation;
+    std::unique_ptr<AISystem> m_ai;
+    
+    bool ShouldStop(std::string& reason) const;
+    void CollectSummary(BatchResult& result) const;
+    
+public:
+    explicit BatchRunner(const BatchConfig& config);
+    ~BatchRunner();
+    
+    BatchResult Run();
+    static void PrintSummary(const BatchResult& result);
+};
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace TS {
+
+// Growable byte buffer for binary snapshots. Counts, ids and other usually-small integers go
+// out as LEB128 varints (signed ones zigzagged first, so small deltas of either sign stay
+// short); floats and other plain data are copied verbatim in host byte order and come back
+// bit for bit.
+class ByteWriter {
+public:
+    std::vector<uint8_t> bytes;
+    
+    void Clear() { bytes.clear(); }
+    void Reserve(size_t size) { bytes.reserve(size); }
+    size_t Size() const { return bytes.size(); }
+    
+    void PutVarint(uint64_t value) {
+        while (value >= 0x80) {
+            bytes.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back((uint8_t)value);
+    }
+    void PutSigned(int64_t value) { PutVarint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63)); }
+    void PutRaw(const void* data, size_t size) {
+        if (size == 0) return;
+        size_t offset = bytes.size();
+        bytes.resize(offset + size);
+        std::memcpy(bytes.data() + offset, data, size);
+    }
+    template <typename T>
+    void Put(const T& value) { PutRaw(&value, sizeof(T)); }
+    // A whole column of plain data in one copy
+    template <typename T>
+    void PutArray(const T* data, size_t count) { PutRaw(data, count * sizeof(T)); }
+    void PutString(const std::string& text) {
+        PutVarint(text.size());
+        PutRaw(text.data(), text.size());
+    }
+};
+
+// Reads what ByteWriter wrote. Running off the end or a malformed varint marks the reader
+// failed; from then on every read yields zeros, so callers check Ok() once at the end.
+class ByteReader {
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_offset;
+    bool m_failed;
+    
+public:
+    ByteReader(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_offset(0), m_failed(false) {}
+    
+    bool Ok() const { return !m_failed; }
+    void Fail() { m_failed = true; }
+    size_t Remaining() const { return m_failed ? 0 : m_size - m_offset; }
+    // False (and failed) unless count items of itemSize bytes could still follow; guards
+    // allocations sized from the stream
+    bool Expect(uint64_t count, size_t itemSize) {
+        if (m_failed || (itemSize && count > Remaining() / itemSize)) m_failed = true;
+        return !m_failed;
+    }
+    
+    uint64_t GetVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64 && m_offset < m_size && !m_failed; shift += 7) {
+            uint8_t byte = m_data[m_offset++];
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        m_failed = true;
+        return 0;
+    }
+    int64_t GetSigned() {
+        uint64_t value = GetVarint();
+        return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+    }
+    bool GetRaw(void* data, size_t size) {
+        if (m_failed || size > m_size - m_offset) {
+            m_failed = true;
+            std::memset(data, 0, size);
+            return false;
+        }
+        if (size) std::memcpy(data, m_data + m_offset, size);
+        m_offset += size;
+        return true;
+    }
+    // The next size bytes in place, or null (and failed) when fewer remain
+    const uint8_t* GetBlock(size_t size) {
+        if (m_failed || size > m_size - m_offset) {
+            m_failed = true;
+            return nullptr;
+        }
+        const uint8_t* block = m_data + m_offset;
+        m_offset += size;
+        return block;
+    }
+    template <typename T>
+    T Get() {
+        T value;
+        GetRaw(&value, sizeof(T));
+        return value;
+    }
+    template <typename T>
+    bool GetArray(T* data, size_t count) { return GetRaw(data, count * sizeof(T)); }
+    std::string GetString() {
+        uint64_t size = GetVarint();
+        if (!Expect(size, 1)) return std::string();
+        std::string text(reinterpret_cast<const char*>(m_data + m_offset), (size_t)size);
+        m_offset += (size_t)size;
+        return text;
+    }
+};
+
+}
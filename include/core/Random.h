@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+
+namespace TS {
+
+// Counter-based random numbers: the value depends only on (seed, stream, counter), so
+// any number of independent streams can be drawn concurrently and replayed exactly.
+// Mixing is the SplitMix64 finalizer applied to a combined key.
+inline uint64_t CounterHash(uint64_t seed, uint64_t stream, uint64_t counter) {
+    uint64_t z = seed ^ (stream * 0x9E3779B97F4A7C15ull) ^ (counter * 0xD1B54A32D192ED03ull);
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform float in [0, 1) from the top 24 bits of a hash
+inline float HashToUnitFloat(uint64_t hash) {
+    return (float)(hash >> 40) * (1.0f / 16777216.0f);
+}
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <glm/glm.hpp>
+#include "ByteStream.h"
+
+namespace TS {
+
+class TerrainEngine;
+class SimulationEngine;
+class AISystem;
+
+enum class ReplayRecord : uint8_t {
+    Tick = 1,   // One step ran: simulation and AI state hashes after it
+    Command,    // SimulationEngine::CommandAllied, and the AI's reaction
+    MoveOrder,  // SimulationEngine::CommandAlliedTo, and the AI's reaction
+    Speed,      // Time compression changed; only paces wall-clock time, so replays skip it
+    Restart,    // New terrain generated, simulation reset and reinitialized
+    Snapshot    // Simulation and AI replaced from a snapshot
+};
+
+// Generated terrain a session ran on; replays regenerate it from the seed
+struct ReplayTerrain {
+    int width = 0, height = 0;  // 0: no terrain
+    uint64_t seed = 0;
+};
+
+// Streams a session to disk for ReplayRunner: a header holding the step, the terrain and a
+// snapshot of the starting state, then a record for every tick and every operator action,
+// stamped with the tick count it followed (counts restart from zero after a reset). Records
+// collect in memory and go out in blocks of FlushBytes, so a tick costs two state hashes and
+// about 20 bytes.
+class ReplayRecorder {
+private:
+    std::FILE* m_file;
+    ByteWriter m_buffer;
+    uint64_t m_lastTick;
+    uint64_t m_bytesWritten;
+    
+    void Begin(ReplayRecord type, uint64_t tick);
+    void FlushIfFull();
+    
+public:
+    static constexpr uint32_t Version = 1;
+    static constexpr size_t FlushBytes = 64 * 1024;
+    
+    ReplayRecorder();
+    ~ReplayRecorder();
+    
+    ReplayRecorder(const ReplayRecorder&) = delete;
+    ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+    
+    bool Open(const std::string& path, float step, const ReplayTerrain& terrain,
+              const SimulationEngine& simulation, const AISystem* ai);
+    // Flushes what is buffered; also done on destruction
+    void Close();
+    bool IsOpen() const { return m_file != nullptr; }
+    
+    void RecordTick(const SimulationEngine& simulation, const AISystem* ai);
+    void RecordCommand(uint64_t tick, const std::string& command);
+    void RecordMoveOrder(uint64_t tick, const glm::vec3& target);
+    void RecordSpeed(uint64_t tick, float speed);
+    void RecordRestart(uint64_t tick, const ReplayTerrain& terrain);
+    // The simulation (and AI) as just replaced, e.g. by loading a snapshot, at tick count tick
+    void RecordSnapshot(uint64_t tick, const SimulationEngine& simulation, const AISystem* ai);
+    bool Flush();
+    
+    // Written so far, buffered bytes included
+    uint64_t GetBytesWritten() const { return m_bytesWritten + m_buffer.Size(); }
+};
+
+struct ReplayResult {
+    bool loaded = false;
+    uint64_t ticks = 0;           // Replayed and verified
+    uint64_t actions = 0;         // Operator records applied
+    bool diverged = false;
+    std::string divergence;       // First difference from the recording
+    bool truncated = false;       // The log ends partway through a record
+    double wallSeconds = 0.0;
+    float simulationTime = 0.0f;
+    uint64_t stateHash = 0;
+    
+    double TicksPerSecond() const { return wallSeconds > 0.0 ? ticks / wallSeconds : 0.0; }
+};
+
+// Re-runs a recorded session headless, as fast as the CPU allows, checking the simulation
+// and AI state hashes after every tick against the recording. Stops at the first divergence.
+class ReplayRunner {
+private:
+    int m_threads;
+    bool m_verbose;
+    std::unique_ptr<TerrainEngine> m_terrain;
+    std::unique_ptr<SimulationEngine> m_simulation;
+    std::unique_ptr<AISystem> m_ai;
+    
+public:
+    explicit ReplayRunner(int threads = 1, bool verbose = false);
+    ~ReplayRunner();
+    
+    ReplayResult Run(const std::string& path);
+    static void PrintSummary(const ReplayResult& result);
+};
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+namespace TS {
+
+struct ClockStats {
+    int substeps = 0;              // Steps run in the last frame
+    float droppedTime = 0.0f;      // Simulation seconds discarded in the last frame
+    int peakSubsteps = 0;          // Most steps run in any one frame
+    uint64_t frames = 0;
+    uint64_t totalSteps = 0;
+    double totalDroppedTime = 0.0;
+    
+    double SubstepsPerFrame() const { return frames ? (double)totalSteps / frames : 0.0; }
+};
+
+// Fixed-step scheduler decoupling the simulation from the frame rate. Each frame's wall-clock
+// time, scaled by the speed multiplier, builds up in an accumulator that is paid out in whole
+// steps, so the simulation advances the same way however frames are paced:
+//
+//     clock.BeginFrame(frameSeconds);
+//     while (clock.NextStep()) engine.Update(clock.GetStep());
+//     ... render, interpolating by clock.GetAlpha()
+//
+// A frame owes at most the max substeps; anything beyond is dropped rather than carried over,
+// so a slow frame makes the simulation fall behind instead of spiralling. DropBacklog drops the
+// rest of a frame's steps early, for callers with a wall-clock budget.
+class SimulationClock {
+private:
+    double m_accumulator;  // Scaled seconds not yet paid out
+    float m_step;
+    float m_speed;
+    int m_maxSubsteps;
+    int m_stepsDue;
+    ClockStats m_stats;
+    
+public:
+    static constexpr float DefaultStep = 1.0f / 60.0f;
+    // 100x time compression at 25 frames per second
+    static constexpr int DefaultMaxSubsteps = 240;
+    
+    explicit SimulationClock(float step = DefaultStep, int maxSubsteps = DefaultMaxSubsteps);
+    
+    void SetSpeed(float speed);
+    float GetSpeed() const { return m_speed; }
+    float GetStep() const { return m_step; }
+    void SetMaxSubsteps(int steps);
+    int GetMaxSubsteps() const { return m_maxSubsteps; }
+    
+    void BeginFrame(float frameSeconds);
+    // True while the frame still owes a step; the caller then runs exactly one
+    bool NextStep();
+    void DropBacklog();
+    
+    // How far past the last step the accumulator is, in steps (0..1): render state is
+    // interpolated this far from the previous step's to the current one
+    float GetAlpha() const { return std::min((float)(m_accumulator / m_step), 1.0f); }
+    const ClockStats& GetStats() const { return m_stats; }
+    // Empties the accumulator and statistics; speed and limits are kept
+    void Reset();
+};
+
+}
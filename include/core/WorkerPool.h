@@ -0,0 +1,44 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TS {
+
+// Fixed-size pool for data-parallel loops. The calling thread takes part in every
+// ParallelFor, so a pool of N threads starts N - 1 workers.
+class WorkerPool {
+private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    
+    const std::function<void(size_t, size_t)>* m_job;
+    size_t m_jobCount;
+    uint64_t m_generation;
+    int m_pending;
+    bool m_stopping;
+    
+    void WorkerLoop(int workerIndex);
+    void RunChunk(int chunk, size_t count, const std::function<void(size_t, size_t)>& fn) const;
+    
+public:
+    explicit WorkerPool(int threadCount);
+    ~WorkerPool();
+    
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    
+    // Splits [0, count) into one contiguous chunk per thread and blocks until all are done.
+    // Chunk boundaries depend only on count and thread count.
+    void ParallelFor(size_t count, const std::function<void(size_t begin, size_t end)>& fn);
+    
+    int GetThreadCount() const { return (int)m_workers.size() + 1; }
+};
+
+}
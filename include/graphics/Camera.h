@@ -32,8 +32,12 @@ private:
 public:
     Camera(glm::vec3 position = glm::vec3(0.0f, 100.0f, 500.0f));
     
-    glm::mat4 GetViewMatrix();
+    glm::mat4 GetViewMatrix() const;
     glm::mat4 GetProjectionMatrix(float aspect) const;
+    // World-space ray through a window pixel (origin top-left, as GLFW reports the cursor):
+    // starts at the camera, direction normalized. Needs no GL context.
+    void ScreenRay(float screenX, float screenY, float viewportWidth, float viewportHeight,
+                   glm::vec3& origin, glm::vec3& direction) const;
     glm::vec3 GetPosition() const { return m_position; }
     glm::vec3 GetFront() const { return m_front; }
     float GetZoom() const { return m_zoom; }
@@ -6,7 +6,8 @@ namespace TS {
 
 class EntitySymbols {
 public:
-    static void RenderUnitSymbol(const Unit& unit);
+    // alpha interpolates between the unit's last two ticks, see SimulationClock::GetAlpha
+    static void RenderUnitSymbol(const Unit& unit, float alpha = 1.0f);
     static void RenderPersonnelSymbol(const glm::vec3& position, const glm::vec3& color, bool isAllied, float healthPercent = 1.0f);
     static void RenderVehicleSymbol(const glm::vec3& position, const glm::vec3& color, bool isAllied, float healthPercent = 1.0f);
     static void RenderEquipmentSymbol(const glm::vec3& position, const glm::vec3& color, bool isAllied, float healthPercent = 1.0f);
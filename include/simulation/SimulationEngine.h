@@ -2,10 +2,19 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <algorithm>
+#include <deque>
 #include "Unit.h"
+#include "SpatialGrid.h"
+#include "terrain/TerrainEngine.h"
+#include "terrain/PathService.h"
+#include "core/WorkerPool.h"
 
 namespace TS {
 
+class AISystem;
+class ByteWriter;
+
 enum class SimulationState {
     STOPPED,
     RUNNING,
@@ -14,13 +23,81 @@ enum class SimulationState {
 
 class SimulationEngine {
 private:
-    // FIXED: Only store units in ONE container, not two
+    // All unit state lives in the SoA store; m_units are handles onto its slots, one heap
+    // object per unit so the Unit* callers hold stays valid until that unit is removed
+    UnitStore m_store;
     std::vector<std::unique_ptr<Unit>> m_units;
     SimulationState m_state;
     float m_simulationTime;
+    float m_activityTimer;
     int m_nextUnitId;
     
+    // Rebuilt every tick; cell size equals the contact range
+    SpatialGrid m_contactGrid;
+    // Per-slot contact partner gathered before any damage is applied (-1 = none)
+    std::vector<int> m_contactPartners;
+    
+    // Movement and contact gathering are split across these threads
+    std::unique_ptr<WorkerPool> m_workers;
+    
+    // Terrain is owned by the Application; sensors need it for their viewsheds
+    const TerrainEngine* m_terrain;
+    std::map<int, Viewshed> m_sensorViewsheds; // Keyed by unit id
+    // Per-tick scratch for the batched ground lookup under sensors and the parallel sweeps
+    std::vector<uint32_t> m_sensorSlots;
+    std::vector<float> m_sensorX, m_sensorZ, m_sensorGround;
+    std::vector<Viewshed*> m_sensorViews;
+    
+    // Route requests answered in the background; each answer is applied exactly
+    // PathLatencyTicks after it was asked for (waiting if it is late), so runs stay reproducible
+    struct PendingPath {
+        uint64_t ticket;
+        int unitId;
+        glm::vec3 start;  // Kept so a restored snapshot can ask again
+        glm::vec3 goal;
+        uint64_t dueTick;
+    };
+    // Many units ordered to one cell share a single flow field instead, on the same schedule
+    struct PendingFlow {
+        uint64_t ticket;                         // 0 when the field came from the cache
+        Mobility mobility;
+        int goalVertex;
+        uint64_t terrainRevision;
+        std::shared_ptr<const FlowField> field;  // Set once known
+        std::vector<std::pair<int, glm::vec3>> units;  // Unit id and the destination it was sent to
+        uint64_t dueTick;
+    };
+    std::unique_ptr<PathService> m_paths;
+    // The path graph for the terrain is built on the path thread too, and published the same way:
+    // at m_pathFinderDueTick, a number of ticks fixed by the grid size. Until then units move in
+    // straight lines.
+    std::shared_ptr<const PathFinder> m_pathFinder;
+    uint64_t m_pathFinderRevision;  // Terrain revision the graph is for; 0: none asked for yet
+    uint64_t m_pathFinderTicket;    // 0 once taken
+    uint64_t m_pathFinderDueTick;
+    std::deque<PendingPath> m_pendingPaths;
+    std::deque<PendingFlow> m_pendingFlows;
+    FlowFieldCache m_flowFields;
+    int m_flowFieldGroupSize;
+    std::vector<uint32_t> m_pathRequests;  // Per-tick scratch: slots needing a route
+    uint64_t m_tickCount;
+    
+    bool UpdatePathFinder();  // False until the graph for the current terrain is published
+    void RequestPathFinder(uint64_t dueTick);
+    uint64_t PathFinderLatency() const;
+    void UpdatePaths();
+    void DrainPaths();
+    void UpdateSensorViewsheds();
+    void RebuildUnitHandles();
+    
 public:
+    static constexpr uint64_t PathLatencyTicks = 3;
+    // Graph build budget: a path thread builds around 12k-20k cells in a 60 Hz tick, so at 1x a
+    // graph is normally ready before it is due; faster runs may still wait for it
+    static constexpr uint64_t PathFinderCellsPerTick = 4096;
+    static constexpr int DefaultFlowFieldGroupSize = 32;
+    static constexpr uint32_t SnapshotVersion = 3;  // 2: AI random stream, 3: path graph schedule
+    
     SimulationEngine();
     ~SimulationEngine();
     
@@ -32,14 +109,55 @@ public:
     void Pause() { m_state = SimulationState::PAUSED; }
     void Stop() { m_state = SimulationState::STOPPED; }
     
+    void SetTerrain(const TerrainEngine* terrain) {
+        m_terrain = terrain;
+        m_pathFinderRevision = 0;
+    }
+    // Units and engine post sounds here; null (the default) runs silent
+    void SetAudioQueue(AudioEventQueue* audio) { m_store.audio = audio; }
+    // Seeds every unit's random stream; the same seed replays the same run
+    void SetSeed(uint64_t seed) { m_store.rngSeed = seed; }
+    uint64_t GetSeed() const { return m_store.rngSeed; }
+    // Results are bit-identical for any thread count
+    void SetThreadCount(int threads);
+    int GetThreadCount() const { return m_workers->GetThreadCount(); }
+    // Units sent to one cell in the same tick share a flow field once there are this many of
+    // them (0: never); fields still cached are shared by any number
+    void SetFlowFieldGroupSize(int units) { m_flowFieldGroupSize = std::max(units, 0); }
+    int GetFlowFieldGroupSize() const { return m_flowFieldGroupSize; }
+    
     void CreateScenario(const std::string& scenarioName);
     int AddUnit(UnitType type, const glm::vec3& position, bool isAllied = true);
+    // Valid until the unit is removed (disabled units go at the end of the tick), the engine
+    // is reset or a snapshot is read
     Unit* GetUnit(int unitId);
     std::vector<Unit*> GetAllUnits() const;
+    const Viewshed* GetSensorViewshed(int unitId) const;
+    // Operator orders to the allied team (ADVANCE, DEFEND, PATROL, WITHDRAW, RECON, or a move to
+    // a point); they depend only on simulation state, so a replay reproduces them. Returns how
+    // many units were ordered.
+    int CommandAllied(const std::string& command);
+    int CommandAlliedTo(const glm::vec3& target);
     
     SimulationState GetState() const { return m_state; }
     float GetSimulationTime() const { return m_simulationTime; }
-    int GetUnitCount() const { return m_units.size(); }
+    // Ticks run since the last reset
+    uint64_t GetTickCount() const { return m_tickCount; }
+    int GetUnitCount() const { return m_store.Size(); }
+    const UnitStore& GetUnitStore() const { return m_store; }
+    // FNV-1a over every unit's simulation state and the clock
+    uint64_t ComputeStateHash() const;
+    
+    // Versioned binary snapshot of the whole run: units, routes, clocks, random streams and,
+    // when given, the AI. A restored engine carries on exactly as the saved one would have.
+    // Terrain is not included; flow fields and routes still in flight are recomputed against
+    // the terrain set when the snapshot is read.
+    void WriteSnapshot(ByteWriter& out, const AISystem* ai = nullptr) const;
+    // Leaves everything untouched and returns false on a malformed or mismatched snapshot
+    bool ReadSnapshot(const uint8_t* data, size_t size, AISystem* ai = nullptr);
+    // One buffered write; loading maps the file instead of reading it
+    bool SaveSnapshot(const std::string& path, const AISystem* ai = nullptr) const;
+    bool LoadSnapshot(const std::string& path, AISystem* ai = nullptr);
 };
 
 }
@@ -0,0 +1,84 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace TS {
+
+struct UnitStore;
+
+// Uniform grid over the XZ plane, bucketed per team. Units are referenced by their
+// UnitStore slot; with the cell size equal to the contact range every contact
+// partner lies in the opposing team's 3x3 block of cells around a unit.
+class SpatialGrid {
+private:
+    float m_cellSize;
+    float m_invCellSize;
+    std::vector<uint32_t> m_indices;  // Unit indices grouped by cell, ascending within a cell
+    size_t m_cellCount;
+    
+    // Dense layout when the occupied cells' bounding box is small next to the unit count, as it
+    // is on any map: cell (x, z, team) owns [m_cellStart[c], m_cellStart[c + 1]) of m_indices
+    int m_originX, m_originZ, m_width, m_depth;
+    std::vector<uint32_t> m_cellStart;
+    std::vector<uint32_t> m_cellOf;  // Scratch: each unit's cell, or UINT32_MAX if inactive
+    
+    // Sparse fallback for units scattered far apart
+    std::vector<std::pair<uint64_t, uint32_t>> m_entries;  // (cell key, unit index), sorted
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> m_cells;  // key -> [begin, end) in m_indices
+    
+    static uint64_t MakeKey(int cx, int cz, bool allied) {
+        return (uint64_t)(uint32_t)cx << 32 | (uint64_t)((uint32_t)cz & 0x7fffffffu) << 1 | (allied ? 1u : 0u);
+    }
+    int CellCoord(float v) const { return (int)std::floor(v * m_invCellSize); }
+    bool FindCell(int cx, int cz, bool allied, uint32_t& begin, uint32_t& end) const {
+        if (!m_cellStart.empty()) {
+            int x = cx - m_originX;
+            int z = cz - m_originZ;
+            if (x < 0 || z < 0 || x >= m_width || z >= m_depth) return false;
+            size_t cell = ((size_t)z * m_width + x) * 2 + (allied ? 1 : 0);
+            begin = m_cellStart[cell];
+            end = m_cellStart[cell + 1];
+            return begin < end;
+        }
+        auto it = m_cells.find(MakeKey(cx, cz, allied));
+        if (it == m_cells.end()) return false;
+        begin = it->second.first;
+        end = it->second.second;
+        return true;
+    }
+    void BuildSparse(const UnitStore& units);
+    
+public:
+    explicit SpatialGrid(float cellSize);
+    
+    // Rebuilds the index from scratch; a counting sort, O(N) in the unit count, unless the units
+    // are too scattered for the dense layout (then O(N log N))
+    void Build(const UnitStore& units);
+    void Clear();
+    
+    // Calls fn(index) for each unit of the given team in the 3x3 cell block around pos,
+    // ascending index within a cell
+    template<typename Fn>
+    void ForEachNear(const glm::vec3& pos, bool allied, Fn&& fn) const {
+        int cx = CellCoord(pos.x);
+        int cz = CellCoord(pos.z);
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                uint32_t begin, end;
+                if (!FindCell(cx + dx, cz + dz, allied, begin, end)) continue;
+                for (uint32_t i = begin; i < end; ++i) {
+                    fn(m_indices[i]);
+                }
+            }
+        }
+    }
+    
+    float GetCellSize() const { return m_cellSize; }
+    size_t GetCellCount() const { return m_cellCount; }
+};
+
+}
@@ -3,66 +3,68 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include "UnitStore.h"
+#include "audio/AudioEventQueue.h"
 
 namespace TS {
 
-enum class UnitType {
-    PERSONNEL,
-    VEHICLE,
-    EQUIPMENT,
-    SENSOR
-};
-
-enum class UnitState {
-    IDLE,
-    MOVING,
-    ACTIVE,
-    DISABLED
-};
+class SpatialGrid;
 
+// Lightweight handle onto one slot of a UnitStore. All state lives in the store, so a
+// Unit made on the spot is only valid until the store is compacted; the handles
+// SimulationEngine hands out are moved to their unit's new slot instead.
 class Unit {
 private:
-    int m_id;
-    UnitType m_type;
-    bool m_isAllied;
-    glm::vec3 m_position;
-    glm::vec3 m_destination;
-    glm::vec3 m_targetPosition; // For operator commands
-    float m_health;
-    float m_maxHealth;
-    float m_movementSpeed; // Configurable speed
-    UnitState m_state;
-    // Visual feedback for operator commands
-    std::string m_lastCommand;
-    float m_commandFeedbackTimer;
-    int m_commandExecutionCount;
+    friend class SimulationEngine;
+    
+    UnitStore* m_store;
+    uint32_t m_index;
+    
+    bool IsContactCandidate(uint32_t other) const;
+    void PostSound(SoundEvent sound) const;
     
 public:
-    Unit(int id, UnitType type, const glm::vec3& position, bool isAllied);
+    static constexpr float ContactRange = 25.0f;
+    // Fraction of speed kept on ground too steep for the unit's mobility class
+    static constexpr float MinTerrainSpeedFactor = 0.1f;
+    // Distance at which a route waypoint counts as reached; the same as arriving at the destination
+    static constexpr float WaypointRadius = 2.0f;
+    
+    Unit(UnitStore* store, uint32_t index);
     
-    void Update(float deltaTime);
-    void SetDestination(const glm::vec3& dest);
+    // One tick in two phases: Think makes decisions, Integrate moves the unit.
+    // Both only write this unit's slot.
+    void Think(float deltaTime);
+    void Integrate(float deltaTime);
     void SetTargetPosition(const glm::vec3& target);
     void SetMovementSpeed(float speed);
     void SetActiveCommand(const std::string& command, float duration = 3.0f);
     void TakeDamage(float damage);
-    void CheckContact(const std::vector<std::unique_ptr<Unit>>& allUnits, float deltaTime);
-    bool IsInContactRange(const Unit& other) const;
+    // Store index of the first opposing unit in contact range, or -1. The linear scan is
+    // the reference the grid query is benchmarked against.
+    int FindContact() const;
+    int FindContact(const SpatialGrid& grid) const;
+    // Attrition and feedback for one tick of contact; SimulationEngine applies it in slot
+    // order once every unit's partner has been found
+    void ApplyContact(float deltaTime);
     
-    int GetId() const { return m_id; }
-    UnitType GetType() const { return m_type; }
-    bool IsAllied() const { return m_isAllied; }
-    const glm::vec3& GetPosition() const { return m_position; }
-    const glm::vec3& GetTargetPosition() const { return m_targetPosition; }
-    float GetHealth() const { return m_health; }
-    float GetMaxHealth() const { return m_maxHealth; }
-    bool IsActive() const { return m_health > 0.0f; }
-    bool HasActiveCommand() const { return m_commandFeedbackTimer > 0.0f; }
-    const std::string& GetActiveCommand() const { return m_lastCommand; }
+    uint32_t GetIndex() const { return m_index; }
+    int GetId() const { return m_store->id[m_index]; }
+    UnitType GetType() const { return m_store->type[m_index]; }
+    bool IsAllied() const { return m_store->allied[m_index] != 0; }
+    const glm::vec3& GetPosition() const { return m_store->position[m_index]; }
+    // Between the previous tick's position (alpha 0) and the current one (alpha 1)
+    glm::vec3 GetRenderPosition(float alpha) const {
+        return glm::mix(m_store->previousPosition[m_index], m_store->position[m_index], alpha);
+    }
+    const glm::vec3& GetTargetPosition() const { return m_store->targetPosition[m_index]; }
+    float GetHealth() const { return m_store->health[m_index]; }
+    float GetMaxHealth() const { return m_store->maxHealth[m_index]; }
+    bool IsActive() const { return m_store->health[m_index] > 0.0f; }
+    bool HasActiveCommand() const { return m_store->commandFeedbackTimer[m_index] > 0.0f; }
+    const std::string& GetActiveCommand() const { return m_store->commands[m_index].lastCommand; }
     glm::vec3 GetRenderColor() const;
     std::string GetTypeString() const;
-    void SetCommand(const std::string& command) { m_lastCommand = command; }
-    std::string GetCommand() const { return m_lastCommand; }
 };
 
 }
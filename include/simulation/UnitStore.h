@@ -0,0 +1,108 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "terrain/FlowField.h"
+#include "terrain/TerrainRasters.h"
+
+namespace TS {
+
+class AudioEventQueue;
+class ByteWriter;
+class ByteReader;
+
+enum class UnitType {
+    PERSONNEL,
+    VEHICLE,
+    EQUIPMENT,
+    SENSOR
+};
+
+// Personnel and sensor teams move on foot; vehicles and towed equipment need gentler ground
+inline Mobility GetMobility(UnitType type) {
+    return type == UnitType::VEHICLE || type == UnitType::EQUIPMENT ? Mobility::Vehicle : Mobility::Foot;
+}
+
+enum class UnitState {
+    IDLE,
+    MOVING,
+    ACTIVE,
+    DISABLED
+};
+
+// Operator command feedback - read by the HUD, rarely touched by the tick
+struct UnitCommandState {
+    std::string lastCommand;
+    int executionCount = 0;
+};
+
+// Planned route to the current destination, filled in a few ticks after the destination changes
+struct UnitPath {
+    std::vector<glm::vec3> waypoints;  // Empty: head straight for the destination
+    size_t next = 0;                   // Waypoint being steered for
+    std::shared_ptr<const FlowField> flow;  // Group orders share one of these instead
+    glm::vec3 goal = glm::vec3(0.0f);  // Destination the route was requested for
+    bool requested = false;
+};
+
+// Structure-of-arrays storage for every simulated unit. Hot per-tick fields live in
+// parallel contiguous arrays indexed by slot; cold data sits in its own array.
+// Slot order is insertion order and survives RemoveInactive().
+struct UnitStore {
+    // Hot data
+    std::vector<int> id;
+    std::vector<UnitType> type;
+    std::vector<uint8_t> allied;
+    std::vector<UnitState> state;
+    std::vector<glm::vec3> position;
+    std::vector<glm::vec3> previousPosition;  // At the start of the latest tick, for render interpolation
+    std::vector<glm::vec3> destination;
+    std::vector<glm::vec3> targetPosition; // For operator commands
+    std::vector<float> health;
+    std::vector<float> maxHealth;
+    std::vector<float> movementSpeed;
+    std::vector<float> commandFeedbackTimer;
+    
+    // Per-unit behavior clocks and random stream position
+    std::vector<float> behaviorTimer;
+    std::vector<float> soundTimer;
+    std::vector<float> interactionTimer;
+    std::vector<uint64_t> rngCounter;
+    
+    // Cold data
+    std::vector<UnitCommandState> commands;
+    std::vector<UnitPath> paths;
+    
+    // Seed shared by every unit's counter-based random stream (stream = unit id)
+    uint64_t rngSeed = 0;
+    
+    // Sound sink for unit events; null keeps the simulation silent
+    AudioEventQueue* audio = nullptr;
+    
+    // Ground cost under each unit scales its speed; null moves at full speed everywhere
+    const TerrainRasters* terrain = nullptr;
+    
+    uint32_t Add(int unitId, UnitType unitType, const glm::vec3& pos, bool isAllied);
+    void Reserve(size_t count);
+    void Clear();
+    
+    // Compacts out units with no health left, keeping the survivors' relative order
+    void RemoveInactive();
+    
+    // Column by column, for snapshots. Left out: previousPosition (read back equal to position),
+    // maxHealth (follows from the type) and route flow fields, which the owner rebuilds.
+    void Write(ByteWriter& out) const;
+    // Replaces every unit; false on malformed input, with the store left empty
+    bool Read(ByteReader& in);
+    
+    size_t Size() const { return id.size(); }
+    int IndexOf(int unitId) const; // -1 when absent
+    
+private:
+    std::unordered_map<int, uint32_t> m_indexById;
+};
+
+}
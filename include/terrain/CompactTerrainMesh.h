@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "TerrainEngine.h"
+
+namespace TS {
+
+// 6 bytes instead of TerrainVertex's 44. Position X/Z are implicit in the vertex's place in its
+// patch and texture coordinates follow from them, so only height, normal and color are stored.
+struct CompactTerrainVertex {
+    uint16_t height;      // Quantized over the mesh's height range
+    uint8_t normal[2];    // Octahedral-encoded unit normal
+    uint8_t color;        // TerrainPalette index
+    uint8_t reserved;
+};
+static_assert(sizeof(CompactTerrainVertex) == 6, "CompactTerrainVertex must stay tightly packed");
+
+// Quantized terrain mesh cut into patches of at most PatchVertices^2 vertices, so every patch is
+// addressed with 16-bit strip indices. Patches of the same shape share one index list (at most
+// four shapes: interior, right edge, bottom edge, corner). Neighbouring patches duplicate their
+// shared row or column of vertices. CPU-side only; it needs no GL context.
+class CompactTerrainMesh {
+public:
+    static constexpr int PatchVertices = 256;
+    
+    struct Patch {
+        int x0, z0;              // Grid vertex of the patch's first vertex
+        int width, height;       // In vertices
+        size_t firstVertex;      // Into GetVertices()
+        int shape;               // Into GetIndices()
+    };
+    
+    CompactTerrainMesh();
+    
+    // Same vertices and triangles as TerrainMesh::BuildGeometry with the same arguments
+    void Build(const float* heightData, int width, int height, float scale = 1.0f);
+    
+    // Full-precision vertex of patch vertex i, matching the TerrainMesh vertex to within quantization
+    TerrainVertex Decode(const Patch& patch, int i) const;
+    // Grid vertex (x, z), taken from the patch that owns it
+    TerrainVertex DecodeAt(int x, int z) const;
+    
+    const std::vector<Patch>& GetPatches() const { return m_patches; }
+    const std::vector<CompactTerrainVertex>& GetVertices() const { return m_vertices; }
+    const std::vector<uint16_t>& GetIndices(int shape) const { return m_shapes[shape].indices; }
+    size_t GetVertexCount() const { return m_vertices.size(); }
+    size_t GetIndexCount() const;
+    size_t GetMemoryBytes() const;
+    
+    // Normal need not be unit length
+    static void EncodeNormal(const glm::vec3& normal, uint8_t out[2]);
+    static glm::vec3 DecodeNormal(const uint8_t in[2]);
+    
+private:
+    struct Shape {
+        int width, height;
+        std::vector<uint16_t> indices;
+    };
+    
+    std::vector<Patch> m_patches;
+    std::vector<Shape> m_shapes;
+    std::vector<CompactTerrainVertex> m_vertices;
+    int m_width, m_height;
+    int m_patchesX;
+    float m_heightMin, m_heightStep;   // Decoded height = m_heightMin + quantized * m_heightStep
+    
+    int ShapeFor(int width, int height);
+};
+
+}
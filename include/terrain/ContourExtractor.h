@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace TS {
+
+class WorkerPool;
+
+// Connected isolines of one elevation. Polyline i is points[starts[i]] .. points[starts[i + 1] - 1];
+// closed loops repeat their first point at the end.
+struct ContourLevel {
+    float elevation = 0.0f;
+    bool major = false;
+    std::vector<glm::vec2> points;    // Grid coordinates (x, z)
+    std::vector<uint32_t> starts;     // One past the last polyline's end is points.size()
+    
+    size_t PolylineCount() const { return starts.size(); }
+    uint32_t PolylineEnd(size_t i) const { return i + 1 < starts.size() ? starts[i + 1] : (uint32_t)points.size(); }
+};
+
+struct ContourSet {
+    std::vector<ContourLevel> levels;
+    uint64_t revision = 0;            // Terrain revision the lines were extracted from
+    
+    size_t PointCount() const;
+    size_t PolylineCount() const;
+};
+
+// Marching squares over a row-major heightfield. Crossing points are shared by the two cells
+// on either side of their edge, so segments link into polylines as the rows are scanned and
+// no point is emitted twice. Saddle cells are split by the average of their corners.
+class ContourExtractor {
+public:
+    static void ExtractLevel(const float* heights, int width, int height, float elevation, ContourLevel& out);
+    // One level per elevation; levels are split across the pool when one is given
+    static void Extract(const float* heights, int width, int height, const std::vector<float>& elevations,
+                        ContourSet& out, WorkerPool* workers = nullptr);
+    // Levels base + k * interval for k in [0, count), identical to Extract over the same elevations.
+    // Each cell is visited once and emits segments only for the levels between its lowest and
+    // highest corner, so the cost is O(cells + segments) rather than O(levels x cells). With a
+    // pool, every thread makes one such pass over its own share of the levels.
+    static void ExtractEvenlySpaced(const float* heights, int width, int height, float base, float interval,
+                                    int count, ContourSet& out, WorkerPool* workers = nullptr);
+    
+private:
+    static void ExtractLevelRange(const float* heights, int width, int height, float base, float interval,
+                                  int first, int last, ContourLevel* out);
+};
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "TerrainRasters.h"
+
+namespace TS {
+
+// Direction toward one goal from every vertex of the grid, for any number of units sharing
+// that goal. Built by PathFinder::BuildFlowField: one Dijkstra outward from the goal, after
+// which each vertex keeps the step to its neighbour on the cheapest way back. Sampling is a
+// single lookup, however far away or numerous the units are.
+struct FlowField {
+    static constexpr uint8_t NoDirection = 0xFF;
+    
+    int width = 0, height = 0;
+    int goalVertex = -1;
+    Mobility mobility = Mobility::Foot;
+    uint64_t terrainRevision = 0;
+    std::vector<uint8_t> directions;  // Per vertex, row-major: a row of Sample's table or NoDirection
+    
+    bool IsEmpty() const { return directions.empty(); }
+    int VertexAt(float x, float z) const {
+        int ix = std::clamp((int)std::lround(x + width * 0.5f), 0, width - 1);
+        int iz = std::clamp((int)std::lround(z + height * 0.5f), 0, height - 1);
+        return iz * width + ix;
+    }
+    // Unit step (y = 0) toward the goal from the vertex nearest position. False at the goal
+    // itself and wherever it cannot be reached from, impassable ground included.
+    bool Sample(const glm::vec3& position, glm::vec3& direction) const {
+        static const float Steps[8][2] = {
+            {1.0f, 0.0f}, {-1.0f, 0.0f}, {0.0f, 1.0f}, {0.0f, -1.0f},
+            {0.70710678f, 0.70710678f}, {0.70710678f, -0.70710678f},
+            {-0.70710678f, 0.70710678f}, {-0.70710678f, -0.70710678f}
+        };
+        if (IsEmpty()) return false;
+        uint8_t k = directions[VertexAt(position.x, position.z)];
+        if (k == NoDirection) return false;
+        direction = glm::vec3(Steps[k][0], 0.0f, Steps[k][1]);
+        return true;
+    }
+    size_t GetMemoryBytes() const { return directions.capacity(); }
+};
+
+// The most recently used flow fields, keyed by mobility and goal vertex. Fields built for an
+// older terrain revision never match and are dropped as they are found.
+class FlowFieldCache {
+public:
+    static constexpr size_t DefaultCapacity = 8;
+    
+    explicit FlowFieldCache(size_t capacity = DefaultCapacity);
+    
+    std::shared_ptr<const FlowField> Find(Mobility mobility, int goalVertex, uint64_t revision);
+    // Replaces any field for the same goal; evicts the least recently used one when full
+    void Insert(std::shared_ptr<const FlowField> field);
+    void Clear();
+    // Least recently used first; inserting them in this order restores the same eviction order
+    std::vector<std::shared_ptr<const FlowField>> GetFields() const;
+    
+    size_t GetCount() const { return m_entries.size(); }
+    size_t GetMemoryBytes() const;
+    
+private:
+    struct Entry {
+        std::shared_ptr<const FlowField> field;
+        uint64_t lastUse;
+    };
+    std::vector<Entry> m_entries;
+    size_t m_capacity;
+    uint64_t m_useCounter;
+};
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace TS {
+
+class WorkerPool;
+
+// Inclusive range of grid vertices
+struct GridRect {
+    int x0, z0, x1, z1;
+};
+
+// Min/max mip pyramid over a row-major heightfield. A node at level L covers the
+// 2^L x 2^L cells from cell (nodeX << L, nodeZ << L), i.e. vertices nodeX << L through
+// (nodeX + 1) << L inclusive, clipped to the grid; neighbouring nodes share their edge
+// vertices, so any point on the bilinear surface inside a node lies within its range.
+// The base level is built from the heights directly: level 1 by default (a level 0 of single
+// cells would double the grid's memory for four loads saved), coarser to keep the pyramid small
+// next to a mapped grid. The last level is a single node over everything.
+class HeightPyramid {
+public:
+    struct Range {
+        float min, max;
+    };
+    
+    HeightPyramid();
+    
+    // heights must outlive the pyramid or the next Build/Clear. Base level L keeps 8 bytes per
+    // 4^L cells; queries scan up to (2^L + 1)^2 vertices where they only partly cover a node.
+    void Build(const float* heights, int width, int height, WorkerPool* workers = nullptr, int baseLevel = 1);
+    void Clear();
+    bool IsEmpty() const { return m_levels.empty(); }
+    
+    // Lowest and highest vertex inside rect (clipped to the grid); false when nothing is left
+    bool RegionMinMax(const GridRect& rect, float& minHeight, float& maxHeight) const;
+    
+    // Levels are numbered GetBaseLevel() .. GetLevelCount(); the last one is the whole grid
+    int GetBaseLevel() const { return m_baseLevel; }
+    int GetLevelCount() const { return m_baseLevel + (int)m_levels.size() - 1; }
+    const Range& GetRange() const { return m_levels.back().nodes[0]; }
+    int GetNodesX(int level) const { return m_levels[level - m_baseLevel].nodesX; }
+    int GetNodesZ(int level) const { return m_levels[level - m_baseLevel].nodesZ; }
+    const Range& GetNode(int level, int nodeX, int nodeZ) const {
+        const Level& l = m_levels[level - m_baseLevel];
+        return l.nodes[(size_t)nodeZ * l.nodesX + nodeX];
+    }
+    size_t GetMemoryBytes() const;
+    
+private:
+    struct Level {
+        int nodesX, nodesZ;
+        std::vector<Range> nodes;
+    };
+    
+    const float* m_heights;
+    int m_width, m_height;
+    int m_baseLevel;
+    std::vector<Level> m_levels;
+    
+    void Visit(int level, int nodeX, int nodeZ, const GridRect& rect, Range& out) const;
+};
+
+}
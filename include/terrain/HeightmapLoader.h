@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TS {
+
+enum class HeightmapFormat {
+    AUTO,         // From the extension: .r16/.raw, .r32/.f32/.flt, .asc
+    RAW_UINT16,   // Little-endian, row-major, no header
+    RAW_FLOAT32,  // Little-endian, row-major, no header
+    ESRI_ASCII    // ESRI ASCII grid (ncols/nrows/.../NODATA_value header)
+};
+
+// Read-only mapping of a whole file; pages are only read when touched
+class MappedFile {
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    
+public:
+    MappedFile();
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool Open(const std::string& path);
+    void Close();
+    // Sequential read-ahead hint for [offset, offset + length)
+    void AdviseSequential(size_t offset, size_t length) const;
+    // Disables read-ahead for [offset, offset + length), for sparse access
+    void AdviseRandom(size_t offset, size_t length) const;
+    
+    const uint8_t* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+};
+
+struct HeightmapLoadOptions {
+    HeightmapFormat format = HeightmapFormat::AUTO;
+    int width = 0, height = 0;       // Raw files only; 0 = square, inferred from the file size
+    // Sub-rectangle to load in file grid cells; a zero size runs to the file's edge
+    int windowX = 0, windowZ = 0;
+    int windowWidth = 0, windowHeight = 0;
+    float heightScale = 1.0f;        // Multiplies 16-bit samples
+};
+
+struct HeightmapLoadStats {
+    size_t bytesRead = 0;            // File bytes actually touched
+    double seconds = 0.0;
+    size_t peakResidentBytes = 0;    // Process high-water mark after the load
+    bool zeroCopy = false;           // Heights point straight into the mapping
+    
+    double MegabytesPerSecond() const { return seconds > 0.0 ? bytesRead / (1024.0 * 1024.0) / seconds : 0.0; }
+};
+
+// Loaded heights, row-major. Either an owned copy or, for full-width float32 windows,
+// a view into the mapped file that stays valid as long as this object lives.
+struct Heightmap {
+    int width = 0, height = 0;
+    // Not scanned for mapped views (hasRange false): reading every page is left to the caller,
+    // which can take the range from its own pass over the heights
+    float minHeight = 0.0f, maxHeight = 0.0f;
+    bool hasRange = false;
+    std::vector<float> owned;
+    std::unique_ptr<MappedFile> mapping;
+    const float* data = nullptr;
+};
+
+class HeightmapLoader {
+private:
+    static bool LoadRaw(const std::string& path, HeightmapFormat format, const HeightmapLoadOptions& options,
+                        Heightmap& out, HeightmapLoadStats& stats);
+    static bool LoadEsriAscii(const std::string& path, const HeightmapLoadOptions& options,
+                              Heightmap& out, HeightmapLoadStats& stats);
+    
+public:
+    static bool Load(const std::string& path, const HeightmapLoadOptions& options, Heightmap& out,
+                     HeightmapLoadStats* stats = nullptr);
+    static HeightmapFormat FormatFromExtension(const std::string& path);
+    // Grid size of a headerless raw file holding fileBytes; false when it cannot be inferred
+    static bool ResolveRawDimensions(size_t fileBytes, HeightmapFormat format, const HeightmapLoadOptions& options,
+                                     int& width, int& height);
+    // Clamps the options' window to a fileWidth x fileHeight grid; false when nothing is left
+    static bool ResolveWindow(const HeightmapLoadOptions& options, int fileWidth, int fileHeight,
+                              int& x0, int& z0, int& width, int& height);
+    static size_t PeakResidentBytes();
+};
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "FlowField.h"
+#include "HeightPyramid.h"
+#include "TerrainRasters.h"
+
+namespace TS {
+
+class WorkerPool;
+
+// Hierarchical A* (HPA*) over the traversal cost rasters. The grid is cut into square
+// clusters. Where passable vertex pairs cross a cluster border, the longest run joining each
+// pair of regions (passable areas connected inside their cluster) becomes an entrance, and
+// entrances of a cluster are joined by their cost and path inside it, kept as one byte per
+// step. A query then runs a Dijkstra in the start and goal clusters and an A* over the
+// entrances, and unpacks the stored steps, so long paths cost little more than short ones.
+// Paths are near-optimal: they only change cluster at an entrance.
+//
+// Moves are 8-connected, never cutting the corner of an impassable vertex. A step between
+// neighbours costs its length times the mean of the two vertex costs. Immutable once built,
+// so any number of threads may query it at once.
+class PathFinder {
+public:
+    static constexpr int DefaultClusterSize = 32;
+    
+    PathFinder();
+    
+    // Keeps rasters alive for as long as the PathFinder exists
+    void Build(std::shared_ptr<const TerrainRasters> rasters, int clusterSize = DefaultClusterSize,
+               WorkerPool* workers = nullptr);
+    bool IsEmpty() const { return !m_rasters || m_rasters->IsEmpty(); }
+    
+    // Waypoints from near from to exactly to (world coordinates, y taken from to), one per change
+    // of direction; from itself is not included. A unit standing on impassable ground may still
+    // step off it. False, leaving waypoints empty, when the goal cannot be reached.
+    bool FindPath(Mobility mobility, const glm::vec3& from, const glm::vec3& to,
+                  std::vector<glm::vec3>& waypoints, float* cost = nullptr) const;
+    // Same contract, but plain A* over every vertex: optimal, and far slower on long paths
+    bool FindGridPath(Mobility mobility, const glm::vec3& from, const glm::vec3& to,
+                      std::vector<glm::vec3>& waypoints, float* cost = nullptr) const;
+    
+    // Directions toward goal from the whole grid, for groups sharing it (see FlowField). Leaves
+    // field empty and returns false when the goal is impassable.
+    bool BuildFlowField(Mobility mobility, const glm::vec3& goal, FlowField& field) const;
+    // Grid vertex nearest a world position, clamped to the map; paths and flow fields start
+    // and end at these
+    int NearestVertex(const glm::vec3& position) const;
+    
+    int GetClusterSize() const { return m_clusterSize; }
+    size_t GetNodeCount(Mobility mobility) const { return m_graphs[(int)mobility].nodes.size(); }
+    size_t GetEdgeCount(Mobility mobility) const { return m_graphs[(int)mobility].edges.size(); }
+    uint64_t GetRevision() const { return m_rasters ? m_rasters->GetRevision() : 0; }
+    // The abstract graphs only; the rasters are shared with the terrain
+    size_t GetMemoryBytes() const;
+    
+private:
+    struct Edge {
+        int to;
+        float cost;
+        uint32_t firstStep;  // Path inside the cluster in steps; none for a border crossing
+        uint16_t stepCount;
+        bool reversed;       // Stored from the other end
+    };
+    // Entrance vertices and the edges between them, grouped by node (CSR)
+    struct Graph {
+        std::vector<int> nodes;              // Vertex index of each entrance
+        std::vector<int> nodeCluster;
+        std::vector<uint32_t> firstEdge;     // nodes.size() + 1 offsets into edges
+        std::vector<Edge> edges;
+        std::vector<uint32_t> clusterFirst;  // Cluster c owns clusterNodes[clusterFirst[c] ..]
+        std::vector<int> clusterNodes;
+        std::vector<uint8_t> steps;          // Indices into PathFinder.cpp's step table
+    };
+    
+    std::shared_ptr<const TerrainRasters> m_rasters;
+    int m_width, m_height;
+    int m_clusterSize;
+    int m_clustersX, m_clustersZ;
+    Graph m_graphs[MobilityCount];
+    
+    void BuildGraph(Mobility mobility, WorkerPool* workers);
+    int ClusterOf(int vertex) const;
+    GridRect ClusterRect(int cluster) const;
+    void ToWaypoints(const std::vector<int>& vertices, const glm::vec3& to, std::vector<glm::vec3>& waypoints) const;
+};
+
+}
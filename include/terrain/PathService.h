@@ -0,0 +1,75 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <glm/glm.hpp>
+#include "PathFinder.h"
+
+namespace TS {
+
+struct PathResult {
+    bool found = false;
+    std::vector<glm::vec3> waypoints;  // See PathFinder::FindPath
+    float cost = 0.0f;
+    std::shared_ptr<const FlowField> flowField;  // Flow field queries only; null when the goal is impassable
+    std::shared_ptr<const PathFinder> finder;    // Graph builds only
+};
+
+// Path and flow field queries answered on background threads in submission order. Submit never blocks;
+// each ticket is collected exactly once with Take.
+class PathService {
+private:
+    struct Job {
+        uint64_t ticket;
+        std::shared_ptr<const PathFinder> finder;
+        Mobility mobility;
+        glm::vec3 from, to;
+        bool flowField;
+        std::shared_ptr<const TerrainRasters> rasters;  // Set for a graph build instead of a query
+    };
+    
+    std::vector<std::thread> m_threads;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::deque<Job> m_queue;
+    std::unordered_map<uint64_t, PathResult> m_results;
+    std::unordered_set<uint64_t> m_discarded;  // Running when discarded; their answers are dropped
+    uint64_t m_nextTicket;
+    bool m_stopping;
+    
+    uint64_t Enqueue(Job job);
+    void WorkerLoop();
+    
+public:
+    explicit PathService(int threadCount = 1);
+    ~PathService();
+    
+    PathService(const PathService&) = delete;
+    PathService& operator=(const PathService&) = delete;
+    
+    // finder stays alive until the query has run, so the terrain may change meanwhile
+    uint64_t Submit(std::shared_ptr<const PathFinder> finder, Mobility mobility,
+                    const glm::vec3& from, const glm::vec3& to);
+    // Answered with a FlowField toward to instead of a path
+    uint64_t SubmitFlowField(std::shared_ptr<const PathFinder> finder, Mobility mobility, const glm::vec3& to);
+    // Builds a PathFinder over rasters, answered in PathResult::finder. Queries submitted after it
+    // wait behind the build, so callers hold them back until they have the graph anyway.
+    uint64_t SubmitPathFinder(std::shared_ptr<const TerrainRasters> rasters);
+    bool IsReady(uint64_t ticket) const;
+    // Blocks until ticket has been answered, then hands the result over
+    PathResult Take(uint64_t ticket);
+    // Gives up on ticket without waiting for it; in place of Take
+    void Discard(uint64_t ticket);
+    
+    size_t GetQueuedCount() const;
+    int GetThreadCount() const { return (int)m_threads.size(); }
+};
+
+}
@@ -2,10 +2,26 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <span>
+#include <utility>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <mutex>
 #include <glm/glm.hpp>
+#include "HeightmapLoader.h"
+#include "TileStore.h"
+#include "ContourExtractor.h"
+#include "HeightPyramid.h"
+#include "TerrainRasters.h"
+#include "PathFinder.h"
+#include "core/WorkerPool.h"
 
 namespace TS {
 
+class Camera;
+class TerrainLOD;
+
 struct TerrainVertex {
     glm::vec3 position;
     glm::vec3 normal;
@@ -13,46 +29,217 @@ struct TerrainVertex {
     glm::vec3 color;
 };
 
+// Elevation bands shared by every terrain mesh layout, deep water up to snow
+constexpr int TerrainPaletteSize = 8;
+extern const glm::vec3 TerrainPalette[TerrainPaletteSize];
+// Band of a vertex at the given (vertically scaled) mesh height
+uint8_t TerrainPaletteIndex(float height);
+
+// Where a view draws the ground: world y = elevation * scale + offset
+struct GroundPlacement {
+    float scale = 1.0f;
+    float offset = 0.0f;
+};
+// Application's contour grid: half the relief, lifted two units
+constexpr GroundPlacement ContourGridPlacement{0.5f, 2.0f};
+
+// Index count of a width x height vertex grid drawn as a single triangle strip
+inline size_t GridStripLength(int width, int height) {
+    if (width < 2 || height < 2) return 0;
+    return (size_t)(height - 1) * 2 * width + (size_t)(height - 2) * 2;
+}
+
+// Writes that strip: each row of quads left to right, rows joined by two degenerate indices.
+// Every row starts on an even index, so the winding matches the old triangle-list order.
+template<typename Index>
+void WriteGridStrip(int width, int height, Index* out) {
+    if (width < 2 || height < 2) return;
+    for (int z = 0; z < height - 1; ++z) {
+        const int top = z * width;
+        if (z > 0) {
+            *out++ = (Index)(top - 1);
+            *out++ = (Index)top;
+        }
+        for (int x = 0; x < width; ++x) {
+            *out++ = (Index)(top + x);
+            *out++ = (Index)(top + width + x);
+        }
+    }
+}
+
+// Visible-cell mask around an observer, (2 * radius + 1)^2 grid vertices row-major
+struct Viewshed {
+    int centerX = -1, centerZ = -1;   // Observer grid vertex
+    int radius = 0;
+    float observerHeight = 0.0f;
+    float gridOffsetX = 0.0f, gridOffsetZ = 0.0f;  // World -> grid translation
+    uint64_t terrainRevision = 0;
+    std::vector<uint8_t> mask;        // 1 = visible
+    
+    int Side() const { return 2 * radius + 1; }
+    bool IsVisible(float x, float z) const {
+        int ix = (int)std::lround(x + gridOffsetX) - (centerX - radius);
+        int iz = (int)std::lround(z + gridOffsetZ) - (centerZ - radius);
+        if (mask.empty() || ix < 0 || iz < 0 || ix >= Side() || iz >= Side()) return false;
+        return mask[iz * Side() + ix] != 0;
+    }
+};
+
 class TerrainMesh {
 private:
     std::vector<TerrainVertex> m_vertices;
-    std::vector<unsigned int> m_indices;
+    std::vector<unsigned int> m_indices;  // One triangle strip, see WriteGridStrip
     unsigned int m_VAO, m_VBO, m_EBO;
     int m_width, m_height;
     
+    void ReleaseBuffers();  // See TerrainRender.cpp
+    
 public:
     TerrainMesh();
     ~TerrainMesh();
     
-    void GenerateFromHeightmap(const std::vector<float>& heightData, int width, int height, float scale = 1.0f);
+    // CPU-side vertices and indices only, so it runs without a GL context
+    void BuildGeometry(const float* heightData, int width, int height, float scale = 1.0f);
+    // BuildGeometry followed by SetupMesh
+    void GenerateFromHeightmap(const float* heightData, int width, int height, float scale = 1.0f);
     void Render();
     void SetupMesh();
     float GetHeightAt(float x, float z) const;
+    
+    size_t GetVertexCount() const { return m_vertices.size(); }
+    size_t GetIndexCount() const { return m_indices.size(); }
+    size_t GetMemoryBytes() const {
+        return m_vertices.capacity() * sizeof(TerrainVertex) + m_indices.capacity() * sizeof(unsigned int);
+    }
 };
 
 class TerrainEngine {
 private:
     std::unique_ptr<TerrainMesh> m_terrainMesh;
-    std::vector<float> m_heightData;
+    std::vector<float> m_heightData;              // Owned heights (generated or copied on load)
+    std::unique_ptr<MappedFile> m_mappedHeights;  // Backing for in-place float32 files
     int m_width, m_height;
     float m_minHeight, m_maxHeight;
     float m_terrainScale;
+    bool m_meshDirty;
+    uint64_t m_revision;  // Bumped whenever the heightfield changes
+    const float* m_heights;  // Active heightfield, row-major m_width x m_height; null when tiled
+    std::unique_ptr<TileStore> m_tiles;  // Paged heightfield, used instead of m_heights
+    uint64_t m_seed;  // Last generated terrain
+    std::unique_ptr<WorkerPool> m_workers;
+    std::unique_ptr<TerrainLOD> m_lod;  // Chunked LOD mesh over m_heights; dropped when they change
+    HeightPyramid m_pyramid;            // Min/max over m_heights, rebuilt with them; empty when tiled
+    bool m_hierarchicalLOS;
+    // Built on first use after the heights change; shared so queued path queries keep their own
+    mutable std::shared_ptr<const TerrainRasters> m_rasters;
+    mutable std::shared_ptr<const PathFinder> m_pathFinder;
+    mutable std::mutex m_rastersMutex;  // Guards both
+    ContourSet m_contours;              // Cached until m_revision or the interval changes
+    float m_contourInterval;            // Units between isolines
+    unsigned int m_contourVBO;          // Every polyline of m_contours, uploaded for m_contourVBORevision
+    uint64_t m_contourVBORevision;
+    std::vector<int> m_contourFirsts, m_contourCounts;  // Minor polylines first, then major
+    size_t m_minorContourCount;
     
-    void RenderContourLines() const;
+    void RenderContourLines();
+    void ReleaseBuffers();  // GL side of the destructor, see TerrainRender.cpp
+    void ClearRasters();
+    void RefreshRasters() const;  // Caller holds m_rastersMutex
+    void UseTileStore(std::unique_ptr<TileSource> source, size_t cacheBytes, int tileSize);
+    
+    // Heights is DenseHeights or TiledHeights (TerrainEngine.cpp), so the in-memory path pays
+    // nothing for tiling. Bilinear height at fractional grid coordinates (caller keeps them in range).
+    template<typename Heights>
+    float SampleGrid(Heights& heights, float gx, float gz) const;
+    // Heightfield DDA between two world-space points; false when terrain occludes the segment.
+    // With a pyramid, whole nodes lying below the ray are stepped over in one jump.
+    template<typename Heights>
+    bool TraceLineOfSight(Heights& heights, const glm::vec3& from, const glm::vec3& to,
+                          const HeightPyramid* pyramid) const;
+    // Radial sweep body of ComputeViewshed; out is sized and centred by the caller
+    template<typename Heights>
+    void SweepViewshed(Heights& heights, const glm::vec3& observer, Viewshed& out) const;
     
 public:
     TerrainEngine();
     ~TerrainEngine();
     
+    // Raw 16-bit / float32 heightmaps or ESRI ASCII grids; the format follows the extension
     bool LoadTerrain(const std::string& filepath);
+    bool LoadTerrain(const std::string& filepath, const HeightmapLoadOptions& options,
+                     HeightmapLoadStats* stats = nullptr);
+    // Raw 16-bit / float32 heightmap paged in as tileSize^2 tiles through an LRU cache of at most
+    // cacheBytes, for grids too large to hold in memory. Nothing is read until queried.
+    bool LoadTiledTerrain(const std::string& filepath, const HeightmapLoadOptions& options,
+                          size_t cacheBytes = (size_t)512 << 20, int tileSize = 256);
     void GenerateRandomTerrain(int width = 512, int height = 512);
+    // Reproducible: the same seed gives the same heights on any thread count
+    void GenerateRandomTerrain(int width, int height, uint64_t seed);
+    // Same heights as GenerateRandomTerrain(width, height, seed), but computed tile by tile as
+    // queries reach them, so startup cost no longer scales with world area
+    void GenerateProceduralTerrain(int width, int height, uint64_t seed,
+                                   size_t cacheBytes = (size_t)512 << 20, int tileSize = 256);
     void Render();
+    // Chunked quadtree LOD keyed on the camera position instead of the full-resolution mesh
+    void Render(const Camera& camera, float viewportHeight = 720.0f);
     
+    // Bilinear ground height; positions off the map are clamped to its edge
     float GetElevationAt(float x, float z) const;
+    // out[i] = GetElevationAt(xs[i], zs[i]) for n points, vectorized on in-memory terrain
+    void GetElevationBatch(const float* xs, const float* zs, float* out, size_t n) const;
     bool HasLineOfSight(const glm::vec3& from, const glm::vec3& to) const;
+    // Batched LOS: out[i] = 1 when rays[i].first can see rays[i].second
+    void HasLineOfSight(std::span<const std::pair<glm::vec3, glm::vec3>> rays, std::span<uint8_t> out) const;
+    // On by default; switch off to trace every cell (for comparison)
+    void SetHierarchicalLineOfSight(bool enabled) { m_hierarchicalLOS = enabled; }
+    // First point within maxDistance where the ray meets the ground that GetElevationAt describes,
+    // placed vertically as the view draws it, for picking (see Camera::ScreenRay). Descends the
+    // min/max pyramid front to back and solves the ray against the bilinear surface of the few
+    // cells it reaches; tiled terrain walks the cells instead. False when the ray misses the map.
+    bool Raycast(const glm::vec3& origin, const glm::vec3& direction, glm::vec3& hit,
+                 float maxDistance = std::numeric_limits<float>::infinity(),
+                 const GroundPlacement& placement = GroundPlacement()) const;
+    
+    // Lowest and highest vertex in an inclusive grid rectangle, clipped to the map; false when
+    // nothing is left. Answered from the min/max pyramid on in-memory terrain.
+    bool RegionMinMax(const GridRect& rect, float& minHeight, float& maxHeight) const;
+    // Built with the heights on load and generation; empty for tiled terrain
+    const HeightPyramid& GetHeightPyramid() const { return m_pyramid; }
+    // Slope, aspect and per-Mobility traversal cost for every vertex, built across the worker
+    // pool on first use after the heights change; empty for tiled terrain
+    const TerrainRasters& GetRasters() const;
+    // The same rasters as a handle that outlives a terrain change, e.g. for a background build
+    std::shared_ptr<const TerrainRasters> GetSharedRasters() const;
+    // HPA* graph over those rasters, built on first use after they change; null for tiled terrain.
+    // The build takes seconds on large grids; SimulationEngine builds it on its path thread instead
+    // and hands it back through AdoptPathFinder.
+    std::shared_ptr<const PathFinder> GetPathFinder() const;
+    // Caches a graph built elsewhere, if it was built from the current rasters
+    void AdoptPathFinder(std::shared_ptr<const PathFinder> finder) const;
+    
+    // R2 radial sweep: one pass of rays to the square's perimeter marks every visible vertex
+    void ComputeViewshed(const glm::vec3& observer, int radius, Viewshed& out) const;
+    // Incremental variant: recomputes only when the observer moved more than one cell,
+    // the radius changed or the terrain was regenerated. Returns true if recomputed.
+    bool UpdateViewshed(const glm::vec3& observer, int radius, Viewshed& viewshed) const;
+    
     glm::vec3 GetTerrainSize() const;
+    uint64_t GetRevision() const { return m_revision; }
+    uint64_t GetSeed() const { return m_seed; }
+    // Threads used for terrain generation
+    void SetThreadCount(int threads);
+    int GetThreadCount() const { return m_workers->GetThreadCount(); }
+    const TileStore* GetTileStore() const { return m_tiles.get(); }
+    // Marching-squares isolines every GetContourInterval() units (every fifth is major), extracted
+    // in a single pass per worker on first use after the heights or interval change; empty for
+    // tiled terrain
+    const ContourSet& GetContours();
+    void SetContourInterval(float interval);
+    float GetContourInterval() const { return m_contourInterval; }
+    // Null until the first Render(camera) on in-memory terrain
+    TerrainLOD* GetLOD() const { return m_lod.get(); }
     
-    bool IsLoaded() const { return m_terrainMesh != nullptr && !m_heightData.empty(); }
+    bool IsLoaded() const { return m_terrainMesh != nullptr && (m_heights != nullptr || m_tiles != nullptr); }
 };
 
 }
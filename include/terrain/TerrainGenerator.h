@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace TS {
+
+class WorkerPool;
+
+// Seeded multi-octave sin/cos heightfield. Every height depends only on the seed and its grid
+// vertex, so any block can be generated on its own, in any order and on any number of threads.
+class TerrainGenerator {
+public:
+    static constexpr int Octaves = 5;
+    
+    explicit TerrainGenerator(uint64_t seed);
+    
+    // Heights of vertices [x0, x0 + width) x [z0, z0 + height), row-major with the given row
+    // stride. Rows are split across the pool when one is given.
+    void GenerateBlock(int x0, int z0, int width, int height, float* out, size_t stride,
+                       WorkerPool* workers = nullptr) const;
+    // One vertex, bit-identical to the same vertex of any block
+    float HeightAt(int x, int z) const;
+    
+    uint64_t GetSeed() const { return m_seed; }
+    float GetAmplitude() const { return m_amplitude; }
+    float GetFrequency() const { return m_frequency; }
+    float GetComplexity() const { return m_complexity; }
+    
+private:
+    uint64_t m_seed;
+    float m_amplitude;    // First octave; halves every octave
+    float m_frequency;    // First octave; doubles every octave
+    float m_complexity;
+    
+    float Noise(int x, int z) const;
+};
+
+}
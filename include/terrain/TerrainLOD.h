@@ -0,0 +1,133 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "TerrainEngine.h"
+
+namespace TS {
+
+struct TerrainLODSettings {
+    int chunkCells = 32;            // Quads per chunk side at every level; a power of two
+    float pixelTolerance = 2.0f;    // Largest screen-space error a chunk may show
+    float fovY = 0.785398f;         // Vertical field of view, radians
+    float viewportHeight = 720.0f;  // Pixels
+    int builderThreads = 2;         // Background chunk mesh builders
+    size_t maxCachedChunks = 4096;  // Chunks unused this frame are evicted above this
+};
+
+// Chunked quadtree LOD over a dense heightfield. Level 0 chunks sample every grid vertex and
+// each level up doubles the spacing, so every chunk holds the same (chunkCells + 1)^2 vertices.
+// Selection splits a chunk while its geometric error projects to more than pixelTolerance
+// pixels, keeps neighbouring chunks within one level of each other and drops the odd vertices
+// on edges that face a coarser neighbour, so no cracks open between levels. Meshes are built on
+// background threads; until all four children of a chunk are ready the chunk itself is drawn.
+class TerrainLOD {
+public:
+    struct Chunk {
+        int level, x0, z0;                  // Grid vertex of the first vertex; spacing 1 << level
+        std::vector<TerrainVertex> vertices;
+        unsigned int vbo = 0;               // Uploaded by Render
+        uint64_t lastUsedFrame = 0;
+    };
+    
+    // Stitch bits: the edge faces a coarser neighbour
+    enum : uint8_t { StitchWest = 1, StitchEast = 2, StitchNorth = 4, StitchSouth = 8 };
+    
+    struct DrawItem {
+        Chunk* chunk;
+        uint8_t stitch;
+    };
+    
+    struct FrameStats {
+        size_t chunks = 0;
+        size_t triangles = 0;
+        int finestLevel = 0;
+        size_t queuedBuilds = 0;     // Chunks waiting for a builder after this selection
+        size_t cachedChunks = 0;
+        double selectSeconds = 0.0;
+    };
+    
+    // heights (width x height, row-major) must outlive this object. Mesh y = height * scale.
+    // The per-chunk error pass is split across the pool when one is given.
+    TerrainLOD(const float* heights, int width, int height, float scale,
+               const TerrainLODSettings& settings = TerrainLODSettings(), WorkerPool* workers = nullptr);
+    ~TerrainLOD();
+    
+    TerrainLOD(const TerrainLOD&) = delete;
+    TerrainLOD& operator=(const TerrainLOD&) = delete;
+    
+    void SetProjection(float fovY, float viewportHeight);
+    void SetPixelTolerance(float pixels) { m_settings.pixelTolerance = pixels; }
+    
+    // Chooses the chunks to draw from a world-space eye position and queues missing meshes
+    const std::vector<DrawItem>& Select(const glm::vec3& eye);
+    // Draws the last selection; needs a GL context
+    void Render();
+    // Blocks until every queued chunk mesh is built
+    void WaitForBuilds();
+    
+    const FrameStats& GetFrameStats() const { return m_stats; }
+    const std::vector<DrawItem>& GetSelection() const { return m_selection; }
+    const std::vector<uint16_t>& GetIndices(uint8_t stitch) const { return m_indices[stitch]; }
+    int GetLevelCount() const { return (int)m_levels.size(); }
+    int GetChunkCells() const { return m_settings.chunkCells; }
+    // Largest height difference between the chunk's mesh and the full-resolution grid
+    float GetGeometricError(int level, int nodeX, int nodeZ) const;
+    
+private:
+    struct Level {
+        int nodesX, nodesZ;
+        std::vector<float> error;
+        std::vector<float> minY, maxY;
+        std::vector<uint8_t> split;   // Scratch for Select
+    };
+    
+    const float* m_heights;
+    int m_width, m_height;
+    float m_scale;
+    TerrainLODSettings m_settings;
+    float m_errorToPixels;             // Projected error = world error * this / distance
+    std::vector<Level> m_levels;       // Index = level; the last one is the root
+    std::vector<uint16_t> m_indices[16];
+    unsigned int m_ebos[16];
+    std::vector<unsigned int> m_retiredBuffers;  // Evicted chunks' VBOs, deleted by the next Render
+    
+    std::vector<DrawItem> m_selection;
+    FrameStats m_stats;
+    uint64_t m_frame;
+    
+    // Shared with the builder threads
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::unordered_map<uint64_t, std::unique_ptr<Chunk>> m_chunks;
+    std::unordered_set<uint64_t> m_queued;
+    std::deque<uint64_t> m_queue;
+    int m_building;
+    bool m_stopping;
+    std::vector<std::thread> m_builders;
+    
+    static uint64_t MakeKey(int level, int nodeX, int nodeZ) {
+        return (uint64_t)level << 56 | (uint64_t)(uint32_t)nodeZ << 28 | (uint32_t)nodeX;
+    }
+    float HeightAt(int x, int z) const;
+    void ComputeErrors(WorkerPool* workers);
+    void BuildIndices();
+    std::unique_ptr<Chunk> BuildChunk(int level, int nodeX, int nodeZ) const;
+    void BuilderLoop();
+    // Deletes every GL buffer this owns; a no-op in headless builds, where none are created
+    void ReleaseBuffers();
+    
+    bool Exists(int level, int nodeX, int nodeZ) const;
+    bool IsSplit(int level, int nodeX, int nodeZ) const;
+    float ProjectedError(int level, int nodeX, int nodeZ, const glm::vec3& eye) const;
+};
+
+}
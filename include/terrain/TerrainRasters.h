@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace TS {
+
+class WorkerPool;
+
+// How a unit crosses ground; the simulation maps each UnitType onto one of these
+enum class Mobility : uint8_t {
+    Foot,
+    Vehicle
+};
+constexpr int MobilityCount = 2;
+
+struct MobilityProfile {
+    float maxSlope;    // Rise over run above which the ground is impassable
+    float slopeCost;   // Traversal cost = 1 + slopeCost * slope below that
+};
+
+// Tuned to TerrainGenerator's exaggerated relief (median rise over run near 4.7 per cell)
+// rather than real-world grades: personnel are stopped only by the steepest few percent of the
+// map, vehicles by about a fifth of it (loose enough to leave it connected), and vehicles lose
+// more speed per unit of slope
+constexpr MobilityProfile MobilityProfiles[MobilityCount] = {
+    {9.5f, 0.25f},
+    {7.0f, 0.4f}
+};
+
+// Per-vertex rasters derived from a heightfield, one float per grid vertex, row-major. Slope is
+// the gradient magnitude (rise over run, central differences as the mesh normals use); aspect
+// is the direction the ground faces downhill, atan2(-dh/dz, -dh/dx) in radians, 0 along +x and
+// pi/2 along +z. Cost is a time multiplier, infinity where the slope is too steep.
+class TerrainRasters {
+public:
+    TerrainRasters();
+    
+    // Rows are split across the pool when one is given
+    void Build(const float* heights, int width, int height, WorkerPool* workers = nullptr);
+    void Clear();
+    bool IsEmpty() const { return m_slope.empty(); }
+    
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    const std::vector<float>& GetSlope() const { return m_slope; }
+    const std::vector<float>& GetAspect() const { return m_aspect; }
+    const std::vector<float>& GetCost(Mobility mobility) const { return m_cost[(int)mobility]; }
+    
+    // Nearest vertex to a world position (grid centred on the origin, as TerrainEngine places
+    // it); positions off the map take the edge
+    float CostAt(Mobility mobility, float x, float z) const;
+    float SlopeAt(float x, float z) const;
+    
+    uint64_t GetRevision() const { return m_revision; }
+    void SetRevision(uint64_t revision) { m_revision = revision; }
+    size_t GetMemoryBytes() const;
+    
+private:
+    int m_width, m_height;
+    uint64_t m_revision;   // Terrain revision the rasters were built from
+    std::vector<float> m_slope;
+    std::vector<float> m_aspect;
+    std::vector<float> m_cost[MobilityCount];
+    
+    size_t NearestVertex(float x, float z) const;
+};
+
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "HeightmapLoader.h"
+#include "TerrainGenerator.h"
+
+namespace TS {
+
+// Supplies tile contents to a TileStore on a cache miss. ReadBlock may be called from
+// several threads at once.
+class TileSource {
+public:
+    virtual ~TileSource() = default;
+    virtual int GetWidth() const = 0;
+    virtual int GetHeight() const = 0;
+    // Fills a width x height block of heights starting at grid vertex (x0, z0), row-major.
+    // The block always lies inside the grid.
+    virtual bool ReadBlock(int x0, int z0, int width, int height, float* out) const = 0;
+    // Single vertex without paging in its tile; false when the source has no cheap point path
+    virtual bool ReadPoint(int /*x*/, int /*z*/, float& /*height*/) const { return false; }
+};
+
+// Row-major raw uint16 / float32 file read with pread, so only the cache holds heights
+class RawTileSource : public TileSource {
+private:
+    int m_fd;
+    HeightmapFormat m_format;
+    size_t m_sampleSize;
+    int m_fileWidth;
+    int m_originX, m_originZ;   // Window origin in the file
+    int m_width, m_height;      // Window size
+    float m_heightScale;
+    
+public:
+    RawTileSource();
+    ~RawTileSource() override;
+    
+    RawTileSource(const RawTileSource&) = delete;
+    RawTileSource& operator=(const RawTileSource&) = delete;
+    
+    bool Open(const std::string& path, const HeightmapLoadOptions& options);
+    
+    int GetWidth() const override { return m_width; }
+    int GetHeight() const override { return m_height; }
+    bool ReadBlock(int x0, int z0, int width, int height, float* out) const override;
+    bool ReadPoint(int x, int z, float& height) const override;
+};
+
+// Heights computed from the seed on demand, so a world of any size costs nothing until queried
+class ProceduralTileSource : public TileSource {
+private:
+    TerrainGenerator m_generator;
+    int m_width, m_height;
+    
+public:
+    ProceduralTileSource(uint64_t seed, int width, int height) : m_generator(seed), m_width(width), m_height(height) {}
+    
+    int GetWidth() const override { return m_width; }
+    int GetHeight() const override { return m_height; }
+    bool ReadBlock(int x0, int z0, int width, int height, float* out) const override;
+    bool ReadPoint(int x, int z, float& height) const override;
+    
+    const TerrainGenerator& GetGenerator() const { return m_generator; }
+};
+
+// Fixed-size tiles paged in from a TileSource and kept in a bounded LRU cache.
+// Tile (tx, tz) holds vertices [tx * T, tx * T + T] x [tz * T, tz * T + T] - one vertex of
+// overlap with its neighbours - so every grid cell, and thus every bilinear sample, lies
+// inside a single tile.
+class TileStore {
+public:
+    struct Tile {
+        int x0, z0;                  // Grid vertex of sample 0
+        std::vector<float> heights;  // (T + 1)^2, clamped past the grid edge
+    };
+    
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        uint64_t pointReads;         // Sample() answered by the source without paging in
+        size_t residentTiles;
+        size_t residentBytes;
+        size_t bytesPagedIn;         // Heights read from the source, as float32
+        
+        double HitRate() const { return hits + misses > 0 ? (double)hits / (hits + misses) : 0.0; }
+    };
+    
+    // Per-query cursor: holds a reference to the last tile it used, so consecutive samples in
+    // one tile skip the cache lock and an evicted tile stays valid until the cursor moves on
+    class Reader {
+    private:
+        const TileStore* m_store;
+        std::shared_ptr<const Tile> m_tile;
+        int m_tileX, m_tileZ;
+        
+        void Seek(int tileX, int tileZ);
+        
+    public:
+        explicit Reader(const TileStore& store) : m_store(&store), m_tileX(-1), m_tileZ(-1) {}
+        
+        // Heights of the cell whose lower corner is vertex (x, z): h[0] = (x, z), h[1] = (x + 1, z),
+        // h[2] = (x, z + 1), h[3] = (x + 1, z + 1). x and z must be inside the grid.
+        void Cell(int x, int z, float h[4]);
+        float At(int x, int z);
+    };
+    
+    TileStore(std::unique_ptr<TileSource> source, int tileSize, size_t cacheBytes);
+    
+    TileStore(const TileStore&) = delete;
+    TileStore& operator=(const TileStore&) = delete;
+    
+    // Cached tile, paged in on a miss; null if the source failed
+    std::shared_ptr<const Tile> Acquire(int tileX, int tileZ) const;
+    // One vertex: from its tile when resident, else straight from the source when it can read
+    // points, else by paging the tile in. Scattered single lookups never fill the cache.
+    float Sample(int x, int z) const;
+    
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    int GetTileSize() const { return m_tileSize; }
+    size_t GetCapacity() const { return m_capacity; }
+    Stats GetStats() const;
+    void ResetStats();
+    // Height range of the tiles paged in so far; the whole grid is never scanned
+    void GetHeightRange(float& minHeight, float& maxHeight) const;
+    
+private:
+    using Entry = std::pair<uint64_t, std::shared_ptr<const Tile>>;
+    
+    std::unique_ptr<TileSource> m_source;
+    int m_width, m_height;
+    int m_tileSize;
+    size_t m_capacity;               // Tiles
+    
+    mutable std::mutex m_mutex;
+    mutable std::list<Entry> m_lru;  // Most recently used first
+    mutable std::unordered_map<uint64_t, std::list<Entry>::iterator> m_index;
+    mutable Stats m_stats;
+    mutable float m_minHeight, m_maxHeight;
+    
+    static uint64_t MakeKey(int tileX, int tileZ) { return (uint64_t)(uint32_t)tileX << 32 | (uint32_t)tileZ; }
+    int TileOf(int v, int extent) const { return std::min(v, extent - 2) / m_tileSize; }
+    std::shared_ptr<Tile> PageIn(int tileX, int tileZ) const;
+};
+
+}
@@ -1,11 +1,26 @@
 #include "ai/AISystem.h"
+#include "audio/AudioEventQueue.h"
+#include "core/ByteStream.h"
+#include "core/Random.h"
 #include <iostream>
 #include <cmath>
-#include <random>
 
 namespace TS {
 
-AISystem::AISystem() : m_updateTimer(0.0f), m_learningRate(0.1f), m_experience(0) {
+namespace {
+
+// Well clear of unit ids, which are the units' streams
+const uint64_t DecisionStream = 0xa15eedull << 32;
+
+}
+
+AISystem::AISystem()
+    : m_updateTimer(0.0f), m_learningRate(0.1f), m_experience(0), m_currentStrategy(0), m_audio(nullptr),
+      m_seed(0), m_rngCounter(0) {
+}
+
+int AISystem::Roll(int sides) {
+    return (int)(CounterHash(m_seed, DecisionStream, m_rngCounter++) % (uint64_t)sides);
 }
 
 AISystem::~AISystem() = default;
@@ -45,12 +60,8 @@ void AISystem::SetComplexity(int level) {
 
 void AISystem::LearnAndAdapt() {
     // Simulate AI learning from battlefield conditions
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> stratDist(0, m_strategies.size() - 1);
-    
     int oldStrategy = m_currentStrategy;
-    m_currentStrategy = stratDist(gen);
+    m_currentStrategy = Roll((int)m_strategies.size());
     
     if (oldStrategy != m_currentStrategy) {
         std::cout << "🧠 AI LEARNING: Switching from '" << m_strategies[oldStrategy] 
@@ -64,11 +75,7 @@ void AISystem::MakeStrategicDecision() {
               << "' with " << (int)(m_learningRate * 100) << "% adaptation rate" << std::endl;
     
     // Add randomized tactical commentary every decision
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> eventDist(1, 6);
-    
-    int randomEvent = eventDist(gen);
+    int randomEvent = 1 + Roll(6);
     switch (randomEvent) {
         case 1:
             std::cout << "📡 Intelligence reports: Opposition movement detected in sector 7" << std::endl;
@@ -93,7 +100,9 @@ void AISystem::MakeStrategicDecision() {
 
 void AISystem::ReactToPlayerInstruction(const std::string& command) {
     std::cout << "🔴 AI REACTION: Player used " << command << " - adapting red team strategy" << std::endl;
-    system("afplay /System/Library/Sounds/Sosumi.aiff > /dev/null 2>&1 &");
+    if (m_audio) {
+        m_audio->Post(SoundEvent::AI_REACTION);
+    }
     std::cout << "🎵 RED TEAM ADAPTING..." << std::endl;
     
     // AI reacts intelligently to player commands
@@ -119,4 +128,49 @@ void AISystem::ReactToPlayerInstruction(const std::string& command) {
     std::cout << "  📈  AI experience increased to " << m_experience << std::endl;
 }
 
+void AISystem::WriteSnapshot(ByteWriter& out) const {
+    out.Put(m_updateTimer);
+    out.Put(m_learningRate);
+    out.PutVarint((uint64_t)m_experience);
+    out.PutVarint((uint64_t)m_currentStrategy);
+    out.Put(m_seed);
+    out.PutVarint(m_rngCounter);
+}
+
+bool AISystem::ReadSnapshot(ByteReader& in) {
+    float updateTimer = in.Get<float>();
+    float learningRate = in.Get<float>();
+    int experience = (int)in.GetVarint();
+    int strategy = (int)in.GetVarint();
+    uint64_t seed = in.Get<uint64_t>();
+    uint64_t rngCounter = in.GetVarint();
+    if (!in.Ok() || (!m_strategies.empty() && strategy >= (int)m_strategies.size())) return false;
+    
+    m_updateTimer = updateTimer;
+    m_learningRate = learningRate;
+    m_experience = experience;
+    m_currentStrategy = strategy;
+    m_seed = seed;
+    m_rngCounter = rngCounter;
+    return true;
+}
+
+uint64_t AISystem::ComputeStateHash() const {
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    
+    mix(&m_updateTimer, sizeof(m_updateTimer));
+    mix(&m_learningRate, sizeof(m_learningRate));
+    mix(&m_experience, sizeof(m_experience));
+    mix(&m_currentStrategy, sizeof(m_currentStrategy));
+    mix(&m_rngCounter, sizeof(m_rngCounter));
+    return hash;
+}
+
 }
@@ -0,0 +1,146 @@
+#include "audio/AudioEventQueue.h"
+#include <cstdlib>
+#include <string>
+
+namespace TS {
+
+void AfplayAudioBackend::Play(SoundEvent sound) {
+    const char* name = nullptr;
+    switch (sound) {
+        case SoundEvent::STARTUP: name = "Glass"; break;
+        case SoundEvent::COMMAND_ISSUED: name = "Hero"; break;
+        case SoundEvent::AI_REACTION: name = "Sosumi"; break;
+        case SoundEvent::HEAVY_MOVEMENT: name = "Blow"; break;
+        case SoundEvent::BLUE_MANEUVER: name = "Submarine"; break;
+        case SoundEvent::RED_MANEUVER: name = "Morse"; break;
+        case SoundEvent::BLUE_CONTACT: name = "Ping"; break;
+        case SoundEvent::RED_CONTACT: name = "Pop"; break;
+        case SoundEvent::UNIT_LOST: name = "Basso"; break;
+        default: return;
+    }
+    
+    std::string command = std::string("afplay /System/Library/Sounds/") + name + ".aiff > /dev/null 2>&1 &";
+    system(command.c_str());
+}
+
+void AfplayAudioBackend::StopAll() {
+    system("pkill -f afplay > /dev/null 2>&1");
+}
+
+AudioEventQueue::AudioEventQueue(std::unique_ptr<AudioBackend> backend, size_t capacity,
+                                 std::chrono::milliseconds minInterval)
+    : m_backend(std::move(backend)), m_minInterval(minInterval),
+      m_enqueuePos(0), m_dequeuePos(0),
+      m_posted(0), m_dispatched(0), m_coalesced(0), m_dropped(0), m_running(true) {
+    
+    // Ring size must be a power of two for the index mask
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    m_slots = std::make_unique<Slot[]>(size);
+    m_mask = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    
+    if (!m_backend) {
+        m_backend = std::make_unique<NullAudioBackend>();
+    }
+    m_consumer = std::thread(&AudioEventQueue::ConsumerLoop, this);
+}
+
+AudioEventQueue::~AudioEventQueue() {
+    m_running.store(false, std::memory_order_release);
+    if (m_consumer.joinable()) {
+        m_consumer.join();
+    }
+}
+
+bool AudioEventQueue::Post(SoundEvent sound) {
+    m_posted.fetch_add(1, std::memory_order_relaxed);
+    
+    // Bounded MPMC ring (Vyukov): each slot's sequence says whose turn it is
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &m_slots[pos & m_mask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    
+    slot->sound = sound;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool AudioEventQueue::Pop(SoundEvent& sound) {
+    Slot& slot = m_slots[m_dequeuePos & m_mask];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if ((intptr_t)sequence - (intptr_t)(m_dequeuePos + 1) < 0) {
+        return false;
+    }
+    
+    sound = slot.sound;
+    slot.sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+    m_dequeuePos++;
+    return true;
+}
+
+void AudioEventQueue::ConsumerLoop() {
+    using Clock = std::chrono::steady_clock;
+    const size_t soundCount = (size_t)SoundEvent::COUNT;
+    Clock::time_point lastPlayed[soundCount] = {};
+    
+    // Anything still queued at shutdown is discarded rather than played
+    while (m_running.load(std::memory_order_acquire)) {
+        // Coalesce: one batch plays each sound at most once
+        bool pending[soundCount] = {};
+        SoundEvent sound;
+        while (Pop(sound)) {
+            size_t index = (size_t)sound;
+            if (index >= soundCount) continue;
+            if (pending[index]) {
+                m_coalesced.fetch_add(1, std::memory_order_relaxed);
+            }
+            pending[index] = true;
+        }
+        
+        Clock::time_point now = Clock::now();
+        for (size_t i = 0; i < soundCount; ++i) {
+            if (!pending[i]) continue;
+            if (now - lastPlayed[i] < m_minInterval) {
+                m_coalesced.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            lastPlayed[i] = now;
+            m_backend->Play((SoundEvent)i);
+            m_dispatched.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+void AudioEventQueue::StopAll() {
+    m_backend->StopAll();
+}
+
+AudioEventQueue::Stats AudioEventQueue::GetStats() const {
+    return Stats{
+        m_posted.load(std::memory_order_relaxed),
+        m_dispatched.load(std::memory_order_relaxed),
+        m_coalesced.load(std::memory_order_relaxed),
+        m_dropped.load(std::memory_order_relaxed)
+    };
+}
+
+}
@@ -5,79 +5,42 @@
 #include "simulation/SimulationEngine.h"
 #include "data/DatabaseManager.h"
 #include "ai/AISystem.h"
+#include "audio/AudioEventQueue.h"
+#include "core/Replay.h"
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <cmath>
 #include <cstring>
 #include <iomanip>
+#include <sstream>
+#include <limits>
+#include <glm/gtc/type_ptr.hpp>
 
 #include <OpenGL/gl.h>
 
 namespace TS {
 
-// Manual perspective function to replace gluPerspective
-void SetPerspective(float fovy, float aspect, float nearPlane, float farPlane) {
-    float ymax = nearPlane * tan(fovy * M_PI / 360.0);
-    float ymin = -ymax;
-    float xmin = ymin * aspect;
-    float xmax = ymax * aspect;
-    
-    glFrustum(xmin, xmax, ymin, ymax, nearPlane, farPlane);
-}
+namespace {
+
+const char* const SnapshotPath = "scenario.tssn";
+// Generated terrain sizes; replay logs record the same numbers
+const int StartTerrainSize = 256;
+const int RestartTerrainSize = 128;
 
-// Manual lookAt function to replace gluLookAt
-void SetLookAt(float eyeX, float eyeY, float eyeZ,
-               float centerX, float centerY, float centerZ,
-               float upX, float upY, float upZ) {
-    
-    // Calculate forward vector
-    float fx = centerX - eyeX;
-    float fy = centerY - eyeY;
-    float fz = centerZ - eyeZ;
-    
-    // Normalize forward
-    float flen = sqrt(fx*fx + fy*fy + fz*fz);
-    fx /= flen; fy /= flen; fz /= flen;
-    
-    // Calculate right vector (forward x up)
-    float rx = fy*upZ - fz*upY;
-    float ry = fz*upX - fx*upZ;
-    float rz = fx*upY - fy*upX;
-    
-    // Normalize right
-    float rlen = sqrt(rx*rx + ry*ry + rz*rz);
-    rx /= rlen; ry /= rlen; rz /= rlen;
-    
-    // Calculate up vector (right x forward)
-    float ux = ry*fz - rz*fy;
-    float uy = rz*fx - rx*fz;
-    float uz = rx*fy - ry*fx;
-    
-    // Create transformation matrix
-    float m[16] = {
-        rx, ux, -fx, 0,
-        ry, uy, -fy, 0,
-        rz, uz, -fz, 0,
-        0,  0,  0,   1
-    };
-    
-    glMultMatrixf(m);
-    glTranslatef(-eyeX, -eyeY, -eyeZ);
 }
 
 Application::Application() 
     : m_window(nullptr), m_isRunning(false), m_lastFrameTime(0.0f),
       m_lastMouseX(640), m_lastMouseY(360), m_firstMouse(true),
       m_lastCommand(""), m_commandFeedbackTimer(0.0f), m_commandExecutionCount(0),
-      m_simulationSpeed(1.0f), m_lastSpeedChange(std::chrono::steady_clock::now()) {
+      m_lastSpeedChange(std::chrono::steady_clock::now()),
+      m_simulationThreads(1), m_seed(0) {
     
     std::memset(m_keys, 0, sizeof(m_keys));
 }
 
 Application::~Application() {
-    // Kill any remaining audio processes before shutdown
-    system("pkill -f afplay > /dev/null 2>&1");
     Shutdown();
 }
 
@@ -108,6 +71,7 @@ bool Application::Initialize() {
     glfwSetWindowUserPointer(m_window, this);
     glfwSetKeyCallback(m_window, KeyCallback);
     glfwSetCursorPosCallback(m_window, MouseCallback);
+    glfwSetMouseButtonCallback(m_window, MouseButtonCallback);
     
     // Mouse starts free
     glfwSetInputMode(m_window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
@@ -138,10 +102,23 @@ bool Application::Initialize() {
         
         std::cout << "Initializing Terrain..." << std::endl;
         m_terrainEngine = std::make_unique<TerrainEngine>();
-        m_terrainEngine->GenerateRandomTerrain(256, 256);  // Much larger terrain
+        m_terrainEngine->SetThreadCount(m_simulationThreads);
+        if (m_seed) {
+            m_terrainEngine->GenerateRandomTerrain(StartTerrainSize, StartTerrainSize, m_seed);
+        } else {
+            m_terrainEngine->GenerateRandomTerrain(StartTerrainSize, StartTerrainSize);  // Much larger terrain
+        }
+        
+        std::cout << "Initializing Audio..." << std::endl;
+        m_audio = std::make_unique<AudioEventQueue>(std::make_unique<AfplayAudioBackend>());
         
         std::cout << "Initializing Simulation Engine..." << std::endl;
         m_simulationEngine = std::make_unique<SimulationEngine>();
+        m_simulationEngine->SetTerrain(m_terrainEngine.get());
+        m_simulationEngine->SetThreadCount(m_simulationThreads);
+        m_simulationEngine->SetAudioQueue(m_audio.get());
+        // Units and AI draw from the terrain's seed, so one number reproduces the session
+        m_simulationEngine->SetSeed(m_terrainEngine->GetSeed());
         m_simulationEngine->Initialize();
         
         std::cout << "Initializing Database..." << std::endl;
@@ -150,8 +127,18 @@ bool Application::Initialize() {
         
         std::cout << "Initializing AI..." << std::endl;
         m_aiSystem = std::make_unique<AISystem>();
+        m_aiSystem->SetAudioQueue(m_audio.get());
+        m_aiSystem->SetSeed(m_terrainEngine->GetSeed());
         m_aiSystem->Initialize();
         
+        if (!m_recordPath.empty()) {
+            m_recorder = std::make_unique<ReplayRecorder>();
+            ReplayTerrain terrain{StartTerrainSize, StartTerrainSize, m_terrainEngine->GetSeed()};
+            if (m_recorder->Open(m_recordPath, m_clock.GetStep(), terrain, *m_simulationEngine, m_aiSystem.get())) {
+                std::cout << "⏺️  Recording session to " << m_recordPath << std::endl;
+            }
+        }
+        
     } catch (const std::exception& e) {
         std::cerr << "Error initializing components: " << e.what() << std::endl;
         return false;
@@ -159,14 +146,19 @@ bool Application::Initialize() {
     
     std::cout << "\n=== Enhanced Terrain Simulator ===" << std::endl;
     std::cout << "✅ All systems initialized successfully!" << std::endl;
-    system("afplay /System/Library/Sounds/Glass.aiff > /dev/null 2>&1 &");
+    PlaySound(SoundEvent::STARTUP);
     std::cout << "\n🎮 Controls:" << std::endl;
     std::cout << "  TAB: Toggle mouse capture" << std::endl;
     std::cout << "  Arrow Keys: Move camera (←↑→↓)" << std::endl;
     std::cout << "  Page Up/Down: Move up/down" << std::endl;
     std::cout << "  Mouse: Look around (when captured)" << std::endl;
+    std::cout << "  Left click: Move blue forces to the ground under the cursor (when released)" << std::endl;
     std::cout << "  Space: Start/Pause simulation" << std::endl;
     std::cout << "  R: Restart with new terrain and scenario" << std::endl;
+    std::cout << "  F5/F9: Save/load a snapshot of the running scenario" << std::endl;
+    if (m_recorder && m_recorder->IsOpen()) {
+        std::cout << "  Session is being recorded; replay it with TerrainSimulatorHeadless --replay " << m_recordPath << std::endl;
+    }
     std::cout << "  ESC: Exit safely" << std::endl;
     std::cout << "\n� BLUE FORCE OPERATOR COMMANDS:" << std::endl;
     std::cout << "  1: Advance and secure area" << std::endl;
@@ -183,6 +175,7 @@ bool Application::Initialize() {
     std::cout << "  • YOU control the BLUE team (rectangles)" << std::endl;
     std::cout << "  • RED team is AI-controlled (diamonds)" << std::endl;
     std::cout << "  • Use keys 1-5 to give tactical orders" << std::endl;
+    std::cout << "  • Use - and = to slow down or speed up time (up to 100x)" << std::endl;
     std::cout << "  • Watch blue units respond to your commands" << std::endl;
     std::cout << "  • AI will counter your moves with red team" << std::endl;
     
@@ -215,15 +208,26 @@ void Application::Run() {
 
 void Application::Update(float deltaTime) {
     try {
-        // Apply simulation speed multiplier
-        float adjustedDeltaTime = deltaTime * m_simulationSpeed;
+        // Whole fixed steps only, however long the frame took; a paused simulation banks no time
+        bool running = m_simulationEngine && m_simulationEngine->GetState() == SimulationState::RUNNING;
+        m_clock.BeginFrame(running ? deltaTime : 0.0f);
         
-        if (m_simulationEngine) {
-            m_simulationEngine->Update(adjustedDeltaTime);
-        }
-        
-        if (m_aiSystem) {
-            m_aiSystem->Update(adjustedDeltaTime);
+        // Stepping may take this much wall-clock time per frame; steps still owed after it are
+        // dropped so rendering and input keep up
+        const double stepBudgetSeconds = 0.030;
+        auto stepStart = std::chrono::steady_clock::now();
+        while (m_clock.NextStep()) {
+            m_simulationEngine->Update(m_clock.GetStep());
+            if (m_aiSystem) {
+                m_aiSystem->Update(m_clock.GetStep());
+            }
+            if (m_recorder) {
+                m_recorder->RecordTick(*m_simulationEngine, m_aiSystem.get());
+            }
+            if (std::chrono::duration<double>(std::chrono::steady_clock::now() - stepStart).count() > stepBudgetSeconds) {
+                m_clock.DropBacklog();
+                break;
+            }
         }
         
         // Update command feedback timer (use normal deltaTime)
@@ -242,8 +246,14 @@ void Application::Update(float deltaTime) {
                     if (unit && unit->IsActive()) activeUnits++;
                 }
                 
+                // Formatted apart so the precision does not stick to std::cout
+                const ClockStats& clock = m_clock.GetStats();
+                std::ostringstream steps;
+                steps << std::fixed << std::setprecision(1) << clock.SubstepsPerFrame() << " steps/frame (peak "
+                      << clock.peakSubsteps << "), dropped " << clock.totalDroppedTime << "s";
                 std::cout << "🎯 Active Units: " << activeUnits 
-                          << " | Sim Time: " << m_simulationEngine->GetSimulationTime() << "s" << std::endl;
+                          << " | Sim Time: " << m_simulationEngine->GetSimulationTime() << "s"
+                          << " | Speed: " << m_clock.GetSpeed() << "x, " << steps.str() << std::endl;
             }
             statusTimer = 0.0f;
         }
@@ -255,22 +265,23 @@ void Application::Update(float deltaTime) {
 void Application::Render() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
-    // Set up camera
+    // Set up camera: the same matrices Camera::ScreenRay inverts, so clicks land where drawn
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(m_window, &framebufferWidth, &framebufferHeight);
+    glViewport(0, 0, framebufferWidth, framebufferHeight);
+    float aspect = framebufferWidth > 0 && framebufferHeight > 0
+        ? (float)framebufferWidth / (float)framebufferHeight : 1280.0f / 720.0f;
+    
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
-    SetPerspective(45.0f, 1280.0f / 720.0f, 0.1f, 2000.0f);
+    if (m_camera) {
+        glLoadMatrixf(glm::value_ptr(m_camera->GetProjectionMatrix(aspect)));
+    }
     
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
-    
     if (m_camera) {
-        glm::vec3 pos = m_camera->GetPosition();
-        glm::vec3 front = m_camera->GetFront();
-        glm::vec3 target = pos + front;
-        
-        SetLookAt(pos.x, pos.y, pos.z,
-                  target.x, target.y, target.z,
-                  0.0f, 1.0f, 0.0f);
+        glLoadMatrixf(glm::value_ptr(m_camera->GetViewMatrix()));
     }
     
     // Render 3D contoured grid terrain (NO white mesh, NO orange contours)
@@ -297,7 +308,7 @@ void Application::Render() {
                 glBegin(GL_LINE_STRIP);
                 for (int z = -gridSize; z <= gridSize; z += gridSpacing) {
                     float elevation = m_terrainEngine->GetElevationAt(x, z);
-                    glVertex3f(x, elevation * 0.5f + 2.0f, z);
+                    glVertex3f(x, elevation * ContourGridPlacement.scale + ContourGridPlacement.offset, z);
                 }
                 glEnd();
             }
@@ -307,7 +318,7 @@ void Application::Render() {
                 glBegin(GL_LINE_STRIP);
                 for (int x = -gridSize; x <= gridSize; x += gridSpacing) {
                     float elevation = m_terrainEngine->GetElevationAt(x, z);
-                    glVertex3f(x, elevation * 0.5f + 2.0f, z);
+                    glVertex3f(x, elevation * ContourGridPlacement.scale + ContourGridPlacement.offset, z);
                 }
                 glEnd();
             }
@@ -371,6 +382,7 @@ void Application::Render() {
     if (m_simulationEngine) {
         try {
             auto units = m_simulationEngine->GetAllUnits();
+            const float interpolation = m_clock.GetAlpha();
             
             // Disable lighting for symbols and enable better visibility
             glDisable(GL_LIGHTING);
@@ -380,7 +392,7 @@ void Application::Render() {
             
             for (const auto& unit : units) {
                 if (unit && unit->IsActive()) {
-                    glm::vec3 pos = unit->GetPosition();
+                    glm::vec3 pos = unit->GetRenderPosition(interpolation);
                     
                     // Enhanced visual feedback for units executing commands
                     if (unit->HasActiveCommand()) {
@@ -392,7 +404,7 @@ void Application::Render() {
                             glColor4f(1.0f, 0.5f, 0.0f, pulse); // Orange for red team
                         }
                         glLineWidth(10.0f);
-                        EntitySymbols::RenderUnitSymbol(*unit);
+                        EntitySymbols::RenderUnitSymbol(*unit, interpolation);
                         
                         // Command-specific visual indicators above unit
                         std::string activeCmd = unit->GetActiveCommand();
@@ -435,11 +447,11 @@ void Application::Render() {
                     // Standard glow effect around symbols
                     glColor4f(1.0f, 1.0f, 1.0f, 0.3f);
                     glLineWidth(6.0f);
-                    EntitySymbols::RenderUnitSymbol(*unit);
+                    EntitySymbols::RenderUnitSymbol(*unit, interpolation);
                     
                     // Render main symbol
                     glLineWidth(4.0f);
-                    EntitySymbols::RenderUnitSymbol(*unit);
+                    EntitySymbols::RenderUnitSymbol(*unit, interpolation);
                 }
             }
             
@@ -607,6 +619,19 @@ void Application::KeyCallback(GLFWwindow* window, int key, int scancode, int act
                 app->m_simulationEngine->Start();
                 std::cout << "▶️  Simulation started" << std::endl;
             }
+        } else if (key == GLFW_KEY_EQUAL || key == GLFW_KEY_MINUS) {
+            // Time compression in steps from quarter speed to 100x
+            static const float speeds[] = {0.25f, 0.5f, 1.0f, 2.0f, 5.0f, 10.0f, 25.0f, 50.0f, 100.0f};
+            const int count = (int)(sizeof(speeds) / sizeof(speeds[0]));
+            int current = 0;
+            while (current + 1 < count && speeds[current] < app->m_clock.GetSpeed()) current++;
+            current = std::clamp(current + (key == GLFW_KEY_EQUAL ? 1 : -1), 0, count - 1);
+            app->m_clock.SetSpeed(speeds[current]);
+            if (app->m_recorder && app->m_simulationEngine) {
+                app->m_recorder->RecordSpeed(app->m_simulationEngine->GetTickCount(), speeds[current]);
+            }
+            app->m_lastSpeedChange = std::chrono::steady_clock::now();
+            std::cout << "⏩ Simulation speed " << speeds[current] << "x" << std::endl;
         } else if (key == GLFW_KEY_R && app->m_simulationEngine) {
             // Full restart with new terrain and simulation
             std::cout << "🔄 RESTARTING SIMULATION..." << std::endl;
@@ -614,15 +639,39 @@ void Application::KeyCallback(GLFWwindow* window, int key, int scancode, int act
             
             // Regenerate terrain with new random seed
             if (app->m_terrainEngine) {
-                app->m_terrainEngine->GenerateRandomTerrain(128, 128);
+                app->m_terrainEngine->GenerateRandomTerrain(RestartTerrainSize, RestartTerrainSize);
                 std::cout << "✅ New terrain generated" << std::endl;
             }
             
             // Reset and reinitialize simulation
+            uint64_t tick = app->m_simulationEngine->GetTickCount();
             app->m_simulationEngine->Reset();
             app->m_simulationEngine->Initialize();
+            app->m_clock.Reset();
+            if (app->m_recorder) {
+                ReplayTerrain terrain;
+                if (app->m_terrainEngine) {
+                    terrain = {RestartTerrainSize, RestartTerrainSize, app->m_terrainEngine->GetSeed()};
+                }
+                app->m_recorder->RecordRestart(tick, terrain);
+            }
             std::cout << "✅ Simulation reset with new scenario and terrain" << std::endl;
             std::cout << "🎯 Ready for new strategic operations!" << std::endl;
+        } else if (key == GLFW_KEY_F5 && app->m_simulationEngine) {
+            if (app->m_simulationEngine->SaveSnapshot(SnapshotPath, app->m_aiSystem.get())) {
+                std::cout << "💾 Scenario saved to " << SnapshotPath << std::endl;
+            }
+        } else if (key == GLFW_KEY_F9 && app->m_simulationEngine) {
+            // Routes are replanned on the terrain currently loaded
+            uint64_t tick = app->m_simulationEngine->GetTickCount();
+            if (app->m_simulationEngine->LoadSnapshot(SnapshotPath, app->m_aiSystem.get())) {
+                app->m_clock.Reset();
+                if (app->m_recorder) {
+                    app->m_recorder->RecordSnapshot(tick, *app->m_simulationEngine, app->m_aiSystem.get());
+                }
+                std::cout << "📂 Scenario restored from " << SnapshotPath << " at "
+                          << app->m_simulationEngine->GetSimulationTime() << " s" << std::endl;
+            }
         } else if (key == GLFW_KEY_1) {
             std::cout << "🔵 BLUE TEAM INSTRUCTION: Advance and secure area" << std::endl;
             app->CommandBlueForces("ADVANCE");
@@ -649,6 +698,31 @@ void Application::MouseCallback(GLFWwindow* window, double xpos, double ypos) {
     app->ProcessMouse(xpos, ypos);
 }
 
+void Application::MouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+    Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+    
+    // Picking needs the cursor; while captured the mouse steers the camera
+    if (button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS) return;
+    if (glfwGetInputMode(window, GLFW_CURSOR) == GLFW_CURSOR_DISABLED) return;
+    if (!app->m_camera || !app->m_terrainEngine || !app->m_terrainEngine->IsLoaded()) return;
+    
+    double cursorX, cursorY;
+    int width, height;
+    glfwGetCursorPos(window, &cursorX, &cursorY);
+    glfwGetWindowSize(window, &width, &height);
+    if (width <= 0 || height <= 0) return;
+    
+    glm::vec3 origin, direction, ground;
+    app->m_camera->ScreenRay((float)cursorX, (float)cursorY, (float)width, (float)height, origin, direction);
+    // Pick the grid where it is drawn, not the raw elevations beneath it
+    if (app->m_terrainEngine->Raycast(origin, direction, ground, std::numeric_limits<float>::infinity(),
+                                      ContourGridPlacement)) {
+        app->CommandBlueForcesTo(ground);
+    } else {
+        std::cout << "🖱️  No terrain under the cursor" << std::endl;
+    }
+}
+
 void Application::HandleInput() {
     // Handled by callbacks
 }
@@ -657,7 +731,12 @@ void Application::Shutdown() {
     std::cout << "Safe shutdown in progress..." << std::endl;
     
     // Kill any background audio processes
-    system("pkill -f afplay > /dev/null 2>&1");
+    if (m_audio) {
+        m_audio->StopAll();
+    }
+    
+    // Flushes the rest of the session log
+    m_recorder.reset();
     
     if (m_simulationEngine) {
         m_simulationEngine->Reset();
@@ -668,6 +747,7 @@ void Application::Shutdown() {
     m_simulationEngine.reset();
     m_terrainEngine.reset();
     m_camera.reset();
+    m_audio.reset(); // After everything that posts to it
     
     if (m_window) {
         glfwDestroyWindow(m_window);
@@ -678,92 +758,30 @@ void Application::Shutdown() {
     std::cout << "Shutdown complete" << std::endl;
 }
 
+void Application::PlaySound(SoundEvent sound) {
+    if (m_audio) {
+        m_audio->Post(sound);
+    }
+}
+
 void Application::CommandBlueForces(const std::string& command) {
     if (!m_simulationEngine) {
         std::cout << "⚠️  No simulation engine available for blue team instructions" << std::endl;
         return;
     }
 
-    std::cout << "🔵 EXECUTING BLUE TEAM INSTRUCTION: " << command << std::endl;    // Audio feedback for command execution (non-blocking)
-    system("afplay /System/Library/Sounds/Hero.aiff > /dev/null 2>&1 &");
+    std::cout << "🔵 EXECUTING BLUE TEAM INSTRUCTION: " << command << std::endl;    // Audio feedback for command execution
+    PlaySound(SoundEvent::COMMAND_ISSUED);
     
     // Set visual feedback variables
     m_lastCommand = command;
     m_commandFeedbackTimer = 3.0f; // Show feedback for 3 seconds
     m_commandExecutionCount++;
     
-    // Get all units from simulation
-    auto units = m_simulationEngine->GetAllUnits();
-    int blueUnitsAffected = 0;
-    
-    for (auto& unit : units) {
-        // Only command blue/allied units
-        if (unit->IsAllied()) {
-            
-            if (command == "ADVANCE") {
-                // Move toward center/objective with VERY tight boundary constraints
-                glm::vec3 target = glm::vec3(5.0f, 0.0f, 5.0f);  // Closer target
-                glm::vec3 clampedTarget = glm::vec3(
-                    std::clamp(target.x, -25.0f, 25.0f),
-                    target.y,
-                    std::clamp(target.z, -25.0f, 25.0f)
-                );
-                unit->SetTargetPosition(clampedTarget);
-                unit->SetMovementSpeed(2.5f); // Faster movement
-                unit->SetActiveCommand("ADVANCING", 4.0f); // Visual feedback for 4 seconds
-                std::cout << "  ➡️  " << unit->GetTypeString() << " advancing to objective" << std::endl;
-                
-            } else if (command == "DEFEND") {
-                // Hold current position with defensive stance
-                auto currentPos = unit->GetPosition();
-                unit->SetTargetPosition(currentPos); // Stay in place
-                unit->SetMovementSpeed(0.8f); // Slower, cautious movement
-                unit->SetActiveCommand("DEFENDING", 4.0f); // Visual feedback
-                std::cout << "  🛡️  " << unit->GetTypeString() << " taking defensive position" << std::endl;
-                
-            } else if (command == "PATROL") {
-                // Begin patrol pattern with VERY tight boundary constraints
-                auto currentPos = unit->GetPosition();
-                float patrolRadius = 15.0f;  // Much smaller patrol radius
-                glm::vec3 patrolTarget = currentPos + glm::vec3(
-                    sin(glfwGetTime() + unit->GetId()) * patrolRadius,
-                    0.0f,
-                    cos(glfwGetTime() + unit->GetId()) * patrolRadius
-                );
-                glm::vec3 clampedTarget = glm::vec3(
-                    std::clamp(patrolTarget.x, -25.0f, 25.0f),
-                    patrolTarget.y,
-                    std::clamp(patrolTarget.z, -25.0f, 25.0f)
-                );
-                unit->SetTargetPosition(clampedTarget);
-                unit->SetMovementSpeed(1.8f); // Normal patrol speed
-                unit->SetActiveCommand("PATROLLING", 4.0f); // Visual feedback
-                std::cout << "  🔄  " << unit->GetTypeString() << " beginning patrol operations" << std::endl;
-                
-            } else if (command == "WITHDRAW") {
-                // Move to safe rally point with VERY tight boundary constraints
-                glm::vec3 rallyPoint = glm::vec3(-20.0f, 0.0f, -20.0f);  // Closer rally point
-                glm::vec3 clampedTarget = glm::vec3(
-                    std::clamp(rallyPoint.x, -25.0f, 25.0f),
-                    rallyPoint.y,
-                    std::clamp(rallyPoint.z, -25.0f, 25.0f)
-                );
-                unit->SetTargetPosition(clampedTarget);
-                unit->SetMovementSpeed(3.0f); // Fast withdrawal
-                unit->SetActiveCommand("WITHDRAWING", 4.0f); // Visual feedback
-                std::cout << "  ⬅️  " << unit->GetTypeString() << " withdrawing to rally point" << std::endl;
-                
-            } else if (command == "RECON") {
-                // Scout ahead toward opposition positions
-                unit->SetTargetPosition(glm::vec3(50.0f, 0.0f, 30.0f));
-                unit->SetMovementSpeed(1.2f); // Slow, stealthy movement
-                unit->SetActiveCommand("RECON", 4.0f); // Visual feedback
-                std::cout << "  🔍  " << unit->GetTypeString() << " conducting reconnaissance" << std::endl;
-            }
-            
-            blueUnitsAffected++;
-        }
+    if (m_recorder) {
+        m_recorder->RecordCommand(m_simulationEngine->GetTickCount(), command);
     }
+    int blueUnitsAffected = m_simulationEngine->CommandAllied(command);
     
     std::cout << "✅ Instruction executed - " << blueUnitsAffected << " blue team units received orders" << std::endl;
     
@@ -773,4 +791,30 @@ void Application::CommandBlueForces(const std::string& command) {
     }
 }
 
+void Application::CommandBlueForcesTo(const glm::vec3& target) {
+    if (!m_simulationEngine) {
+        std::cout << "⚠️  No simulation engine available for blue team instructions" << std::endl;
+        return;
+    }
+    
+    std::ostringstream point;
+    point << std::fixed << std::setprecision(1) << target.x << ", " << target.z;
+    std::cout << "🔵 EXECUTING BLUE TEAM INSTRUCTION: MOVE to (" << point.str() << ")" << std::endl;
+    PlaySound(SoundEvent::COMMAND_ISSUED);
+    
+    m_lastCommand = "MOVE";
+    m_commandFeedbackTimer = 3.0f;
+    m_commandExecutionCount++;
+    
+    if (m_recorder) {
+        m_recorder->RecordMoveOrder(m_simulationEngine->GetTickCount(), target);
+    }
+    int blueUnitsAffected = m_simulationEngine->CommandAlliedTo(target);
+    
+    std::cout << "✅ Instruction executed - " << blueUnitsAffected << " blue team units received orders" << std::endl;
+    if (m_aiSystem) {
+        m_aiSystem->ReactToPlayerInstruction("MOVE");
+    }
+}
+
 }
@@ -0,0 +1,137 @@
+#include "core/BatchRunner.h"
+#include "terrain/TerrainEngine.h"
+#include "simulation/SimulationEngine.h"
+#include "ai/AISystem.h"
+#include "core/Random.h"
+#include "core/Replay.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+
+namespace TS {
+
+BatchRunner::BatchRunner(const BatchConfig& config) : m_config(config) {
+}
+
+BatchRunner::~BatchRunner() = default;
+
+bool BatchRunner::ShouldStop(std::string& reason) const {
+    const UnitStore& store = m_simulation->GetUnitStore();
+    
+    switch (m_config.stopCondition) {
+        case BatchStopCondition::TEAM_ELIMINATED: {
+            int blue = 0;
+            int red = 0;
+            for (size_t i = 0; i < store.Size(); ++i) {
+                (store.allied[i] ? blue : red)++;
+            }
+            if (blue == 0 || red == 0) {
+                reason = blue == 0 ? "blue team eliminated" : "red team eliminated";
+                return true;
+            }
+            return false;
+        }
+        case BatchStopCondition::ALL_IDLE:
+            for (size_t i = 0; i < store.Size(); ++i) {
+                if (store.state[i] == UnitState::MOVING) return false;
+            }
+            reason = "all units idle";
+            return true;
+        case BatchStopCondition::TICKS_ONLY:
+            break;
+    }
+    return false;
+}
+
+void BatchRunner::CollectSummary(BatchResult& result) const {
+    const UnitStore& store = m_simulation->GetUnitStore();
+    for (size_t i = 0; i < store.Size(); ++i) {
+        if (store.allied[i]) {
+            result.blueUnits++;
+            result.blueHealth += store.health[i];
+        } else {
+            result.redUnits++;
+            result.redHealth += store.health[i];
+        }
+    }
+    result.simulationTime = m_simulation->GetSimulationTime();
+    result.stateHash = m_simulation->ComputeStateHash();
+}
+
+BatchResult BatchRunner::Run() {
+    // Silence per-unit chatter unless asked for it; it dominates the tick cost otherwise
+    std::streambuf* coutBuffer = std::cout.rdbuf();
+    if (!m_config.verbose) {
+        std::cout.rdbuf(nullptr);
+    }
+    
+    // Terrain comes from the run's seed too, so a batch run is reproducible end to end
+    m_terrain = std::make_unique<TerrainEngine>();
+    m_terrain->SetThreadCount(m_config.threads);
+    m_terrain->GenerateRandomTerrain(m_config.terrainSize, m_config.terrainSize, m_config.seed);
+    
+    m_simulation = std::make_unique<SimulationEngine>();
+    m_simulation->SetTerrain(m_terrain.get());
+    m_simulation->SetSeed(m_config.seed);
+    m_simulation->SetThreadCount(m_config.threads);
+    m_simulation->Initialize();
+    
+    // Extra units spread over the patrol area, placed from the run's seed
+    for (int i = 0; i < m_config.extraUnits; ++i) {
+        float x = HashToUnitFloat(CounterHash(m_config.seed, 0xba7c4ull, 2ull * i)) * 60.0f - 30.0f;
+        float z = HashToUnitFloat(CounterHash(m_config.seed, 0xba7c4ull, 2ull * i + 1)) * 60.0f - 30.0f;
+        m_simulation->AddUnit(static_cast<UnitType>(i % 4), glm::vec3(x, 0.0f, z), i % 2 == 0);
+    }
+    
+    m_ai = std::make_unique<AISystem>();
+    m_ai->SetSeed(m_config.seed);
+    m_ai->Initialize();
+    
+    m_simulation->Start();
+    
+    ReplayRecorder recorder;
+    if (!m_config.recordPath.empty()) {
+        ReplayTerrain terrain{m_config.terrainSize, m_config.terrainSize, m_config.seed};
+        recorder.Open(m_config.recordPath, m_config.timestep, terrain, *m_simulation, m_ai.get());
+    }
+    
+    BatchResult result;
+    result.stopReason = "tick limit reached";
+    
+    auto start = std::chrono::steady_clock::now();
+    while (result.ticks < m_config.maxTicks) {
+        m_simulation->Update(m_config.timestep);
+        m_ai->Update(m_config.timestep);
+        recorder.RecordTick(*m_simulation, m_ai.get());
+        result.ticks++;
+        
+        if (ShouldStop(result.stopReason)) {
+            break;
+        }
+    }
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    recorder.Close();
+    
+    std::cout.rdbuf(coutBuffer);
+    CollectSummary(result);
+    return result;
+}
+
+void BatchRunner::PrintSummary(const BatchResult& result) {
+    std::cout << "\n=== Batch Run Summary ===" << std::endl;
+    std::cout << "⏹️  Stopped: " << result.stopReason << std::endl;
+    std::cout << "⏱️  " << result.ticks << " ticks (" << std::fixed << std::setprecision(2)
+              << result.simulationTime << " s simulated) in " << std::setprecision(3)
+              << result.wallSeconds << " s wall" << std::endl;
+    std::cout << "🚀 " << std::setprecision(0) << result.TicksPerSecond() << " ticks/s ("
+              << std::setprecision(1) << result.simulationTime / std::max(result.wallSeconds, 1e-9)
+              << "x real time)" << std::endl;
+    std::cout << "🔵 Blue: " << result.blueUnits << " units, " << std::setprecision(0)
+              << result.blueHealth << " total health" << std::endl;
+    std::cout << "🔴 Red:  " << result.redUnits << " units, " << std::setprecision(0)
+              << result.redHealth << " total health" << std::endl;
+    std::cout << "🔑 State hash: " << std::hex << result.stateHash << std::dec << std::endl;
+}
+
+}
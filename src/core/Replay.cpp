@@ -0,0 +1,320 @@
+#include "core/Replay.h"
+#include "terrain/TerrainEngine.h"
+#include "terrain/HeightmapLoader.h"
+#include "simulation/SimulationEngine.h"
+#include "ai/AISystem.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <cstring>
+
+namespace TS {
+
+namespace {
+
+const char ReplayMagic[4] = {'T', 'S', 'R', 'L'};
+
+}
+
+ReplayRecorder::ReplayRecorder() : m_file(nullptr), m_lastTick(0), m_bytesWritten(0) {
+}
+
+ReplayRecorder::~ReplayRecorder() {
+    Close();
+}
+
+bool ReplayRecorder::Open(const std::string& path, float step, const ReplayTerrain& terrain,
+                          const SimulationEngine& simulation, const AISystem* ai) {
+    Close();
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) {
+        std::cerr << "Cannot create replay log: " << path << std::endl;
+        return false;
+    }
+    m_buffer.Clear();
+    m_buffer.Reserve(FlushBytes * 2);
+    m_bytesWritten = 0;
+    m_lastTick = simulation.GetTickCount();
+    
+    m_buffer.PutRaw(ReplayMagic, sizeof(ReplayMagic));
+    m_buffer.Put<uint32_t>(Version);
+    m_buffer.Put(step);
+    m_buffer.Put<int32_t>(terrain.width);
+    m_buffer.Put<int32_t>(terrain.height);
+    m_buffer.Put(terrain.seed);
+    m_buffer.Put<uint8_t>(ai ? 1 : 0);
+    ByteWriter snapshot;
+    simulation.WriteSnapshot(snapshot, ai);
+    m_buffer.PutVarint(snapshot.Size());
+    m_buffer.PutRaw(snapshot.bytes.data(), snapshot.Size());
+    // The header goes out at once so a log is replayable however early the session dies
+    return Flush();
+}
+
+void ReplayRecorder::Close() {
+    if (!m_file) return;
+    Flush();
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+bool ReplayRecorder::Flush() {
+    if (!m_file) return false;
+    bool written = std::fwrite(m_buffer.bytes.data(), 1, m_buffer.Size(), m_file) == m_buffer.Size();
+    m_bytesWritten += m_buffer.Size();
+    m_buffer.Clear();
+    if (!written) {
+        std::cerr << "Failed to write replay log, recording stopped" << std::endl;
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+    return written;
+}
+
+void ReplayRecorder::FlushIfFull() {
+    if (m_buffer.Size() >= FlushBytes) Flush();
+}
+
+void ReplayRecorder::Begin(ReplayRecord type, uint64_t tick) {
+    m_buffer.Put<uint8_t>((uint8_t)type);
+    // Ticks restart from zero after a reset, so the difference may be negative
+    m_buffer.PutSigned((int64_t)(tick - m_lastTick));
+    m_lastTick = tick;
+}
+
+void ReplayRecorder::RecordTick(const SimulationEngine& simulation, const AISystem* ai) {
+    if (!m_file) return;
+    Begin(ReplayRecord::Tick, simulation.GetTickCount());
+    m_buffer.Put(simulation.ComputeStateHash());
+    m_buffer.Put<uint64_t>(ai ? ai->ComputeStateHash() : 0);
+    FlushIfFull();
+}
+
+void ReplayRecorder::RecordCommand(uint64_t tick, const std::string& command) {
+    if (!m_file) return;
+    Begin(ReplayRecord::Command, tick);
+    m_buffer.PutString(command);
+    FlushIfFull();
+}
+
+void ReplayRecorder::RecordMoveOrder(uint64_t tick, const glm::vec3& target) {
+    if (!m_file) return;
+    Begin(ReplayRecord::MoveOrder, tick);
+    m_buffer.Put(target);
+    FlushIfFull();
+}
+
+void ReplayRecorder::RecordSpeed(uint64_t tick, float speed) {
+    if (!m_file) return;
+    Begin(ReplayRecord::Speed, tick);
+    m_buffer.Put(speed);
+    FlushIfFull();
+}
+
+void ReplayRecorder::RecordRestart(uint64_t tick, const ReplayTerrain& terrain) {
+    if (!m_file) return;
+    Begin(ReplayRecord::Restart, tick);
+    m_buffer.Put<int32_t>(terrain.width);
+    m_buffer.Put<int32_t>(terrain.height);
+    m_buffer.Put(terrain.seed);
+    FlushIfFull();
+}
+
+void ReplayRecorder::RecordSnapshot(uint64_t tick, const SimulationEngine& simulation, const AISystem* ai) {
+    if (!m_file) return;
+    Begin(ReplayRecord::Snapshot, tick);
+    ByteWriter snapshot;
+    simulation.WriteSnapshot(snapshot, ai);
+    m_buffer.PutVarint(snapshot.Size());
+    m_buffer.PutRaw(snapshot.bytes.data(), snapshot.Size());
+    FlushIfFull();
+}
+
+ReplayRunner::ReplayRunner(int threads, bool verbose) : m_threads(std::max(threads, 1)), m_verbose(verbose) {
+}
+
+ReplayRunner::~ReplayRunner() = default;
+
+ReplayResult ReplayRunner::Run(const std::string& path) {
+    ReplayResult result;
+    MappedFile file;
+    if (!file.Open(path)) {
+        std::cerr << "Cannot map replay log: " << path << std::endl;
+        return result;
+    }
+    file.AdviseSequential(0, file.GetSize());
+    ByteReader in(file.GetData(), file.GetSize());
+    
+    char magic[sizeof(ReplayMagic)];
+    in.GetRaw(magic, sizeof(magic));
+    uint32_t version = in.Get<uint32_t>();
+    if (!in.Ok() || std::memcmp(magic, ReplayMagic, sizeof(magic)) != 0) {
+        std::cerr << "Not a replay log: " << path << std::endl;
+        return result;
+    }
+    if (version != ReplayRecorder::Version) {
+        std::cerr << "Unsupported replay log version " << version << ": " << path << std::endl;
+        return result;
+    }
+    float step = in.Get<float>();
+    ReplayTerrain terrain;
+    terrain.width = in.Get<int32_t>();
+    terrain.height = in.Get<int32_t>();
+    terrain.seed = in.Get<uint64_t>();
+    bool hasAI = in.Get<uint8_t>() != 0;
+    uint64_t snapshotSize = in.GetVarint();
+    const uint8_t* snapshot = in.GetBlock((size_t)snapshotSize);
+    if (!snapshot) {
+        std::cerr << "Replay log header is truncated: " << path << std::endl;
+        return result;
+    }
+    
+    // Per-unit and AI chatter would dominate the replay otherwise
+    std::streambuf* coutBuffer = std::cout.rdbuf();
+    if (!m_verbose) {
+        std::cout.rdbuf(nullptr);
+    }
+    
+    m_terrain = std::make_unique<TerrainEngine>();
+    m_terrain->SetThreadCount(m_threads);
+    if (terrain.width > 0 && terrain.height > 0) {
+        m_terrain->GenerateRandomTerrain(terrain.width, terrain.height, terrain.seed);
+    }
+    m_simulation = std::make_unique<SimulationEngine>();
+    m_simulation->SetTerrain(m_terrain.get());
+    m_simulation->SetThreadCount(m_threads);
+    m_ai = std::make_unique<AISystem>();
+    m_ai->Initialize();
+    AISystem* ai = hasAI ? m_ai.get() : nullptr;
+    
+    auto readSnapshot = [&](const uint8_t* data, size_t size) {
+        return m_simulation->ReadSnapshot(data, size, ai);
+    };
+    result.loaded = readSnapshot(snapshot, (size_t)snapshotSize);
+    
+    uint64_t tick = m_simulation->GetTickCount();
+    std::ostringstream divergence;
+    auto start = std::chrono::steady_clock::now();
+    while (result.loaded && !result.diverged && in.Remaining() > 0) {
+        uint8_t type = in.Get<uint8_t>();
+        tick += (uint64_t)in.GetSigned();
+        if (!in.Ok()) break;
+        
+        // Operator records are stamped with the tick count they followed
+        if ((ReplayRecord)type != ReplayRecord::Tick && tick != m_simulation->GetTickCount()) {
+            divergence << "record " << (int)type << " stamped tick " << tick << " arrived at tick "
+                       << m_simulation->GetTickCount();
+            result.diverged = true;
+            break;
+        }
+        
+        switch ((ReplayRecord)type) {
+            case ReplayRecord::Tick: {
+                uint64_t simulationHash = in.Get<uint64_t>();
+                uint64_t aiHash = in.Get<uint64_t>();
+                if (!in.Ok()) break;
+                // The recording only ran steps while the simulation was running
+                m_simulation->Start();
+                m_simulation->Update(step);
+                if (ai) ai->Update(step);
+                result.ticks++;
+                uint64_t replayedSimulation = m_simulation->ComputeStateHash();
+                uint64_t replayedAI = ai ? ai->ComputeStateHash() : 0;
+                if (m_simulation->GetTickCount() != tick || replayedSimulation != simulationHash ||
+                    replayedAI != aiHash) {
+                    divergence << "tick " << tick << ": " << std::hex;
+                    if (replayedSimulation != simulationHash) {
+                        divergence << "simulation hash " << replayedSimulation << ", recorded " << simulationHash;
+                    } else if (replayedAI != aiHash) {
+                        divergence << "AI hash " << replayedAI << ", recorded " << aiHash;
+                    } else {
+                        divergence << std::dec << "replay reached tick " << m_simulation->GetTickCount();
+                    }
+                    result.diverged = true;
+                }
+                break;
+            }
+            case ReplayRecord::Command: {
+                std::string command = in.GetString();
+                if (!in.Ok()) break;
+                m_simulation->CommandAllied(command);
+                if (ai) ai->ReactToPlayerInstruction(command);
+                result.actions++;
+                break;
+            }
+            case ReplayRecord::MoveOrder: {
+                glm::vec3 target = in.Get<glm::vec3>();
+                if (!in.Ok()) break;
+                m_simulation->CommandAlliedTo(target);
+                if (ai) ai->ReactToPlayerInstruction("MOVE");
+                result.actions++;
+                break;
+            }
+            case ReplayRecord::Speed:
+                in.Get<float>();
+                result.actions++;
+                break;
+            case ReplayRecord::Restart: {
+                ReplayTerrain next;
+                next.width = in.Get<int32_t>();
+                next.height = in.Get<int32_t>();
+                next.seed = in.Get<uint64_t>();
+                if (!in.Ok()) break;
+                if (next.width > 0 && next.height > 0) {
+                    m_terrain->GenerateRandomTerrain(next.width, next.height, next.seed);
+                }
+                m_simulation->Reset();
+                m_simulation->Initialize();
+                result.actions++;
+                break;
+            }
+            case ReplayRecord::Snapshot: {
+                uint64_t size = in.GetVarint();
+                const uint8_t* bytes = in.GetBlock((size_t)size);
+                if (!bytes) break;
+                if (!readSnapshot(bytes, (size_t)size)) {
+                    divergence << "snapshot at tick " << tick << " did not load";
+                    result.diverged = true;
+                }
+                result.actions++;
+                break;
+            }
+            default:
+                divergence << "unknown record type " << (int)type << " after tick " << tick;
+                result.diverged = true;
+                break;
+        }
+    }
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // A session that ended without closing its log loses at most its last record
+    result.truncated = !in.Ok();
+    result.divergence = divergence.str();
+    
+    std::cout.rdbuf(coutBuffer);
+    if (!result.loaded) {
+        std::cerr << "Replay log's starting snapshot did not load: " << path << std::endl;
+    }
+    result.simulationTime = m_simulation->GetSimulationTime();
+    result.stateHash = m_simulation->ComputeStateHash();
+    return result;
+}
+
+void ReplayRunner::PrintSummary(const ReplayResult& result) {
+    std::cout << "\n=== Replay Summary ===" << std::endl;
+    std::cout << "⏱️  " << result.ticks << " ticks (" << std::fixed << std::setprecision(2)
+              << result.simulationTime << " s simulated) and " << result.actions << " operator actions in "
+              << std::setprecision(3) << result.wallSeconds << " s wall, " << std::setprecision(0)
+              << result.TicksPerSecond() << " ticks/s" << std::endl;
+    if (result.truncated) {
+        std::cout << "✂️  Log ends partway through a record; replayed up to there" << std::endl;
+    }
+    if (result.diverged) {
+        std::cout << "❌ Diverged from the recording at " << result.divergence << std::endl;
+    } else if (result.loaded) {
+        std::cout << "✅ Every tick matched the recording" << std::endl;
+    }
+    std::cout << "🔑 State hash: " << std::hex << result.stateHash << std::dec << std::endl;
+}
+
+}
@@ -0,0 +1,60 @@
+#include "core/SimulationClock.h"
+#include <algorithm>
+#include <cmath>
+
+namespace TS {
+
+SimulationClock::SimulationClock(float step, int maxSubsteps)
+    : m_accumulator(0.0), m_step(std::max(step, 1e-6f)), m_speed(1.0f),
+      m_maxSubsteps(std::max(maxSubsteps, 1)), m_stepsDue(0) {}
+
+void SimulationClock::SetSpeed(float speed) {
+    m_speed = std::max(speed, 0.0f);
+}
+
+void SimulationClock::SetMaxSubsteps(int steps) {
+    m_maxSubsteps = std::max(steps, 1);
+}
+
+void SimulationClock::BeginFrame(float frameSeconds) {
+    m_stats.substeps = 0;
+    m_stats.droppedTime = 0.0f;
+    m_stats.frames++;
+    
+    m_accumulator += std::max(frameSeconds, 0.0f) * (double)m_speed;
+    double due = std::floor(m_accumulator / m_step);
+    m_stepsDue = (int)std::min(due, (double)m_maxSubsteps);
+    // Whole steps over the limit are lost; the fraction of a step stays for interpolation
+    if (due > m_maxSubsteps) {
+        double dropped = (due - m_maxSubsteps) * m_step;
+        m_accumulator -= dropped;
+        m_stats.droppedTime = (float)dropped;
+        m_stats.totalDroppedTime += dropped;
+    }
+}
+
+bool SimulationClock::NextStep() {
+    if (m_stepsDue == 0) return false;
+    m_stepsDue--;
+    m_accumulator = std::max(m_accumulator - m_step, 0.0);
+    m_stats.substeps++;
+    m_stats.totalSteps++;
+    m_stats.peakSubsteps = std::max(m_stats.peakSubsteps, m_stats.substeps);
+    return true;
+}
+
+void SimulationClock::DropBacklog() {
+    double dropped = (double)m_stepsDue * m_step;
+    m_accumulator = std::max(m_accumulator - dropped, 0.0);
+    m_stats.droppedTime += (float)dropped;
+    m_stats.totalDroppedTime += dropped;
+    m_stepsDue = 0;
+}
+
+void SimulationClock::Reset() {
+    m_accumulator = 0.0;
+    m_stepsDue = 0;
+    m_stats = ClockStats();
+}
+
+}
@@ -0,0 +1,84 @@
+#include "core/WorkerPool.h"
+#include <algorithm>
+
+namespace TS {
+
+WorkerPool::WorkerPool(int threadCount)
+    : m_job(nullptr), m_jobCount(0), m_generation(0), m_pending(0), m_stopping(false) {
+    int workers = std::max(threadCount, 1) - 1;
+    m_workers.reserve(workers);
+    for (int i = 0; i < workers; ++i) {
+        m_workers.emplace_back(&WorkerPool::WorkerLoop, this, i + 1);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::RunChunk(int chunk, size_t count, const std::function<void(size_t, size_t)>& fn) const {
+    size_t chunks = (size_t)GetThreadCount();
+    size_t begin = count * chunk / chunks;
+    size_t end = count * (chunk + 1) / chunks;
+    if (begin < end) {
+        fn(begin, end);
+    }
+}
+
+void WorkerPool::ParallelFor(size_t count, const std::function<void(size_t begin, size_t end)>& fn) {
+    if (count == 0) return;
+    if (m_workers.empty()) {
+        fn(0, count);
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &fn;
+        m_jobCount = count;
+        m_pending = (int)m_workers.size();
+        m_generation++;
+    }
+    m_wake.notify_all();
+    
+    RunChunk(0, count, fn);
+    
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_pending == 0; });
+    m_job = nullptr;
+}
+
+void WorkerPool::WorkerLoop(int workerIndex) {
+    uint64_t seenGeneration = 0;
+    
+    while (true) {
+        const std::function<void(size_t, size_t)>* job;
+        size_t count;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stopping || m_generation != seenGeneration; });
+            if (m_stopping) return;
+            seenGeneration = m_generation;
+            job = m_job;
+            count = m_jobCount;
+        }
+        
+        RunChunk(workerIndex, count, *job);
+        
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pending == 0) {
+                m_done.notify_one();
+            }
+        }
+    }
+}
+
+}
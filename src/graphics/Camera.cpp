@@ -10,7 +10,7 @@ Camera::Camera(glm::vec3 position)
     UpdateCameraVectors();
 }
 
-glm::mat4 Camera::GetViewMatrix() {
+glm::mat4 Camera::GetViewMatrix() const {
     return glm::lookAt(m_position, m_position + m_front, m_up);
 }
 
@@ -18,6 +18,24 @@ glm::mat4 Camera::GetProjectionMatrix(float aspect) const {
     return glm::perspective(glm::radians(m_zoom), aspect, 0.1f, 10000.0f);
 }
 
+void Camera::ScreenRay(float screenX, float screenY, float viewportWidth, float viewportHeight,
+                       glm::vec3& origin, glm::vec3& direction) const {
+    const glm::mat4 projection = GetProjectionMatrix(viewportWidth / viewportHeight);
+    const glm::mat4 view = GetViewMatrix();
+    
+    // Pixel -> normalized device coordinates -> eye space on the plane z = -1. The perspective
+    // matrix only scales x and y there, and the view rotation inverts by transposing.
+    const float ndcX = 2.0f * screenX / viewportWidth - 1.0f;
+    const float ndcY = 1.0f - 2.0f * screenY / viewportHeight;
+    const glm::vec3 eye(ndcX / projection[0][0], ndcY / projection[1][1], -1.0f);
+    
+    const glm::vec3 right(view[0][0], view[1][0], view[2][0]);
+    const glm::vec3 up(view[0][1], view[1][1], view[2][1]);
+    const glm::vec3 back(view[0][2], view[1][2], view[2][2]);
+    origin = m_position;
+    direction = glm::normalize(right * eye.x + up * eye.y + back * eye.z);
+}
+
 void Camera::ProcessKeyboard(CameraMovement direction, float deltaTime) {
     float velocity = m_movementSpeed * deltaTime;
     
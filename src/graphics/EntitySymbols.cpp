@@ -4,8 +4,8 @@
 
 namespace TS {
 
-void EntitySymbols::RenderUnitSymbol(const Unit& unit) {
-    glm::vec3 position = unit.GetPosition();
+void EntitySymbols::RenderUnitSymbol(const Unit& unit, float alpha) {
+    glm::vec3 position = unit.GetRenderPosition(alpha);
     position.y += 120.0f; // Hover well above ground for visibility with extreme terrain
     
     glm::vec3 color = unit.GetRenderColor();
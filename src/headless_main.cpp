@@ -0,0 +1,82 @@
+#include "core/BatchRunner.h"
+#include "core/Replay.h"
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--ticks N] [--dt SECONDS] [--sim-threads N] [--seed N]"
+              << " [--units N] [--terrain N] [--until ticks|eliminated|idle] [--record FILE] [--verbose]" << std::endl;
+    std::cerr << "       " << program << " --replay FILE [--sim-threads N] [--verbose]" << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+    TS::BatchConfig config;
+    std::string replayPath;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--ticks" && hasValue) {
+            config.maxTicks = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--dt" && hasValue) {
+            config.timestep = std::max(1e-4f, (float)std::atof(argv[++i]));
+        } else if (arg == "--sim-threads" && hasValue) {
+            config.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--units" && hasValue) {
+            config.extraUnits = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--terrain" && hasValue) {
+            config.terrainSize = std::max(2, std::atoi(argv[++i]));
+        } else if (arg == "--until" && hasValue) {
+            std::string condition = argv[++i];
+            if (condition == "ticks") {
+                config.stopCondition = TS::BatchStopCondition::TICKS_ONLY;
+            } else if (condition == "eliminated") {
+                config.stopCondition = TS::BatchStopCondition::TEAM_ELIMINATED;
+            } else if (condition == "idle") {
+                config.stopCondition = TS::BatchStopCondition::ALL_IDLE;
+            } else {
+                std::cerr << "Unknown stop condition: " << condition << std::endl;
+                PrintUsage(argv[0]);
+                return -1;
+            }
+        } else if (arg == "--record" && hasValue) {
+            config.recordPath = argv[++i];
+        } else if (arg == "--replay" && hasValue) {
+            replayPath = argv[++i];
+        } else if (arg == "--verbose") {
+            config.verbose = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            PrintUsage(argv[0]);
+            return -1;
+        }
+    }
+    
+    if (!replayPath.empty()) {
+        std::cout << "=== Terrain Simulator (replay) ===" << std::endl;
+        std::cout << "Replaying " << replayPath << " on " << config.threads << " thread(s)" << std::endl;
+        
+        TS::ReplayRunner replay(config.threads, config.verbose);
+        TS::ReplayResult result = replay.Run(replayPath);
+        TS::ReplayRunner::PrintSummary(result);
+        return result.loaded && !result.diverged ? 0 : 1;
+    }
+    
+    std::cout << "=== Terrain Simulator (headless batch) ===" << std::endl;
+    std::cout << "Running up to " << config.maxTicks << " ticks at dt " << config.timestep
+              << " on " << config.threads << " thread(s), seed " << config.seed << std::endl;
+    
+    TS::BatchRunner runner(config);
+    TS::BatchResult result = runner.Run();
+    TS::BatchRunner::PrintSummary(result);
+    
+    return 0;
+}
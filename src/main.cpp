@@ -1,10 +1,34 @@
 #include "core/Application.h"
 #include <iostream>
 #include <exception>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
 
-int main() {
+int main(int argc, char** argv) {
+    int simThreads = 1;
+    std::string recordPath;
+    uint64_t seed = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--sim-threads" && i + 1 < argc) {
+            simThreads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [--sim-threads N] [--seed N] [--record FILE]" << std::endl;
+            return -1;
+        }
+    }
+    
     try {
         TS::Application app;
+        app.SetSimulationThreads(simThreads);
+        app.SetSeed(seed);
+        app.SetRecordPath(recordPath);
         
         std::cout << "=== Terrain Simulator ===" << std::endl;
         std::cout << "Initializing application..." << std::endl;
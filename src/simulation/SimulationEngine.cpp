@@ -1,18 +1,35 @@
 #include "simulation/SimulationEngine.h"
+#include "ai/AISystem.h"
+#include "core/ByteStream.h"
+#include "terrain/HeightmapLoader.h"
 #include <iostream>
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
 
 namespace TS {
 
 SimulationEngine::SimulationEngine() 
-    : m_state(SimulationState::STOPPED), m_simulationTime(0.0f), m_nextUnitId(1) {
+    : m_state(SimulationState::STOPPED), m_simulationTime(0.0f), m_activityTimer(0.0f), m_nextUnitId(1),
+      m_contactGrid(Unit::ContactRange), m_workers(std::make_unique<WorkerPool>(1)),
+      m_terrain(nullptr), m_paths(std::make_unique<PathService>(1)),
+      m_pathFinderRevision(0), m_pathFinderTicket(0), m_pathFinderDueTick(0),
+      m_flowFieldGroupSize(DefaultFlowFieldGroupSize), m_tickCount(0) {
 }
 
 SimulationEngine::~SimulationEngine() {
-    // Safe cleanup - clear vector will properly destroy unique_ptrs
     Reset();
 }
 
+void SimulationEngine::SetThreadCount(int threads) {
+    threads = std::max(threads, 1);
+    if (threads != m_workers->GetThreadCount()) {
+        m_workers = std::make_unique<WorkerPool>(threads);
+        std::cout << "🧵 Simulation running on " << threads << " thread(s)" << std::endl;
+    }
+}
+
 void SimulationEngine::Initialize() {
     std::cout << "🎮 Initializing Dynamic Simulation Engine..." << std::endl;
     Reset();
@@ -46,63 +63,283 @@ void SimulationEngine::Update(float deltaTime) {
     }
     
     m_simulationTime += deltaTime;
+    std::copy(m_store.position.begin(), m_store.position.end(), m_store.previousPosition.begin());
     
     // Track unit activity for feedback
-    static float activityTimer = 0.0f;
-    activityTimer += deltaTime;
+    m_activityTimer += deltaTime;
     
     int unitsMoving = 0;
     int unitsInContact = 0;
     
-    // Update all units and check for engagements
-    for (auto& unit : m_units) {
-        if (unit) { // Safety check
-            unit->Update(deltaTime);
-            
-            // Check for engagements with other units
-            unit->CheckContact(m_units, deltaTime);
-            
-            // Check if unit is moving
-            auto pos = unit->GetPosition();
-            auto target = unit->GetTargetPosition();
-            if (glm::distance(pos, target) > 1.0f) {
-                unitsMoving++;
-            }
-            
-            // Check if unit has an active command
-            if (!unit->GetActiveCommand().empty()) {
-                unitsInContact++;
+    const size_t count = m_units.size();
+    
+    // Decisions are independent per unit but emit console/audio feedback, so they stay in slot order
+    for (uint32_t i = 0; i < count; ++i) {
+        Unit(&m_store, i).Think(deltaTime);
+    }
+    
+    // Destinations chosen by Think are routed in the background; routes asked for a few ticks
+    // ago are handed to their units now
+    UpdatePaths();
+    
+    // Cost rasters are rebuilt here, before the workers read them, if the terrain changed
+    const TerrainRasters* rasters = m_terrain && m_terrain->IsLoaded() ? &m_terrain->GetRasters() : nullptr;
+    m_store.terrain = rasters && !rasters->IsEmpty() ? rasters : nullptr;
+    
+    // Movement only touches each unit's own slot
+    m_workers->ParallelFor(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Unit(&m_store, (uint32_t)i).Integrate(deltaTime);
+        }
+    });
+    
+    m_contactGrid.Build(m_store);
+    
+    // Contacts in two phases: gather partners against the post-move snapshot,
+    // then apply damage in slot order, so no thread observes another's writes
+    m_contactPartners.assign(count, -1);
+    m_workers->ParallelFor(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Unit unit(&m_store, (uint32_t)i);
+            if (unit.IsActive()) {
+                m_contactPartners[i] = unit.FindContact(m_contactGrid);
             }
         }
+    });
+    for (size_t i = 0; i < count; ++i) {
+        if (m_contactPartners[i] >= 0) {
+            Unit(&m_store, (uint32_t)i).ApplyContact(deltaTime);
+        }
+    }
+    
+    for (size_t i = 0; i < m_store.Size(); ++i) {
+        // Check if unit is moving
+        if (glm::distance(m_store.position[i], m_store.targetPosition[i]) > 1.0f) {
+            unitsMoving++;
+        }
+        
+        // Check if unit has an active command
+        if (!m_store.commands[i].lastCommand.empty()) {
+            unitsInContact++;
+        }
     }
     
     // Report significant activity every 8 seconds
-    if (activityTimer >= 8.0f) {
+    if (m_activityTimer >= 8.0f) {
         if (unitsMoving > 0 || unitsInContact > 0) {
             std::cout << "⚡ FIELD ACTIVITY: " << unitsMoving << " units maneuvering, " 
                       << unitsInContact << " executing instructions" << std::endl;
             if (unitsMoving >= 3) {
                 std::cout << "🚁 Heavy movement detected across multiple sectors" << std::endl;
-                system("afplay /System/Library/Sounds/Blow.aiff > /dev/null 2>&1 &");
+                if (m_store.audio) {
+                    m_store.audio->Post(SoundEvent::HEAVY_MOVEMENT);
+                }
+            }
+        }
+        m_activityTimer = 0.0f;
+    }
+    
+    // Remove inactive units, keeping survivors in order; their handles follow them to their new slots
+    size_t kept = 0;
+    for (size_t i = 0; i < m_store.Size(); ++i) {
+        if (m_store.health[i] <= 0.0f) {
+            m_sensorViewsheds.erase(m_store.id[i]);
+            continue;
+        }
+        m_units[i]->m_index = (uint32_t)kept;
+        if (kept != i) m_units[kept] = std::move(m_units[i]);
+        kept++;
+    }
+    m_units.resize(kept);
+    m_store.RemoveInactive();
+    
+    UpdateSensorViewsheds();
+}
+
+void SimulationEngine::UpdatePaths() {
+    m_tickCount++;
+    
+    while (!m_pendingPaths.empty() && m_pendingPaths.front().dueTick <= m_tickCount) {
+        PendingPath pending = m_pendingPaths.front();
+        m_pendingPaths.pop_front();
+        PathResult result = m_paths->Take(pending.ticket);
+        int index = m_store.IndexOf(pending.unitId);
+        if (index < 0) continue;
+        UnitPath& path = m_store.paths[index];
+        if (path.goal != pending.goal) continue;  // Superseded by a newer destination
+        // Unreachable goals keep the straight line
+        path.waypoints = std::move(result.waypoints);
+        path.next = 0;
+    }
+    
+    while (!m_pendingFlows.empty() && m_pendingFlows.front().dueTick <= m_tickCount) {
+        PendingFlow pending = std::move(m_pendingFlows.front());
+        m_pendingFlows.pop_front();
+        if (!pending.field) {
+            pending.field = m_paths->Take(pending.ticket).flowField;
+            m_flowFields.Insert(pending.field);
+        }
+        if (!pending.field) continue;  // Impassable goal: everyone keeps the straight line
+        for (const auto& [unitId, goal] : pending.units) {
+            int index = m_store.IndexOf(unitId);
+            if (index < 0 || m_store.paths[index].goal != goal) continue;
+            m_store.paths[index].flow = pending.field;
+        }
+    }
+    
+    if (!m_terrain || !m_terrain->IsLoaded() || !UpdatePathFinder()) return;
+    std::shared_ptr<const PathFinder> finder = m_pathFinder;
+    
+    m_pathRequests.clear();
+    for (uint32_t i = 0; i < m_store.Size(); ++i) {
+        if (m_store.state[i] != UnitState::MOVING) continue;
+        UnitPath& path = m_store.paths[i];
+        const glm::vec3& destination = m_store.destination[i];
+        if (path.requested && path.goal == destination) continue;
+        
+        // Straight at the new destination until its route arrives
+        path.waypoints.clear();
+        path.next = 0;
+        path.flow.reset();
+        path.goal = destination;
+        path.requested = true;
+        m_pathRequests.push_back(i);
+    }
+    if (m_pathRequests.empty()) return;
+    
+    // One flow field per destination cell shared by a large enough group, or already cached or
+    // on its way; a route per unit otherwise. Groups are visited in key order.
+    const uint64_t revision = finder->GetRevision();
+    std::map<std::pair<Mobility, int>, std::vector<uint32_t>> groups;
+    for (uint32_t i : m_pathRequests) {
+        groups[{GetMobility(m_store.type[i]), finder->NearestVertex(m_store.destination[i])}].push_back(i);
+    }
+    for (const auto& [key, slots] : groups) {
+        const auto [mobility, goalVertex] = key;
+        PendingFlow* shared = nullptr;
+        for (PendingFlow& pending : m_pendingFlows) {
+            if (pending.mobility == mobility && pending.goalVertex == goalVertex && pending.terrainRevision == revision) {
+                shared = &pending;
+            }
+        }
+        std::shared_ptr<const FlowField> cached = shared ? nullptr : m_flowFields.Find(mobility, goalVertex, revision);
+        const bool largeGroup = m_flowFieldGroupSize > 0 && (int)slots.size() >= m_flowFieldGroupSize;
+        
+        if (!shared && !cached && !largeGroup) {
+            for (uint32_t i : slots) {
+                const glm::vec3& destination = m_store.destination[i];
+                uint64_t ticket = m_paths->Submit(finder, mobility, m_store.position[i], destination);
+                m_pendingPaths.push_back({ticket, m_store.id[i], m_store.position[i], destination,
+                                          m_tickCount + PathLatencyTicks});
             }
+            continue;
+        }
+        if (!shared) {
+            uint64_t ticket = cached ? 0 : m_paths->SubmitFlowField(finder, mobility, m_store.destination[slots[0]]);
+            m_pendingFlows.push_back({ticket, mobility, goalVertex, revision, cached, {}, m_tickCount + PathLatencyTicks});
+            shared = &m_pendingFlows.back();
         }
-        activityTimer = 0.0f;
+        for (uint32_t i : slots) {
+            shared->units.push_back({m_store.id[i], m_store.destination[i]});
+        }
+    }
+}
+
+uint64_t SimulationEngine::PathFinderLatency() const {
+    const TerrainRasters& rasters = m_terrain->GetRasters();
+    return PathLatencyTicks + (uint64_t)rasters.GetWidth() * rasters.GetHeight() / PathFinderCellsPerTick;
+}
+
+void SimulationEngine::RequestPathFinder(uint64_t dueTick) {
+    if (m_pathFinderTicket) m_paths->Discard(m_pathFinderTicket);
+    m_pathFinder.reset();
+    m_pathFinderTicket = 0;
+    m_pathFinderRevision = m_terrain->GetRevision();
+    m_pathFinderDueTick = dueTick;
+    std::shared_ptr<const TerrainRasters> rasters = m_terrain->GetSharedRasters();
+    if (!rasters->IsEmpty()) m_pathFinderTicket = m_paths->SubmitPathFinder(std::move(rasters));
+}
+
+bool SimulationEngine::UpdatePathFinder() {
+    // Asked for on the first tick that sees new heights, never built on this thread
+    if (m_pathFinderRevision != m_terrain->GetRevision()) {
+        RequestPathFinder(m_tickCount + PathFinderLatency());
+    }
+    if (m_pathFinderTicket && m_tickCount >= m_pathFinderDueTick) {
+        m_pathFinder = m_paths->Take(m_pathFinderTicket).finder;
+        m_pathFinderTicket = 0;
+        m_terrain->AdoptPathFinder(m_pathFinder);
+    }
+    return m_pathFinder != nullptr;
+}
+
+void SimulationEngine::DrainPaths() {
+    for (const PendingPath& pending : m_pendingPaths) {
+        m_paths->Take(pending.ticket);
+    }
+    for (const PendingFlow& pending : m_pendingFlows) {
+        if (pending.ticket) m_paths->Take(pending.ticket);
+    }
+    m_pendingPaths.clear();
+    m_pendingFlows.clear();
+    // A field cached by an earlier run would change which orders share one
+    m_flowFields.Clear();
+}
+
+void SimulationEngine::RebuildUnitHandles() {
+    m_units.clear();
+    m_units.reserve(m_store.Size());
+    for (uint32_t i = 0; i < m_store.Size(); ++i) {
+        m_units.push_back(std::make_unique<Unit>(&m_store, i));
     }
+}
+
+void SimulationEngine::UpdateSensorViewsheds() {
+    if (!m_terrain || !m_terrain->IsLoaded()) return;
     
-    // Remove inactive units safely
-    m_units.erase(
-        std::remove_if(m_units.begin(), m_units.end(),
-            [](const std::unique_ptr<Unit>& unit) {
-                return !unit || !unit->IsActive();
-            }),
-        m_units.end()
-    );
+    const int sensorRange = 64;       // Grid cells
+    const float mastHeight = 10.0f;   // Sensor height above local ground
+    
+    // Ground under every sensor in one batched lookup
+    m_sensorSlots.clear();
+    m_sensorX.clear();
+    m_sensorZ.clear();
+    for (size_t i = 0; i < m_store.Size(); ++i) {
+        if (m_store.type[i] != UnitType::SENSOR) continue;
+        m_sensorSlots.push_back((uint32_t)i);
+        m_sensorX.push_back(m_store.position[i].x);
+        m_sensorZ.push_back(m_store.position[i].z);
+    }
+    m_sensorGround.resize(m_sensorSlots.size());
+    m_terrain->GetElevationBatch(m_sensorX.data(), m_sensorZ.data(), m_sensorGround.data(), m_sensorSlots.size());
+    
+    // Map entries are made here, in slot order; each sweep then writes only its own viewshed
+    m_sensorViews.resize(m_sensorSlots.size());
+    for (size_t k = 0; k < m_sensorSlots.size(); ++k) {
+        m_sensorViews[k] = &m_sensorViewsheds[m_store.id[m_sensorSlots[k]]];
+    }
+    m_workers->ParallelFor(m_sensorSlots.size(), [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            glm::vec3 eye(m_sensorX[k], m_sensorGround[k] + mastHeight, m_sensorZ[k]);
+            
+            // Only recomputed once the sensor has moved more than one cell
+            m_terrain->UpdateViewshed(eye, sensorRange, *m_sensorViews[k]);
+        }
+    });
 }
 
 void SimulationEngine::Reset() {
-    // Safe cleanup - let unique_ptr destructors handle memory
+    DrainPaths();
+    // A graph still being built keeps its remaining wait; ticks count from zero again
+    if (m_pathFinderTicket) m_pathFinderDueTick -= std::min(m_pathFinderDueTick, m_tickCount);
+    m_tickCount = 0;
     m_units.clear();
+    m_store.Clear();
+    m_contactGrid.Clear();
+    m_contactPartners.clear();
+    m_sensorViewsheds.clear();
     m_simulationTime = 0.0f;
+    m_activityTimer = 0.0f;
     m_nextUnitId = 1;
     m_state = SimulationState::STOPPED;
 }
@@ -110,9 +347,8 @@ void SimulationEngine::Reset() {
 int SimulationEngine::AddUnit(UnitType type, const glm::vec3& position, bool isAllied) {
     int unitId = m_nextUnitId++;
     
-    // Create unit safely
-    auto unit = std::make_unique<Unit>(unitId, type, position, isAllied);
-    m_units.push_back(std::move(unit));
+    uint32_t index = m_store.Add(unitId, type, position, isAllied);
+    m_units.push_back(std::make_unique<Unit>(&m_store, index));
     
     std::cout << "Added " << (isAllied ? "allied" : "opposition") << " unit " << unitId 
               << " at (" << position.x << ", " << position.y << ", " << position.z << ")" << std::endl;
@@ -121,12 +357,447 @@ int SimulationEngine::AddUnit(UnitType type, const glm::vec3& position, bool isA
 }
 
 Unit* SimulationEngine::GetUnit(int unitId) {
-    for (auto& unit : m_units) {
-        if (unit && unit->GetId() == unitId) {
-            return unit.get();
+    int index = m_store.IndexOf(unitId);
+    return index >= 0 ? m_units[index].get() : nullptr;
+}
+
+uint64_t SimulationEngine::ComputeStateHash() const {
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    
+    mix(&m_simulationTime, sizeof(m_simulationTime));
+    size_t count = m_store.Size();
+    mix(&count, sizeof(count));
+    mix(m_store.id.data(), count * sizeof(int));
+    mix(m_store.state.data(), count * sizeof(UnitState));
+    mix(m_store.position.data(), count * sizeof(glm::vec3));
+    mix(m_store.destination.data(), count * sizeof(glm::vec3));
+    mix(m_store.targetPosition.data(), count * sizeof(glm::vec3));
+    mix(m_store.health.data(), count * sizeof(float));
+    mix(m_store.movementSpeed.data(), count * sizeof(float));
+    mix(m_store.commandFeedbackTimer.data(), count * sizeof(float));
+    mix(m_store.behaviorTimer.data(), count * sizeof(float));
+    mix(m_store.soundTimer.data(), count * sizeof(float));
+    mix(m_store.interactionTimer.data(), count * sizeof(float));
+    mix(m_store.rngCounter.data(), count * sizeof(uint64_t));
+    return hash;
+}
+
+namespace {
+
+const char SnapshotMagic[4] = {'T', 'S', 'S', 'N'};
+const size_t SnapshotHeaderSize = sizeof(SnapshotMagic) + sizeof(uint32_t) + sizeof(uint64_t);
+
+// What a flow field was built for; enough to build it again
+struct FlowFieldGoal {
+    Mobility mobility;
+    glm::vec3 goal;
+};
+
+}
+
+void SimulationEngine::WriteSnapshot(ByteWriter& out, const AISystem* ai) const {
+    const size_t start = out.Size();
+    out.Reserve(start + SnapshotHeaderSize + m_store.Size() * 80);  // Units without routes take ~66 bytes
+    out.PutRaw(SnapshotMagic, sizeof(SnapshotMagic));
+    out.Put<uint32_t>(SnapshotVersion);
+    out.Put<uint64_t>(0);  // Payload size, filled in at the end
+    
+    out.Put<uint8_t>((uint8_t)m_state);
+    out.Put(m_simulationTime);
+    out.Put(m_activityTimer);
+    out.PutVarint((uint64_t)m_nextUnitId);
+    out.PutVarint(m_tickCount);
+    out.Put(m_store.rngSeed);
+    out.PutVarint((uint64_t)m_flowFieldGroupSize);
+    // Path graph schedule: 0 not asked for on this terrain, 1 published, 2 + n due in n ticks
+    uint64_t pathFinder = 0;
+    if (m_terrain && m_pathFinderRevision == m_terrain->GetRevision()) {
+        pathFinder = m_pathFinderTicket ? 2 + (m_pathFinderDueTick - std::min(m_pathFinderDueTick, m_tickCount)) : 1;
+    }
+    out.PutVarint(pathFinder);
+    m_store.Write(out);
+    
+    // Flow fields are numbered from 1 in order of first use (0: none) and written as the goal
+    // they lead to; units, the cache and pending groups refer to them by number
+    std::unordered_map<const FlowField*, uint64_t> numbers;
+    std::vector<const FlowField*> fields;
+    auto number = [&](const std::shared_ptr<const FlowField>& field) -> uint64_t {
+        if (!field) return 0;
+        auto [it, added] = numbers.emplace(field.get(), fields.size() + 1);
+        if (added) fields.push_back(field.get());
+        return it->second;
+    };
+    std::vector<std::pair<uint32_t, uint64_t>> unitFlows;
+    for (uint32_t i = 0; i < m_store.Size(); ++i) {
+        if (m_store.paths[i].flow) unitFlows.push_back({i, number(m_store.paths[i].flow)});
+    }
+    std::vector<uint64_t> cached;
+    for (const auto& field : m_flowFields.GetFields()) cached.push_back(number(field));
+    std::vector<uint64_t> pendingFields;
+    for (const PendingFlow& pending : m_pendingFlows) pendingFields.push_back(number(pending.field));
+    
+    out.PutVarint(fields.size());
+    for (const FlowField* field : fields) {
+        glm::vec3 goal(field->goalVertex % field->width - field->width * 0.5f, 0.0f,
+                       field->goalVertex / field->width - field->height * 0.5f);
+        out.Put<uint8_t>((uint8_t)field->mobility);
+        out.Put(goal);
+    }
+    out.PutVarint(unitFlows.size());
+    uint32_t previousSlot = 0;
+    for (const auto& [slot, field] : unitFlows) {
+        out.PutVarint(slot - previousSlot);
+        out.PutVarint(field);
+        previousSlot = slot;
+    }
+    out.PutVarint(cached.size());
+    for (uint64_t field : cached) out.PutVarint(field);
+    
+    // Requests in flight keep their place in the schedule; results are not saved
+    out.PutVarint(m_pendingPaths.size());
+    for (const PendingPath& pending : m_pendingPaths) {
+        out.PutVarint((uint64_t)pending.unitId);
+        out.Put(pending.start);
+        out.Put(pending.goal);
+        out.PutVarint(pending.dueTick - m_tickCount);
+    }
+    out.PutVarint(m_pendingFlows.size());
+    for (size_t k = 0; k < m_pendingFlows.size(); ++k) {
+        const PendingFlow& pending = m_pendingFlows[k];
+        out.Put<uint8_t>((uint8_t)pending.mobility);
+        out.PutVarint((uint64_t)pending.goalVertex);
+        out.PutVarint(pendingFields[k]);
+        out.PutVarint(pending.dueTick - m_tickCount);
+        out.PutVarint(pending.units.size());
+        for (const auto& [unitId, goal] : pending.units) {
+            out.PutVarint((uint64_t)unitId);
+            out.Put(goal);
+        }
+    }
+    
+    out.Put<uint8_t>(ai ? 1 : 0);
+    if (ai) ai->WriteSnapshot(out);
+    
+    uint64_t payload = out.Size() - start - SnapshotHeaderSize;
+    std::memcpy(out.bytes.data() + start + sizeof(SnapshotMagic) + sizeof(uint32_t), &payload, sizeof(payload));
+}
+
+bool SimulationEngine::ReadSnapshot(const uint8_t* data, size_t size, AISystem* ai) {
+    ByteReader in(data, size);
+    char magic[sizeof(SnapshotMagic)];
+    in.GetRaw(magic, sizeof(magic));
+    uint32_t version = in.Get<uint32_t>();
+    uint64_t payload = in.Get<uint64_t>();
+    if (!in.Ok() || std::memcmp(magic, SnapshotMagic, sizeof(magic)) != 0) {
+        std::cerr << "Not a simulation snapshot" << std::endl;
+        return false;
+    }
+    if (version != SnapshotVersion) {
+        std::cerr << "Unsupported simulation snapshot version " << version << " (expected "
+                  << SnapshotVersion << ")" << std::endl;
+        return false;
+    }
+    if (payload != in.Remaining()) {
+        std::cerr << "Simulation snapshot is truncated" << std::endl;
+        return false;
+    }
+    
+    // Everything is read into locals first so a bad snapshot changes nothing
+    uint8_t state = in.Get<uint8_t>();
+    float simulationTime = in.Get<float>();
+    float activityTimer = in.Get<float>();
+    int nextUnitId = (int)in.GetVarint();
+    uint64_t tickCount = in.GetVarint();
+    uint64_t seed = in.Get<uint64_t>();
+    int flowFieldGroupSize = (int)in.GetVarint();
+    uint64_t pathFinder = in.GetVarint();
+    UnitStore store;
+    store.Read(in);
+    if (state > (uint8_t)SimulationState::PAUSED) in.Fail();
+    
+    auto readMobility = [&in]() {
+        uint8_t mobility = in.Get<uint8_t>();
+        if (mobility >= MobilityCount) in.Fail();
+        return (Mobility)mobility;
+    };
+    auto readFieldNumber = [&in](size_t fieldCount) {
+        uint64_t field = in.GetVarint();
+        if (field > fieldCount) in.Fail();
+        return field;
+    };
+    
+    uint64_t fieldCount = in.GetVarint();
+    std::vector<FlowFieldGoal> fieldGoals;
+    if (in.Expect(fieldCount, 1 + sizeof(glm::vec3))) fieldGoals.resize(fieldCount);
+    for (FlowFieldGoal& goal : fieldGoals) {
+        goal.mobility = readMobility();
+        goal.goal = in.Get<glm::vec3>();
+    }
+    std::vector<std::pair<uint32_t, uint64_t>> unitFlows;
+    uint64_t unitFlowCount = in.GetVarint();
+    if (in.Expect(unitFlowCount, 2)) unitFlows.resize(unitFlowCount);
+    uint64_t slot = 0;
+    for (auto& [unitSlot, field] : unitFlows) {
+        slot += in.GetVarint();
+        if (slot >= store.Size()) in.Fail();
+        unitSlot = (uint32_t)slot;
+        field = readFieldNumber(fieldGoals.size());
+    }
+    std::vector<uint64_t> cached;
+    uint64_t cachedCount = in.GetVarint();
+    if (in.Expect(cachedCount, 1)) cached.resize(cachedCount);
+    for (uint64_t& field : cached) field = readFieldNumber(fieldGoals.size());
+    
+    std::vector<PendingPath> pendingPaths;
+    uint64_t pendingPathCount = in.GetVarint();
+    if (in.Expect(pendingPathCount, 2 + 2 * sizeof(glm::vec3))) pendingPaths.resize(pendingPathCount);
+    for (PendingPath& pending : pendingPaths) {
+        pending.ticket = 0;
+        pending.unitId = (int)in.GetVarint();
+        pending.start = in.Get<glm::vec3>();
+        pending.goal = in.Get<glm::vec3>();
+        pending.dueTick = tickCount + in.GetVarint();
+    }
+    std::vector<PendingFlow> pendingFlows;
+    std::vector<uint64_t> pendingFields;
+    uint64_t pendingFlowCount = in.GetVarint();
+    if (in.Expect(pendingFlowCount, 5)) {
+        pendingFlows.resize(pendingFlowCount);
+        pendingFields.resize(pendingFlowCount);
+    }
+    for (size_t k = 0; k < pendingFlows.size() && in.Ok(); ++k) {
+        PendingFlow& pending = pendingFlows[k];
+        pending.ticket = 0;
+        pending.mobility = readMobility();
+        pending.goalVertex = (int)in.GetVarint();
+        pendingFields[k] = readFieldNumber(fieldGoals.size());
+        pending.dueTick = tickCount + in.GetVarint();
+        uint64_t units = in.GetVarint();
+        if (!in.Expect(units, 1 + sizeof(glm::vec3))) break;
+        pending.units.resize(units);
+        for (auto& [unitId, goal] : pending.units) {
+            unitId = (int)in.GetVarint();
+            goal = in.Get<glm::vec3>();
+        }
+    }
+    
+    // The AI goes last: once it has read its part nothing else can fail
+    bool hasAI = in.Get<uint8_t>() != 0;
+    if (!in.Ok() || (hasAI && ai && !ai->ReadSnapshot(in))) {
+        std::cerr << "Malformed simulation snapshot" << std::endl;
+        return false;
+    }
+    
+    DrainPaths();
+    m_units.clear();
+    m_contactGrid.Clear();
+    m_contactPartners.clear();
+    m_sensorViewsheds.clear();
+    store.audio = m_store.audio;
+    store.terrain = m_store.terrain;
+    m_store = std::move(store);
+    m_store.rngSeed = seed;
+    m_state = (SimulationState)state;
+    m_simulationTime = simulationTime;
+    m_activityTimer = activityTimer;
+    m_nextUnitId = nextUnitId;
+    m_tickCount = tickCount;
+    m_flowFieldGroupSize = flowFieldGroupSize;
+    RebuildUnitHandles();
+    
+    // The graph keeps its schedule; one already published is built here, blocking the load
+    // rather than a tick
+    const bool terrain = m_terrain && m_terrain->IsLoaded();
+    if (m_pathFinderTicket) m_paths->Discard(m_pathFinderTicket);
+    m_pathFinder.reset();
+    m_pathFinderTicket = 0;
+    m_pathFinderRevision = 0;
+    if (terrain && pathFinder == 1) {
+        m_pathFinder = m_terrain->GetPathFinder();
+        m_pathFinderRevision = m_terrain->GetRevision();
+    } else if (terrain && pathFinder >= 2) {
+        RequestPathFinder(m_tickCount + (pathFinder - 2));
+    }
+    
+    // Flow fields are rebuilt and routes still in flight asked for again, all from the current
+    // terrain; without one, units keep the straight line
+    const bool routes = !fieldGoals.empty() || !pendingPaths.empty() || !pendingFlows.empty();
+    std::shared_ptr<const PathFinder> finder = m_pathFinder;
+    if (!finder && terrain && routes) finder = m_terrain->GetPathFinder();
+    if (!finder && routes) {
+        std::cerr << "Snapshot has routes but no terrain is set; units will head straight for their destinations"
+                  << std::endl;
+    }
+    std::vector<std::shared_ptr<const FlowField>> fields(fieldGoals.size());
+    if (finder) {
+        m_workers->ParallelFor(fieldGoals.size(), [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                auto field = std::make_shared<FlowField>();
+                if (finder->BuildFlowField(fieldGoals[k].mobility, fieldGoals[k].goal, *field)) {
+                    fields[k] = std::move(field);
+                }
+            }
+        });
+    }
+    auto fieldFor = [&fields](uint64_t number) {
+        return number ? fields[number - 1] : nullptr;
+    };
+    for (const auto& [unitSlot, field] : unitFlows) {
+        m_store.paths[unitSlot].flow = fieldFor(field);
+    }
+    for (uint64_t field : cached) {
+        m_flowFields.Insert(fieldFor(field));
+    }
+    
+    if (!finder) return true;
+    for (PendingPath& pending : pendingPaths) {
+        int index = m_store.IndexOf(pending.unitId);
+        if (index < 0) continue;  // Would have been discarded on arrival anyway
+        pending.ticket = m_paths->Submit(finder, GetMobility(m_store.type[index]), pending.start, pending.goal);
+        m_pendingPaths.push_back(pending);
+    }
+    for (size_t k = 0; k < pendingFlows.size(); ++k) {
+        PendingFlow& pending = pendingFlows[k];
+        pending.terrainRevision = finder->GetRevision();
+        if (pendingFields[k]) {
+            pending.field = fieldFor(pendingFields[k]);
+            if (!pending.field) continue;
+        } else {
+            if (pending.units.empty()) continue;
+            pending.ticket = m_paths->SubmitFlowField(finder, pending.mobility, pending.units[0].second);
+        }
+        m_pendingFlows.push_back(std::move(pending));
+    }
+    return true;
+}
+
+bool SimulationEngine::SaveSnapshot(const std::string& path, const AISystem* ai) const {
+    ByteWriter out;
+    WriteSnapshot(out, ai);
+    
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Cannot create simulation snapshot: " << path << std::endl;
+        return false;
+    }
+    bool written = std::fwrite(out.bytes.data(), 1, out.Size(), file) == out.Size();
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        std::cerr << "Failed to write simulation snapshot: " << path << std::endl;
+    }
+    return written;
+}
+
+bool SimulationEngine::LoadSnapshot(const std::string& path, AISystem* ai) {
+    MappedFile file;
+    if (!file.Open(path)) {
+        std::cerr << "Cannot map simulation snapshot: " << path << std::endl;
+        return false;
+    }
+    file.AdviseSequential(0, file.GetSize());
+    return ReadSnapshot(file.GetData(), file.GetSize(), ai);
+}
+
+int SimulationEngine::CommandAllied(const std::string& command) {
+    auto units = GetAllUnits();
+    int blueUnitsAffected = 0;
+    
+    for (auto& unit : units) {
+        // Only command blue/allied units
+        if (unit->IsAllied()) {
+        
+            if (command == "ADVANCE") {
+                // Move toward center/objective with VERY tight boundary constraints
+                glm::vec3 target = glm::vec3(5.0f, 0.0f, 5.0f);  // Closer target
+                glm::vec3 clampedTarget = glm::vec3(
+                    std::clamp(target.x, -25.0f, 25.0f),
+                    target.y,
+                    std::clamp(target.z, -25.0f, 25.0f)
+                );
+                unit->SetTargetPosition(clampedTarget);
+                unit->SetMovementSpeed(2.5f); // Faster movement
+                unit->SetActiveCommand("ADVANCING", 4.0f); // Visual feedback for 4 seconds
+                std::cout << "  ➡️  " << unit->GetTypeString() << " advancing to objective" << std::endl;
+            
+            } else if (command == "DEFEND") {
+                // Hold current position with defensive stance
+                auto currentPos = unit->GetPosition();
+                unit->SetTargetPosition(currentPos); // Stay in place
+                unit->SetMovementSpeed(0.8f); // Slower, cautious movement
+                unit->SetActiveCommand("DEFENDING", 4.0f); // Visual feedback
+                std::cout << "  🛡️  " << unit->GetTypeString() << " taking defensive position" << std::endl;
+            
+            } else if (command == "PATROL") {
+                // Begin patrol pattern with VERY tight boundary constraints
+                auto currentPos = unit->GetPosition();
+                float patrolRadius = 15.0f;  // Much smaller patrol radius
+                // Phased by simulation time rather than the wall clock so replays pick the same points
+                glm::vec3 patrolTarget = currentPos + glm::vec3(
+                    sin(m_simulationTime + unit->GetId()) * patrolRadius,
+                    0.0f,
+                    cos(m_simulationTime + unit->GetId()) * patrolRadius
+                );
+                glm::vec3 clampedTarget = glm::vec3(
+                    std::clamp(patrolTarget.x, -25.0f, 25.0f),
+                    patrolTarget.y,
+                    std::clamp(patrolTarget.z, -25.0f, 25.0f)
+                );
+                unit->SetTargetPosition(clampedTarget);
+                unit->SetMovementSpeed(1.8f); // Normal patrol speed
+                unit->SetActiveCommand("PATROLLING", 4.0f); // Visual feedback
+                std::cout << "  🔄  " << unit->GetTypeString() << " beginning patrol operations" << std::endl;
+            
+            } else if (command == "WITHDRAW") {
+                // Move to safe rally point with VERY tight boundary constraints
+                glm::vec3 rallyPoint = glm::vec3(-20.0f, 0.0f, -20.0f);  // Closer rally point
+                glm::vec3 clampedTarget = glm::vec3(
+                    std::clamp(rallyPoint.x, -25.0f, 25.0f),
+                    rallyPoint.y,
+                    std::clamp(rallyPoint.z, -25.0f, 25.0f)
+                );
+                unit->SetTargetPosition(clampedTarget);
+                unit->SetMovementSpeed(3.0f); // Fast withdrawal
+                unit->SetActiveCommand("WITHDRAWING", 4.0f); // Visual feedback
+                std::cout << "  ⬅️  " << unit->GetTypeString() << " withdrawing to rally point" << std::endl;
+            
+            } else if (command == "RECON") {
+                // Scout ahead toward opposition positions
+                unit->SetTargetPosition(glm::vec3(50.0f, 0.0f, 30.0f));
+                unit->SetMovementSpeed(1.2f); // Slow, stealthy movement
+                unit->SetActiveCommand("RECON", 4.0f); // Visual feedback
+                std::cout << "  🔍  " << unit->GetTypeString() << " conducting reconnaissance" << std::endl;
+            }
+            
+            blueUnitsAffected++;
         }
     }
-    return nullptr;
+    
+    return blueUnitsAffected;
+}
+
+int SimulationEngine::CommandAlliedTo(const glm::vec3& target) {
+    int blueUnitsAffected = 0;
+    for (auto& unit : GetAllUnits()) {
+        if (unit->IsAllied()) {
+            unit->SetTargetPosition(target);
+            unit->SetMovementSpeed(2.5f);
+            unit->SetActiveCommand("MOVING", 4.0f);
+            blueUnitsAffected++;
+        }
+    }
+    return blueUnitsAffected;
+}
+
+const Viewshed* SimulationEngine::GetSensorViewshed(int unitId) const {
+    auto it = m_sensorViewsheds.find(unitId);
+    return it != m_sensorViewsheds.end() ? &it->second : nullptr;
 }
 
 std::vector<Unit*> SimulationEngine::GetAllUnits() const {
@@ -134,9 +805,7 @@ std::vector<Unit*> SimulationEngine::GetAllUnits() const {
     units.reserve(m_units.size());
     
     for (const auto& unit : m_units) {
-        if (unit) { // Safety check
-            units.push_back(unit.get());
-        }
+        units.push_back(unit.get());
     }
     return units;
 }
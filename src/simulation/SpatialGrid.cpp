@@ -0,0 +1,116 @@
+#include "simulation/SpatialGrid.h"
+#include "simulation/UnitStore.h"
+#include <algorithm>
+#include <limits>
+
+namespace TS {
+
+SpatialGrid::SpatialGrid(float cellSize)
+    : m_cellSize(cellSize), m_invCellSize(1.0f / cellSize), m_cellCount(0),
+      m_originX(0), m_originZ(0), m_width(0), m_depth(0) {
+}
+
+void SpatialGrid::Build(const UnitStore& units) {
+    const uint32_t inactive = std::numeric_limits<uint32_t>::max();
+    
+    // Bounds of the occupied cells
+    int minX = std::numeric_limits<int>::max(), minZ = minX;
+    int maxX = std::numeric_limits<int>::min(), maxZ = maxX;
+    size_t live = 0;
+    for (size_t i = 0; i < units.Size(); ++i) {
+        if (units.health[i] <= 0.0f) continue;
+        int cx = CellCoord(units.position[i].x);
+        int cz = CellCoord(units.position[i].z);
+        minX = std::min(minX, cx);
+        maxX = std::max(maxX, cx);
+        minZ = std::min(minZ, cz);
+        maxZ = std::max(maxZ, cz);
+        live++;
+    }
+    
+    const int64_t cells = live ? ((int64_t)maxX - minX + 1) * ((int64_t)maxZ - minZ + 1) * 2 : 0;
+    if (cells > (int64_t)std::max<size_t>(live * 4, 1 << 16)) {
+        BuildSparse(units);
+        return;
+    }
+    m_entries.clear();
+    m_cells.clear();
+    m_originX = minX;
+    m_originZ = minZ;
+    m_width = live ? maxX - minX + 1 : 0;
+    m_depth = live ? maxZ - minZ + 1 : 0;
+    
+    // Counting sort by cell; scattering in slot order keeps each cell's run ascending
+    m_cellStart.assign((size_t)cells + 1, 0);
+    m_cellOf.resize(units.Size());
+    for (size_t i = 0; i < units.Size(); ++i) {
+        if (units.health[i] <= 0.0f) {
+            m_cellOf[i] = inactive;
+            continue;
+        }
+        int x = CellCoord(units.position[i].x) - m_originX;
+        int z = CellCoord(units.position[i].z) - m_originZ;
+        m_cellOf[i] = (uint32_t)(((size_t)z * m_width + x) * 2 + (units.allied[i] != 0 ? 1 : 0));
+        m_cellStart[m_cellOf[i] + 1]++;
+    }
+    m_cellCount = 0;
+    for (size_t c = 1; c < m_cellStart.size(); ++c) {
+        m_cellCount += m_cellStart[c] != 0;
+        m_cellStart[c] += m_cellStart[c - 1];
+    }
+    
+    m_indices.resize(live);
+    std::vector<uint32_t>& next = m_cellOf;  // Reused in place: each slot's cell becomes its write position
+    for (size_t i = 0; i < units.Size(); ++i) {
+        if (next[i] != inactive) {
+            next[i] = m_cellStart[next[i]]++;
+            m_indices[next[i]] = (uint32_t)i;
+        }
+    }
+    // The scatter advanced every start to its cell's end; shift back by one cell
+    for (size_t c = m_cellStart.size() - 1; c > 0; --c) {
+        m_cellStart[c] = m_cellStart[c - 1];
+    }
+    m_cellStart[0] = 0;
+}
+
+void SpatialGrid::BuildSparse(const UnitStore& units) {
+    m_cellStart.clear();
+    m_entries.clear();
+    m_entries.reserve(units.Size());
+    
+    for (size_t i = 0; i < units.Size(); ++i) {
+        if (units.health[i] <= 0.0f) continue;
+        const glm::vec3& pos = units.position[i];
+        m_entries.emplace_back(MakeKey(CellCoord(pos.x), CellCoord(pos.z), units.allied[i] != 0), (uint32_t)i);
+    }
+    
+    // Sorting groups each cell's units into one contiguous, index-ordered run
+    std::sort(m_entries.begin(), m_entries.end());
+    
+    m_indices.resize(m_entries.size());
+    m_cells.clear();
+    m_cells.reserve(m_entries.size());
+    for (uint32_t begin = 0; begin < m_entries.size();) {
+        uint32_t end = begin + 1;
+        while (end < m_entries.size() && m_entries[end].first == m_entries[begin].first) {
+            ++end;
+        }
+        for (uint32_t i = begin; i < end; ++i) {
+            m_indices[i] = m_entries[i].second;
+        }
+        m_cells.emplace(m_entries[begin].first, std::make_pair(begin, end));
+        begin = end;
+    }
+    m_cellCount = m_cells.size();
+}
+
+void SpatialGrid::Clear() {
+    m_indices.clear();
+    m_cellStart.clear();
+    m_entries.clear();
+    m_cells.clear();
+    m_cellCount = 0;
+}
+
+}
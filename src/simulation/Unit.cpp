@@ -1,49 +1,38 @@
 #include "simulation/Unit.h"
+#include "simulation/SpatialGrid.h"
+#include "core/Random.h"
 #include <algorithm>
 #include <iostream>
 
 namespace TS {
 
-Unit::Unit(int id, UnitType type, const glm::vec3& position, bool isAllied)
-    : m_id(id), m_type(type), m_isAllied(isAllied), m_position(position),
-      m_destination(position), m_targetPosition(position), m_state(UnitState::IDLE), 
-      m_lastCommand(""), m_commandFeedbackTimer(0.0f), m_commandExecutionCount(0), m_movementSpeed(25.0f) {
-    
-    switch (m_type) {
-        case UnitType::PERSONNEL:
-            m_maxHealth = 100.0f;
-            break;
-        case UnitType::VEHICLE:
-            m_maxHealth = 300.0f;
-            break;
-        case UnitType::EQUIPMENT:
-            m_maxHealth = 150.0f;
-            break;
-        case UnitType::SENSOR:
-            m_maxHealth = 80.0f;
-            break;
-    }
-    
-    m_health = m_maxHealth;
+Unit::Unit(UnitStore* store, uint32_t index)
+    : m_store(store), m_index(index) {
 }
 
-void Unit::Update(float deltaTime) {
+void Unit::Think(float deltaTime) {
+    UnitState& state = m_store->state[m_index];
     if (!IsActive()) {
-        m_state = UnitState::DISABLED;
+        state = UnitState::DISABLED;
         return;
     }
     
+    const int id = GetId();
+    const bool isAllied = IsAllied();
+    const glm::vec3& position = m_store->position[m_index];
+    glm::vec3& destination = m_store->destination[m_index];
+    
     // Dynamic AI-driven movement (more frequent updates)
-    static float behaviorTimer = 0.0f;
+    float& behaviorTimer = m_store->behaviorTimer[m_index];
     behaviorTimer += deltaTime;
     
-    if (m_state == UnitState::MOVING || behaviorTimer > 2.0f) { // Reduced from 3.0f
+    if (state == UnitState::MOVING || behaviorTimer > 2.0f) { // Reduced from 3.0f
         // AI decides new destination every 2 seconds for more activity
         if (behaviorTimer > 2.0f) {
             behaviorTimer = 0.0f;
             
             // Different behaviors based on unit type and allegiance
-            if (m_isAllied) {
+            if (isAllied) {
                 // Allied units patrol in formation with VERY strict boundary constraints
                 float patrolRadius = 20.0f;  // Reduced patrol radius
                 float angle = (GetId() * 60.0f + behaviorTimer * 10.0f) * M_PI / 180.0f;
@@ -53,15 +42,15 @@ void Unit::Update(float deltaTime) {
                     sin(angle) * patrolRadius - 15.0f   // Much smaller offset
                 );
                 // VERY tight terrain boundaries (-30 to +30 maximum)
-                m_destination = glm::vec3(
+                destination = glm::vec3(
                     std::clamp(newDest.x, -30.0f, 30.0f),
                     0,
                     std::clamp(newDest.z, -30.0f, 30.0f)
                 );
                 
                 // Double-check position constraint
-                if (glm::length(m_destination) > 35.0f) {
-                    m_destination = glm::normalize(m_destination) * 30.0f;
+                if (glm::length(destination) > 35.0f) {
+                    destination = glm::normalize(destination) * 30.0f;
                 }
             } else {
                 // Opposition units with VERY strict boundary constraints
@@ -73,45 +62,91 @@ void Unit::Update(float deltaTime) {
                     sin(angle) * searchRadius + 10.0f   // Much smaller offset
                 );
                 // VERY tight terrain boundaries (-30 to +30 maximum)
-                m_destination = glm::vec3(
+                destination = glm::vec3(
                     std::clamp(newDest.x, -30.0f, 30.0f),
                     0,
                     std::clamp(newDest.z, -30.0f, 30.0f)
                 );
                 
                 // Double-check position constraint
-                if (glm::length(m_destination) > 35.0f) {
-                    m_destination = glm::normalize(m_destination) * 30.0f;
+                if (glm::length(destination) > 35.0f) {
+                    destination = glm::normalize(destination) * 30.0f;
                 }
             }
-            m_state = UnitState::MOVING;
+            state = UnitState::MOVING;
         }
         
-        // Execute movement
-        glm::vec3 direction = m_destination - m_position;
-        float distance = glm::length(direction);
-        
-        if (distance > 2.0f) {
-            direction = glm::normalize(direction);
-            
+        if (glm::length(destination - position) > 2.0f) {
             // Add movement sound effects
-            static float soundTimer = 0.0f;
+            float& soundTimer = m_store->soundTimer[m_index];
             soundTimer += deltaTime;
             if (soundTimer >= 3.0f) {  // Play sound every 3 seconds during movement
-                if (m_isAllied) {
-                    system("afplay /System/Library/Sounds/Submarine.aiff > /dev/null 2>&1 &");
-                    std::cout << "🔵 Blue unit " << m_id << " maneuvering" << std::endl;
+                if (isAllied) {
+                    PostSound(SoundEvent::BLUE_MANEUVER);
+                    std::cout << "🔵 Blue unit " << id << " maneuvering" << std::endl;
                 } else {
-                    system("afplay /System/Library/Sounds/Morse.aiff > /dev/null 2>&1 &");
-                    std::cout << "🔴 Red unit " << m_id << " repositioning" << std::endl;
+                    PostSound(SoundEvent::RED_MANEUVER);
+                    std::cout << "🔴 Red unit " << id << " repositioning" << std::endl;
                 }
                 soundTimer = 0.0f;
             }
+        }
+    }
+    
+    // Simulate interaction scenarios
+    float& interactionTimer = m_store->interactionTimer[m_index];
+    interactionTimer += deltaTime;
+    if (interactionTimer > 8.0f) {
+        interactionTimer = 0.0f;
+        // Simulate taking some damage in interaction scenarios, drawn from this unit's own stream
+        uint64_t roll = CounterHash(m_store->rngSeed, (uint64_t)id, m_store->rngCounter[m_index]++);
+        if (roll % 100 < 5) { // 5% chance
+            TakeDamage(5.0f);
+        }
+    }
+}
+
+void Unit::Integrate(float deltaTime) {
+    UnitState& state = m_store->state[m_index];
+    if (state == UnitState::DISABLED) return;
+    
+    if (state == UnitState::MOVING) {
+        glm::vec3& position = m_store->position[m_index];
+        const float behaviorTimer = m_store->behaviorTimer[m_index];
+        
+        // Steer for the next waypoint of the planned route; its last one is the destination itself
+        UnitPath& path = m_store->paths[m_index];
+        while (path.next + 1 < path.waypoints.size() &&
+               glm::distance(path.waypoints[path.next], position) <= WaypointRadius) {
+            path.next++;
+        }
+        const bool onRoute = path.next < path.waypoints.size() || path.flow;
+        const glm::vec3& destination = path.next < path.waypoints.size() ? path.waypoints[path.next]
+                                                                         : m_store->destination[m_index];
+        
+        // Routes may swing wide of the patrol area around high ground, but never off the map
+        float limitX = 30.0f, limitZ = 30.0f;
+        if (onRoute && m_store->terrain) {
+            limitX = (m_store->terrain->GetWidth() - 1) * 0.5f;
+            limitZ = (m_store->terrain->GetHeight() - 1) * 0.5f;
+        }
+        
+        // Execute movement
+        glm::vec3 direction = destination - position;
+        float distance = glm::length(direction);
+        
+        if (distance > 2.0f) {
+            // A flow field gives the heading from here; straight on where it has none
+            glm::vec3 flowDirection;
+            if (path.flow && path.flow->Sample(position, flowDirection)) {
+                direction = flowDirection;
+            }
+            direction = glm::normalize(direction);
             
             // Use configurable movement speed or default by type
-            float speed = m_movementSpeed;
+            float speed = m_store->movementSpeed[m_index];
             if (speed == 25.0f) { // If default speed, use type-specific speeds
-                switch (m_type) {
+                switch (GetType()) {
                     case UnitType::PERSONNEL: speed = 20.0f; break;
                     case UnitType::VEHICLE: speed = 35.0f; break;
                     case UnitType::EQUIPMENT: speed = 15.0f; break;
@@ -119,51 +154,42 @@ void Unit::Update(float deltaTime) {
                 }
             }
             
-            m_position += direction * speed * deltaTime;
+            // Slower up steep ground; impassable slopes still allow a crawl so nobody is stranded
+            if (m_store->terrain) {
+                float cost = m_store->terrain->CostAt(GetMobility(GetType()), position.x, position.z);
+                speed *= std::max(1.0f / cost, MinTerrainSpeedFactor);
+            }
+            
+            position += direction * speed * deltaTime;
             
             // CRITICAL: Always clamp actual position to boundaries
-            m_position.x = std::clamp(m_position.x, -30.0f, 30.0f);
-            m_position.z = std::clamp(m_position.z, -30.0f, 30.0f);
+            position.x = std::clamp(position.x, -limitX, limitX);
+            position.z = std::clamp(position.z, -limitZ, limitZ);
             
             // Add some realistic movement variation
-            m_position.x += sin(behaviorTimer * 2.0f) * 0.3f;
-            m_position.z += cos(behaviorTimer * 1.5f) * 0.2f;
+            position.x += sin(behaviorTimer * 2.0f) * 0.3f;
+            position.z += cos(behaviorTimer * 1.5f) * 0.2f;
             
             // Re-clamp after movement variation
-            m_position.x = std::clamp(m_position.x, -30.0f, 30.0f);
-            m_position.z = std::clamp(m_position.z, -30.0f, 30.0f);
+            position.x = std::clamp(position.x, -limitX, limitX);
+            position.z = std::clamp(position.z, -limitZ, limitZ);
         } else {
-            m_position = m_destination;
-            m_state = UnitState::IDLE;
+            position = destination;
+            state = UnitState::IDLE;
         }
     }
     
     // Update command feedback timer
-    if (m_commandFeedbackTimer > 0.0f) {
-        m_commandFeedbackTimer -= deltaTime;
-    }
-    
-    // Simulate interaction scenarios
-    static float interactionTimer = 0.0f;
-    interactionTimer += deltaTime;
-    if (interactionTimer > 8.0f) {
-        interactionTimer = 0.0f;
-        // Simulate taking some damage in interaction scenarios
-        if (rand() % 100 < 5) { // 5% chance
-            TakeDamage(5.0f);
-        }
+    if (m_store->commandFeedbackTimer[m_index] > 0.0f) {
+        m_store->commandFeedbackTimer[m_index] -= deltaTime;
     }
 }
 
-void TS::Unit::SetDestination(const glm::vec3& dest) {
-    m_destination = dest;
-    m_state = UnitState::MOVING;
-}
-
 void TS::Unit::TakeDamage(float damage) {
-    m_health = std::max(0.0f, m_health - damage);
+    float& health = m_store->health[m_index];
+    health = std::max(0.0f, health - damage);
     if (!IsActive()) {
-        std::cout << GetTypeString() << " " << m_id << " disabled!" << std::endl;
+        std::cout << GetTypeString() << " " << GetId() << " disabled!" << std::endl;
     }
 }
 
@@ -172,7 +198,7 @@ glm::vec3 TS::Unit::GetRenderColor() const {
         return glm::vec3(0.3f, 0.3f, 0.3f); // Dark gray for disabled
     }
     
-    if (m_isAllied) {
+    if (IsAllied()) {
         return glm::vec3(0.1f, 0.3f, 1.0f); // Bright blue for allied
     } else {
         return glm::vec3(1.0f, 0.1f, 0.1f); // Bright red for opposition
@@ -180,7 +206,7 @@ glm::vec3 TS::Unit::GetRenderColor() const {
 }
 
 std::string TS::Unit::GetTypeString() const {
-    switch (m_type) {
+    switch (GetType()) {
         case UnitType::PERSONNEL: return "Civilian Research";
         case UnitType::VEHICLE: return "Emergency Response";
         case UnitType::EQUIPMENT: return "Environmental Monitor";
@@ -190,76 +216,103 @@ std::string TS::Unit::GetTypeString() const {
 }
 
 void TS::Unit::SetTargetPosition(const glm::vec3& target) {
-    m_targetPosition = target;
-    m_destination = target; // Update current destination
-    m_state = UnitState::MOVING;
+    m_store->targetPosition[m_index] = target;
+    m_store->destination[m_index] = target; // Update current destination
+    m_store->state[m_index] = UnitState::MOVING;
 }
 
 void TS::Unit::SetMovementSpeed(float speed) {
-    m_movementSpeed = std::max(0.1f, speed); // Minimum speed of 0.1
+    m_store->movementSpeed[m_index] = std::max(0.1f, speed); // Minimum speed of 0.1
 }
 
 void TS::Unit::SetActiveCommand(const std::string& command, float duration) {
-    m_lastCommand = command;
-    m_commandFeedbackTimer = duration;
-    m_commandExecutionCount++;
-    std::cout << "  📋 " << GetTypeString() << " " << m_id << " executing: " << command << std::endl;
+    UnitCommandState& cold = m_store->commands[m_index];
+    cold.lastCommand = command;
+    cold.executionCount++;
+    m_store->commandFeedbackTimer[m_index] = duration;
+    std::cout << "  📋 " << GetTypeString() << " " << GetId() << " executing: " << command << std::endl;
     std::cout << "\a"; // Audio feedback for individual unit
 }
 
-void TS::Unit::CheckContact(const std::vector<std::unique_ptr<Unit>>& allUnits, float deltaTime) {
-    if (!IsActive()) return;
-    
-    for (const auto& other : allUnits) {
-        if (!other || !other->IsActive() || other->GetId() == m_id) continue;
-        
-        // Only engage with opposing teams
-        if (other->IsAllied() == m_isAllied) continue;
-        
-        if (IsInContactRange(*other)) {
-            // Contact detected - apply attrition
-            float damage = deltaTime * 8.0f; // Damage per second during contact
-            TakeDamage(damage);
-            
-            // Audio and visual feedback for contact (non-blocking)
-            if (m_isAllied) {
-                system("afplay /System/Library/Sounds/Ping.aiff > /dev/null 2>&1 &");
-                std::cout << "🔥 Blue unit " << m_id << " in contact! Health: " 
-                          << static_cast<int>(m_health) << "%" << std::endl;
-            } else {
-                system("afplay /System/Library/Sounds/Pop.aiff > /dev/null 2>&1 &");
-                std::cout << "⚡ Red unit " << m_id << " in contact! Health: " 
-                          << (int)(m_health/m_maxHealth*100) << "%" << std::endl;
-            }
-            
-            // Reduce callsigns and activity when heavily damaged
-            if (m_health < m_maxHealth * 0.3f) {
-                m_movementSpeed *= 0.7f; // Slower movement when damaged
-                if (m_isAllied) {
-                    std::cout << "📻 Blue " << m_id << " - comms degraded, reduced activity" << std::endl;
-                } else {
-                    std::cout << "📻 Red " << m_id << " - effectiveness compromised" << std::endl;
-                }
-            }
-            
-            // Unit elimination (non-blocking audio)
-            if (m_health <= 0) {
-                system("afplay /System/Library/Sounds/Basso.aiff > /dev/null 2>&1 &");
-                if (m_isAllied) {
-                    std::cout << "� Blue unit " << m_id << " disabled" << std::endl;
-                } else {
-                    std::cout << "� Red unit " << m_id << " removed" << std::endl;
-                }
-            }
-            break; // Only interact with one unit at a time
+void TS::Unit::PostSound(SoundEvent sound) const {
+    if (m_store->audio) {
+        m_store->audio->Post(sound);
+    }
+}
+
+bool TS::Unit::IsContactCandidate(uint32_t other) const {
+    // Only engage with active units of the opposing team
+    return other != m_index &&
+           m_store->health[other] > 0.0f &&
+           m_store->allied[other] != m_store->allied[m_index];
+}
+
+int TS::Unit::FindContact() const {
+    const glm::vec3& position = m_store->position[m_index];
+    for (size_t i = 0; i < m_store->Size(); ++i) {
+        if (IsContactCandidate((uint32_t)i) &&
+            glm::distance(position, m_store->position[i]) <= ContactRange) {
+            return (int)i;
         }
     }
+    return -1;
 }
 
-bool TS::Unit::IsInContactRange(const Unit& other) const {
-    float contactRange = 25.0f; // Increased contact range for better detection
-    float distance = glm::distance(m_position, other.GetPosition());
-    return distance <= contactRange;
+int TS::Unit::FindContact(const SpatialGrid& grid) const {
+    // Lowest index wins so the result matches the linear scan
+    const glm::vec3& position = m_store->position[m_index];
+    const bool opposingTeam = m_store->allied[m_index] == 0;
+    int contact = -1;
+    grid.ForEachNear(position, opposingTeam, [&](uint32_t i) {
+        if (contact >= 0 && (int)i > contact) return;
+        if (IsContactCandidate(i) &&
+            glm::distance(position, m_store->position[i]) <= ContactRange) {
+            contact = (int)i;
+        }
+    });
+    return contact;
+}
+
+void TS::Unit::ApplyContact(float deltaTime) {
+    // Contact detected - apply attrition
+    float damage = deltaTime * 8.0f; // Damage per second during contact
+    TakeDamage(damage);
+    
+    const int id = GetId();
+    const bool isAllied = IsAllied();
+    const float health = GetHealth();
+    const float maxHealth = GetMaxHealth();
+    
+    // Audio and visual feedback for contact
+    if (isAllied) {
+        PostSound(SoundEvent::BLUE_CONTACT);
+        std::cout << "🔥 Blue unit " << id << " in contact! Health: " 
+                  << static_cast<int>(health) << "%" << std::endl;
+    } else {
+        PostSound(SoundEvent::RED_CONTACT);
+        std::cout << "⚡ Red unit " << id << " in contact! Health: " 
+                  << (int)(health/maxHealth*100) << "%" << std::endl;
+    }
+    
+    // Reduce callsigns and activity when heavily damaged
+    if (health < maxHealth * 0.3f) {
+        m_store->movementSpeed[m_index] *= 0.7f; // Slower movement when damaged
+        if (isAllied) {
+            std::cout << "📻 Blue " << id << " - comms degraded, reduced activity" << std::endl;
+        } else {
+            std::cout << "📻 Red " << id << " - effectiveness compromised" << std::endl;
+        }
+    }
+    
+    // Unit elimination
+    if (health <= 0) {
+        PostSound(SoundEvent::UNIT_LOST);
+        if (isAllied) {
+            std::cout << "� Blue unit " << id << " disabled" << std::endl;
+        } else {
+            std::cout << "� Red unit " << id << " removed" << std::endl;
+        }
+    }
 }
 
 }
@@ -0,0 +1,294 @@
+#include "simulation/UnitStore.h"
+#include "core/ByteStream.h"
+
+namespace TS {
+
+namespace {
+
+float MaxHealthFor(UnitType unitType) {
+    float unitMaxHealth = 100.0f;
+    switch (unitType) {
+        case UnitType::PERSONNEL:
+            unitMaxHealth = 100.0f;
+            break;
+        case UnitType::VEHICLE:
+            unitMaxHealth = 300.0f;
+            break;
+        case UnitType::EQUIPMENT:
+            unitMaxHealth = 150.0f;
+            break;
+        case UnitType::SENSOR:
+            unitMaxHealth = 80.0f;
+            break;
+    }
+    return unitMaxHealth;
+}
+
+// Type, team and state share one byte per unit in snapshots
+constexpr uint8_t TypeMask = 0x03, AlliedBit = 0x04, StateShift = 3;
+// Per-unit route flags in snapshots
+constexpr uint8_t PathRequested = 0x01, PathHasWaypoints = 0x02;
+
+}
+
+uint32_t UnitStore::Add(int unitId, UnitType unitType, const glm::vec3& pos, bool isAllied) {
+    float unitMaxHealth = MaxHealthFor(unitType);
+    
+    uint32_t index = (uint32_t)id.size();
+    id.push_back(unitId);
+    type.push_back(unitType);
+    allied.push_back(isAllied ? 1 : 0);
+    state.push_back(UnitState::IDLE);
+    position.push_back(pos);
+    previousPosition.push_back(pos);
+    destination.push_back(pos);
+    targetPosition.push_back(pos);
+    health.push_back(unitMaxHealth);
+    maxHealth.push_back(unitMaxHealth);
+    movementSpeed.push_back(25.0f);
+    commandFeedbackTimer.push_back(0.0f);
+    behaviorTimer.push_back(0.0f);
+    soundTimer.push_back(0.0f);
+    interactionTimer.push_back(0.0f);
+    rngCounter.push_back(0);
+    commands.emplace_back();
+    paths.emplace_back();
+    
+    m_indexById[unitId] = index;
+    return index;
+}
+
+void UnitStore::Reserve(size_t count) {
+    id.reserve(count);
+    type.reserve(count);
+    allied.reserve(count);
+    state.reserve(count);
+    position.reserve(count);
+    previousPosition.reserve(count);
+    destination.reserve(count);
+    targetPosition.reserve(count);
+    health.reserve(count);
+    maxHealth.reserve(count);
+    movementSpeed.reserve(count);
+    commandFeedbackTimer.reserve(count);
+    behaviorTimer.reserve(count);
+    soundTimer.reserve(count);
+    interactionTimer.reserve(count);
+    rngCounter.reserve(count);
+    commands.reserve(count);
+    paths.reserve(count);
+    m_indexById.reserve(count);
+}
+
+void UnitStore::Clear() {
+    id.clear();
+    type.clear();
+    allied.clear();
+    state.clear();
+    position.clear();
+    previousPosition.clear();
+    destination.clear();
+    targetPosition.clear();
+    health.clear();
+    maxHealth.clear();
+    movementSpeed.clear();
+    commandFeedbackTimer.clear();
+    behaviorTimer.clear();
+    soundTimer.clear();
+    interactionTimer.clear();
+    rngCounter.clear();
+    commands.clear();
+    paths.clear();
+    m_indexById.clear();
+}
+
+void UnitStore::RemoveInactive() {
+    size_t count = Size();
+    size_t write = 0;
+    
+    for (size_t read = 0; read < count; ++read) {
+        if (health[read] <= 0.0f) continue;
+        
+        if (write != read) {
+            id[write] = id[read];
+            type[write] = type[read];
+            allied[write] = allied[read];
+            state[write] = state[read];
+            position[write] = position[read];
+            previousPosition[write] = previousPosition[read];
+            destination[write] = destination[read];
+            targetPosition[write] = targetPosition[read];
+            health[write] = health[read];
+            maxHealth[write] = maxHealth[read];
+            movementSpeed[write] = movementSpeed[read];
+            commandFeedbackTimer[write] = commandFeedbackTimer[read];
+            behaviorTimer[write] = behaviorTimer[read];
+            soundTimer[write] = soundTimer[read];
+            interactionTimer[write] = interactionTimer[read];
+            rngCounter[write] = rngCounter[read];
+            commands[write] = std::move(commands[read]);
+            paths[write] = std::move(paths[read]);
+        }
+        ++write;
+    }
+    
+    if (write == count) return;
+    
+    id.resize(write);
+    type.resize(write);
+    allied.resize(write);
+    state.resize(write);
+    position.resize(write);
+    previousPosition.resize(write);
+    destination.resize(write);
+    targetPosition.resize(write);
+    health.resize(write);
+    maxHealth.resize(write);
+    movementSpeed.resize(write);
+    commandFeedbackTimer.resize(write);
+    behaviorTimer.resize(write);
+    soundTimer.resize(write);
+    interactionTimer.resize(write);
+    rngCounter.resize(write);
+    commands.resize(write);
+    paths.resize(write);
+    
+    m_indexById.clear();
+    for (uint32_t i = 0; i < write; ++i) {
+        m_indexById[id[i]] = i;
+    }
+}
+
+void UnitStore::Write(ByteWriter& out) const {
+    const size_t count = Size();
+    out.PutVarint(count);
+    
+    // Ids only ever grow in slot order, so their deltas are a byte each
+    int previousId = 0;
+    for (size_t i = 0; i < count; ++i) {
+        out.PutSigned((int64_t)id[i] - previousId);
+        previousId = id[i];
+    }
+    for (size_t i = 0; i < count; ++i) {
+        out.Put<uint8_t>((uint8_t)type[i] | (allied[i] ? AlliedBit : 0) | ((uint8_t)state[i] << StateShift));
+    }
+    
+    out.PutArray(position.data(), count);
+    out.PutArray(destination.data(), count);
+    out.PutArray(targetPosition.data(), count);
+    out.PutArray(health.data(), count);
+    out.PutArray(movementSpeed.data(), count);
+    out.PutArray(commandFeedbackTimer.data(), count);
+    out.PutArray(behaviorTimer.data(), count);
+    out.PutArray(soundTimer.data(), count);
+    out.PutArray(interactionTimer.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+        out.PutVarint(rngCounter[i]);
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        out.PutString(commands[i].lastCommand);
+        out.PutVarint((uint64_t)commands[i].executionCount);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const UnitPath& path = paths[i];
+        uint8_t flags = (path.requested ? PathRequested : 0) | (path.waypoints.empty() ? 0 : PathHasWaypoints);
+        out.Put<uint8_t>(flags);
+        if (path.requested) out.Put(path.goal);
+        if (!path.waypoints.empty()) {
+            out.PutVarint(path.waypoints.size());
+            out.PutArray(path.waypoints.data(), path.waypoints.size());
+            out.PutVarint(path.next);
+        }
+    }
+}
+
+bool UnitStore::Read(ByteReader& in) {
+    Clear();
+    
+    uint64_t count = in.GetVarint();
+    // At least the fixed-size columns must follow
+    const size_t bytesPerUnit = 3 * sizeof(glm::vec3) + 6 * sizeof(float) + 5;
+    if (!in.Expect(count, bytesPerUnit)) return false;
+    
+    id.resize(count);
+    type.resize(count);
+    allied.resize(count);
+    state.resize(count);
+    int previousId = 0;
+    for (size_t i = 0; i < count; ++i) {
+        id[i] = previousId = (int)(previousId + in.GetSigned());
+    }
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t packed = in.Get<uint8_t>();
+        uint8_t unitState = packed >> StateShift;
+        if (unitState > (uint8_t)UnitState::DISABLED) in.Fail();
+        type[i] = (UnitType)(packed & TypeMask);
+        allied[i] = (packed & AlliedBit) ? 1 : 0;
+        state[i] = (UnitState)unitState;
+    }
+    
+    position.resize(count);
+    destination.resize(count);
+    targetPosition.resize(count);
+    health.resize(count);
+    movementSpeed.resize(count);
+    commandFeedbackTimer.resize(count);
+    behaviorTimer.resize(count);
+    soundTimer.resize(count);
+    interactionTimer.resize(count);
+    in.GetArray(position.data(), count);
+    in.GetArray(destination.data(), count);
+    in.GetArray(targetPosition.data(), count);
+    in.GetArray(health.data(), count);
+    in.GetArray(movementSpeed.data(), count);
+    in.GetArray(commandFeedbackTimer.data(), count);
+    in.GetArray(behaviorTimer.data(), count);
+    in.GetArray(soundTimer.data(), count);
+    in.GetArray(interactionTimer.data(), count);
+    previousPosition = position;
+    maxHealth.resize(count);
+    rngCounter.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        maxHealth[i] = MaxHealthFor(type[i]);
+        rngCounter[i] = in.GetVarint();
+    }
+    
+    commands.resize(count);
+    for (size_t i = 0; i < count && in.Ok(); ++i) {
+        commands[i].lastCommand = in.GetString();
+        commands[i].executionCount = (int)in.GetVarint();
+    }
+    paths.resize(count);
+    for (size_t i = 0; i < count && in.Ok(); ++i) {
+        UnitPath& path = paths[i];
+        uint8_t flags = in.Get<uint8_t>();
+        path.requested = (flags & PathRequested) != 0;
+        if (path.requested) path.goal = in.Get<glm::vec3>();
+        if (flags & PathHasWaypoints) {
+            uint64_t waypoints = in.GetVarint();
+            if (!in.Expect(waypoints, sizeof(glm::vec3))) break;
+            path.waypoints.resize(waypoints);
+            in.GetArray(path.waypoints.data(), waypoints);
+            path.next = (size_t)in.GetVarint();
+            if (path.next >= waypoints) in.Fail();
+        }
+    }
+    
+    if (!in.Ok()) {
+        Clear();
+        return false;
+    }
+    m_indexById.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        m_indexById[id[i]] = i;
+    }
+    return true;
+}
+
+int UnitStore::IndexOf(int unitId) const {
+    auto it = m_indexById.find(unitId);
+    return it != m_indexById.end() ? (int)it->second : -1;
+}
+
+}
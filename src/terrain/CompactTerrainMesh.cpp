@@ -0,0 +1,159 @@
+#include "terrain/CompactTerrainMesh.h"
+#include <algorithm>
+#include <cmath>
+
+namespace TS {
+
+namespace {
+
+inline float SignNotZero(float v) { return v < 0.0f ? -1.0f : 1.0f; }
+
+inline uint8_t QuantizeSigned(float v) {
+    return (uint8_t)std::lround((std::clamp(v, -1.0f, 1.0f) * 0.5f + 0.5f) * 255.0f);
+}
+
+}
+
+CompactTerrainMesh::CompactTerrainMesh()
+    : m_width(0), m_height(0), m_patchesX(0), m_heightMin(0.0f), m_heightStep(0.0f) {}
+
+void CompactTerrainMesh::EncodeNormal(const glm::vec3& normal, uint8_t out[2]) {
+    // Any length works: project onto the octahedron |x| + |y| + |z| = 1 and unfold its lower half around the diagonals
+    float l1 = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+    float u = normal.x / l1;
+    float v = normal.z / l1;
+    if (normal.y < 0.0f) {
+        float foldedU = (1.0f - std::fabs(v)) * SignNotZero(u);
+        v = (1.0f - std::fabs(u)) * SignNotZero(v);
+        u = foldedU;
+    }
+    out[0] = QuantizeSigned(u);
+    out[1] = QuantizeSigned(v);
+}
+
+glm::vec3 CompactTerrainMesh::DecodeNormal(const uint8_t in[2]) {
+    float u = in[0] * (2.0f / 255.0f) - 1.0f;
+    float v = in[1] * (2.0f / 255.0f) - 1.0f;
+    float y = 1.0f - std::fabs(u) - std::fabs(v);
+    if (y < 0.0f) {
+        float foldedU = (1.0f - std::fabs(v)) * SignNotZero(u);
+        v = (1.0f - std::fabs(u)) * SignNotZero(v);
+        u = foldedU;
+    }
+    return glm::normalize(glm::vec3(u, y, v));
+}
+
+int CompactTerrainMesh::ShapeFor(int width, int height) {
+    for (size_t i = 0; i < m_shapes.size(); ++i) {
+        if (m_shapes[i].width == width && m_shapes[i].height == height) return (int)i;
+    }
+    Shape shape;
+    shape.width = width;
+    shape.height = height;
+    shape.indices.resize(GridStripLength(width, height));
+    WriteGridStrip(width, height, shape.indices.data());
+    m_shapes.push_back(std::move(shape));
+    return (int)m_shapes.size() - 1;
+}
+
+void CompactTerrainMesh::Build(const float* heightData, int width, int height, float scale) {
+    m_width = width;
+    m_height = height;
+    m_patches.clear();
+    m_shapes.clear();
+    m_vertices.clear();
+    if (width < 2 || height < 2) return;
+    
+    auto [lo, hi] = std::minmax_element(heightData, heightData + (size_t)width * height);
+    float minHeight = std::min(*lo * scale, *hi * scale);
+    float maxHeight = std::max(*lo * scale, *hi * scale);
+    m_heightMin = minHeight;
+    m_heightStep = (maxHeight - minHeight) / 65535.0f;
+    const float toQuantized = m_heightStep > 0.0f ? 1.0f / m_heightStep : 0.0f;
+    
+    // Patches step by PatchVertices - 1 so neighbours overlap by one row or column
+    const int step = PatchVertices - 1;
+    m_patchesX = (width - 2) / step + 1;
+    const int patchesZ = (height - 2) / step + 1;
+    
+    size_t vertexCount = 0;
+    m_patches.reserve((size_t)m_patchesX * patchesZ);
+    for (int pz = 0; pz < patchesZ; ++pz) {
+        for (int px = 0; px < m_patchesX; ++px) {
+            Patch patch;
+            patch.x0 = px * step;
+            patch.z0 = pz * step;
+            patch.width = std::min(PatchVertices, width - patch.x0);
+            patch.height = std::min(PatchVertices, height - patch.z0);
+            patch.firstVertex = vertexCount;
+            patch.shape = ShapeFor(patch.width, patch.height);
+            vertexCount += (size_t)patch.width * patch.height;
+            m_patches.push_back(patch);
+        }
+    }
+    m_vertices.resize(vertexCount);
+    
+    for (const Patch& patch : m_patches) {
+        CompactTerrainVertex* out = &m_vertices[patch.firstVertex];
+        for (int lz = 0; lz < patch.height; ++lz) {
+            const int z = patch.z0 + lz;
+            const float* row = heightData + (size_t)z * width;
+            for (int lx = 0; lx < patch.width; ++lx, ++out) {
+                const int x = patch.x0 + lx;
+                const float y = row[x] * scale;
+                
+                // Same normal as TerrainMesh::BuildGeometry, from the whole grid so patch seams match.
+                // The octahedral projection divides by the L1 norm, so it is left unnormalized.
+                glm::vec3 normal(0.0f, 1.0f, 0.0f);
+                if (x > 0 && x < width - 1 && z > 0 && z < height - 1) {
+                    normal.x = (row[x - 1] - row[x + 1]) * 0.5f;
+                    normal.z = (row[x - width] - row[x + width]) * 0.5f;
+                    normal.y = 2.0f;
+                }
+                
+                out->height = (uint16_t)std::min(std::lround((y - minHeight) * toQuantized), 65535l);
+                EncodeNormal(normal, out->normal);
+                out->color = TerrainPaletteIndex(y);
+                out->reserved = 0;
+            }
+        }
+    }
+}
+
+TerrainVertex CompactTerrainMesh::Decode(const Patch& patch, int i) const {
+    const CompactTerrainVertex& packed = m_vertices[patch.firstVertex + i];
+    const int x = patch.x0 + i % patch.width;
+    const int z = patch.z0 + i / patch.width;
+    
+    TerrainVertex vertex;
+    vertex.position.x = (float)x - m_width * 0.5f;
+    vertex.position.y = m_heightMin + packed.height * m_heightStep;
+    vertex.position.z = (float)z - m_height * 0.5f;
+    vertex.texCoord.x = (float)x / (m_width - 1);
+    vertex.texCoord.y = (float)z / (m_height - 1);
+    vertex.normal = DecodeNormal(packed.normal);
+    vertex.color = TerrainPalette[packed.color];
+    return vertex;
+}
+
+TerrainVertex CompactTerrainMesh::DecodeAt(int x, int z) const {
+    const int step = PatchVertices - 1;
+    const int px = std::min(x / step, m_patchesX - 1);
+    const int pz = std::min(z / step, (int)(m_patches.size() / m_patchesX) - 1);
+    const Patch& patch = m_patches[(size_t)pz * m_patchesX + px];
+    return Decode(patch, (z - patch.z0) * patch.width + (x - patch.x0));
+}
+
+size_t CompactTerrainMesh::GetIndexCount() const {
+    size_t count = 0;
+    for (const Shape& shape : m_shapes) count += shape.indices.size();
+    return count;
+}
+
+size_t CompactTerrainMesh::GetMemoryBytes() const {
+    size_t bytes = m_vertices.capacity() * sizeof(CompactTerrainVertex) + m_patches.capacity() * sizeof(Patch);
+    for (const Shape& shape : m_shapes) bytes += shape.indices.capacity() * sizeof(uint16_t);
+    return bytes;
+}
+
+}
@@ -0,0 +1,279 @@
+#include "terrain/ContourExtractor.h"
+#include "core/WorkerPool.h"
+#include <algorithm>
+#include <cmath>
+#include <array>
+#include <cstring>
+
+namespace TS {
+
+namespace {
+
+// Crossing points and the (at most two) segments that meet at each
+struct ContourGraph {
+    std::vector<glm::vec2> points;
+    std::vector<std::array<int, 2>> links;
+    
+    int Add(float x, float z) {
+        points.emplace_back(x, z);
+        links.push_back({-1, -1});
+        return (int)points.size() - 1;
+    }
+    void Connect(int a, int b) {
+        links[a][links[a][0] < 0 ? 0 : 1] = b;
+        links[b][links[b][0] < 0 ? 0 : 1] = a;
+    }
+};
+
+// Open lines end on the grid border (one link); whatever is left over is closed loops
+void TracePolylines(const ContourGraph& graph, ContourLevel& out) {
+    const int count = (int)graph.points.size();
+    std::vector<uint8_t> visited(count, 0);
+    auto walk = [&](int start) {
+        out.starts.push_back((uint32_t)out.points.size());
+        int previous = -1, current = start;
+        while (current >= 0 && !visited[current]) {
+            visited[current] = 1;
+            out.points.push_back(graph.points[current]);
+            const std::array<int, 2>& next = graph.links[current];
+            int following = next[0] != previous ? next[0] : next[1];
+            previous = current;
+            current = following;
+        }
+        if (current == start) out.points.push_back(graph.points[start]);
+    };
+    for (int i = 0; i < count; ++i) {
+        if (!visited[i] && graph.links[i][1] < 0) walk(i);
+    }
+    for (int i = 0; i < count; ++i) {
+        if (!visited[i]) walk(i);
+    }
+}
+
+// Number of levels k in [first, last] with base + k * interval <= h. An edge or cell whose heights
+// span bands b0 < b1 is crossed by levels first + b0 .. first + b1 - 1. Elevations are recomputed
+// exactly as callers list them, so the comparisons agree with the per-level scan.
+inline int LevelBand(float h, float base, float interval, int first, int last) {
+    auto elevation = [&](int k) { return base + k * interval; };
+    int k = std::clamp((int)std::floor((h - base) / interval), first - 1, last);
+    while (k < last && elevation(k + 1) <= h) k++;
+    while (k >= first && elevation(k) > h) k--;
+    return k - first + 1;
+}
+
+// Crossing of the edge from height h0 at (x0, z0) to h1 one step along (dx, dz); the caller
+// has checked that the elevation lies between them
+inline int Crossing(ContourGraph& graph, float elevation, float h0, float h1, int x0, int z0, int dx, int dz) {
+    float t = (elevation - h0) / (h1 - h0);
+    return graph.Add(x0 + t * dx, z0 + t * dz);
+}
+
+}
+
+size_t ContourSet::PointCount() const {
+    size_t count = 0;
+    for (const ContourLevel& level : levels) count += level.points.size();
+    return count;
+}
+
+size_t ContourSet::PolylineCount() const {
+    size_t count = 0;
+    for (const ContourLevel& level : levels) count += level.starts.size();
+    return count;
+}
+
+void ContourExtractor::ExtractLevel(const float* heights, int width, int height, float elevation, ContourLevel& out) {
+    out.elevation = elevation;
+    out.points.clear();
+    out.starts.clear();
+    if (width < 2 || height < 2) return;
+    
+    ContourGraph graph;
+    // Crossings on the horizontal edges above and below the current row of cells, and which
+    // vertices of the two rows lie at or above the elevation
+    std::vector<int> top(width - 1), bottom(width - 1);
+    std::vector<uint8_t> above0(width), above1(width);
+    for (int x = 0; x < width; ++x) above0[x] = heights[x] >= elevation;
+    for (int x = 0; x < width - 1; ++x) {
+        top[x] = above0[x] != above0[x + 1] ? Crossing(graph, elevation, heights[x], heights[x + 1], x, 0, 1, 0) : -1;
+    }
+    
+    for (int z = 0; z < height - 1; ++z) {
+        const float* row0 = heights + (size_t)z * width;
+        const float* row1 = row0 + width;
+        for (int x = 0; x < width; ++x) above1[x] = row1[x] >= elevation;
+        int left = above0[0] != above1[0] ? Crossing(graph, elevation, row0[0], row1[0], 0, z, 0, 1) : -1;
+        
+        for (int x = 0; x < width - 1; ++x) {
+            // Most cells lie wholly above or below: nothing crosses them. Runs of eight are skipped
+            // when both rows' nine flags match (a window equal to itself shifted by one is uniform).
+            if (x + 8 < width) {
+                uint64_t top0, top1, bottom0, bottom1;
+                std::memcpy(&top0, &above0[x], sizeof(top0));
+                std::memcpy(&top1, &above0[x + 1], sizeof(top1));
+                std::memcpy(&bottom0, &above1[x], sizeof(bottom0));
+                std::memcpy(&bottom1, &above1[x + 1], sizeof(bottom1));
+                if (top0 == top1 && bottom0 == bottom1 && top0 == bottom0) {
+                    std::fill(&bottom[x], &bottom[x] + 8, -1);
+                    left = -1;
+                    x += 7;
+                    continue;
+                }
+            }
+            const int corners = above0[x] + above0[x + 1] + above1[x] + above1[x + 1];
+            if (corners == 0 || corners == 4) {
+                bottom[x] = -1;
+                left = -1;
+                continue;
+            }
+            
+            const float a = row0[x], b = row0[x + 1], c = row1[x + 1], d = row1[x];
+            int right = above0[x + 1] != above1[x + 1] ? Crossing(graph, elevation, b, c, x + 1, z, 0, 1) : -1;
+            bottom[x] = above1[x] != above1[x + 1] ? Crossing(graph, elevation, d, c, x, z + 1, 1, 0) : -1;
+            
+            const int edges = (top[x] >= 0) + (right >= 0) + (bottom[x] >= 0) + (left >= 0);
+            if (edges == 2) {
+                int ends[2], n = 0;
+                for (int edge : {top[x], right, bottom[x], left}) {
+                    if (edge >= 0) ends[n++] = edge;
+                }
+                graph.Connect(ends[0], ends[1]);
+            } else {
+                // Saddle: cut off the two corners on the other side of the cell centre
+                const bool centre = (a + b + c + d) * 0.25f >= elevation;
+                if ((a >= elevation) != centre) {
+                    graph.Connect(top[x], left);
+                    graph.Connect(right, bottom[x]);
+                } else {
+                    graph.Connect(top[x], right);
+                    graph.Connect(bottom[x], left);
+                }
+            }
+            left = right;
+        }
+        std::swap(top, bottom);
+        std::swap(above0, above1);
+    }
+    
+    TracePolylines(graph, out);
+}
+
+void ContourExtractor::Extract(const float* heights, int width, int height, const std::vector<float>& elevations,
+                               ContourSet& out, WorkerPool* workers) {
+    out.levels.resize(elevations.size());
+    auto extractLevels = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            ExtractLevel(heights, width, height, elevations[i], out.levels[i]);
+        }
+    };
+    
+    if (workers) {
+        workers->ParallelFor(elevations.size(), extractLevels);
+    } else {
+        extractLevels(0, elevations.size());
+    }
+}
+
+void ContourExtractor::ExtractLevelRange(const float* heights, int width, int height, float base, float interval,
+                                         int first, int last, ContourLevel* out) {
+    for (int k = first; k <= last; ++k) {
+        out[k - first].elevation = base + k * interval;
+        out[k - first].points.clear();
+        out[k - first].starts.clear();
+    }
+    if (width < 2 || height < 2 || first > last) return;
+    
+    // Each level keeps its own graph so tracing walks compact per-level arrays. An edge's
+    // crossings are added together and their ids stored consecutively: level k's point is
+    // ids[edge.id + (k - edge.first)]. Top edges were added on the previous row.
+    struct EdgeCrossings {
+        int id = -1, first = 0, last = -1;
+        int At(const std::vector<int>& ids, int k) const { return k >= first && k <= last ? ids[id + (k - first)] : -1; }
+    };
+    std::vector<ContourGraph> graphs(last - first + 1);
+    std::vector<int> previousIds, ids;
+    auto crossEdge = [&](std::vector<int>& into, float h0, float h1, int band0, int band1,
+                         int x0, int z0, int dx, int dz) {
+        EdgeCrossings edge;
+        if (band0 == band1) return edge;
+        edge.id = (int)into.size();
+        edge.first = first + std::min(band0, band1);
+        edge.last = first + std::max(band0, band1) - 1;
+        for (int k = edge.first; k <= edge.last; ++k) {
+            into.push_back(Crossing(graphs[k - first], base + k * interval, h0, h1, x0, z0, dx, dz));
+        }
+        return edge;
+    };
+    
+    std::vector<int> bands0(width), bands1(width);
+    for (int x = 0; x < width; ++x) bands0[x] = LevelBand(heights[x], base, interval, first, last);
+    std::vector<EdgeCrossings> top(width - 1), bottom(width - 1);
+    for (int x = 0; x < width - 1; ++x) {
+        top[x] = crossEdge(previousIds, heights[x], heights[x + 1], bands0[x], bands0[x + 1], x, 0, 1, 0);
+    }
+    
+    for (int z = 0; z < height - 1; ++z) {
+        const float* row0 = heights + (size_t)z * width;
+        const float* row1 = row0 + width;
+        for (int x = 0; x < width; ++x) bands1[x] = LevelBand(row1[x], base, interval, first, last);
+        ids.clear();
+        EdgeCrossings left = crossEdge(ids, row0[0], row1[0], bands0[0], bands1[0], 0, z, 0, 1);
+        
+        for (int x = 0; x < width - 1; ++x) {
+            // A cell whose corners share one band is crossed by no level
+            if (bands0[x] == bands0[x + 1] && bands1[x] == bands1[x + 1] && bands0[x] == bands1[x]) {
+                bottom[x] = left = EdgeCrossings();
+                continue;
+            }
+            const float a = row0[x], b = row0[x + 1], c = row1[x + 1], d = row1[x];
+            EdgeCrossings right = crossEdge(ids, b, c, bands0[x + 1], bands1[x + 1], x + 1, z, 0, 1);
+            bottom[x] = crossEdge(ids, d, c, bands1[x], bands1[x + 1], x, z + 1, 1, 0);
+            
+            // Only the levels between the cell's lowest and highest corner cross it
+            const int lowest = std::min(std::min(bands0[x], bands0[x + 1]), std::min(bands1[x], bands1[x + 1]));
+            const int highest = std::max(std::max(bands0[x], bands0[x + 1]), std::max(bands1[x], bands1[x + 1]));
+            for (int k = first + lowest; k < first + highest; ++k) {
+                ContourGraph& graph = graphs[k - first];
+                const float elevation = base + k * interval;
+                const int ends[4] = {top[x].At(previousIds, k), right.At(ids, k), bottom[x].At(ids, k), left.At(ids, k)};
+                const int edges = (ends[0] >= 0) + (ends[1] >= 0) + (ends[2] >= 0) + (ends[3] >= 0);
+                if (edges == 2) {
+                    int pair[2], n = 0;
+                    for (int end : ends) {
+                        if (end >= 0) pair[n++] = end;
+                    }
+                    graph.Connect(pair[0], pair[1]);
+                } else if ((a >= elevation) != ((a + b + c + d) * 0.25f >= elevation)) {
+                    // Saddle, split as in ExtractLevel
+                    graph.Connect(ends[0], ends[3]);
+                    graph.Connect(ends[1], ends[2]);
+                } else {
+                    graph.Connect(ends[0], ends[1]);
+                    graph.Connect(ends[2], ends[3]);
+                }
+            }
+            left = right;
+        }
+        std::swap(top, bottom);
+        std::swap(bands0, bands1);
+        std::swap(previousIds, ids);
+    }
+    
+    for (int k = first; k <= last; ++k) TracePolylines(graphs[k - first], out[k - first]);
+}
+
+void ContourExtractor::ExtractEvenlySpaced(const float* heights, int width, int height, float base, float interval,
+                                           int count, ContourSet& out, WorkerPool* workers) {
+    out.levels.resize(std::max(count, 0));
+    auto extractLevels = [&](size_t begin, size_t end) {
+        ExtractLevelRange(heights, width, height, base, interval, (int)begin, (int)end - 1, &out.levels[begin]);
+    };
+    
+    if (workers) {
+        workers->ParallelFor(out.levels.size(), extractLevels);
+    } else if (count > 0) {
+        extractLevels(0, out.levels.size());
+    }
+}
+
+}
@@ -0,0 +1,58 @@
+#include "terrain/FlowField.h"
+#include <algorithm>
+
+namespace TS {
+
+FlowFieldCache::FlowFieldCache(size_t capacity) : m_capacity(std::max<size_t>(capacity, 1)), m_useCounter(0) {}
+
+std::shared_ptr<const FlowField> FlowFieldCache::Find(Mobility mobility, int goalVertex, uint64_t revision) {
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [&](const Entry& entry) {
+        return entry.field->terrainRevision != revision;
+    }), m_entries.end());
+    for (Entry& entry : m_entries) {
+        if (entry.field->mobility == mobility && entry.field->goalVertex == goalVertex) {
+            entry.lastUse = ++m_useCounter;
+            return entry.field;
+        }
+    }
+    return nullptr;
+}
+
+void FlowFieldCache::Insert(std::shared_ptr<const FlowField> field) {
+    if (!field) return;
+    auto same = std::find_if(m_entries.begin(), m_entries.end(), [&](const Entry& entry) {
+        return entry.field->mobility == field->mobility && entry.field->goalVertex == field->goalVertex;
+    });
+    if (same != m_entries.end()) {
+        *same = {std::move(field), ++m_useCounter};
+        return;
+    }
+    if (m_entries.size() >= m_capacity) {
+        auto oldest = std::min_element(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) {
+            return a.lastUse < b.lastUse;
+        });
+        m_entries.erase(oldest);
+    }
+    m_entries.push_back({std::move(field), ++m_useCounter});
+}
+
+void FlowFieldCache::Clear() {
+    m_entries.clear();
+}
+
+std::vector<std::shared_ptr<const FlowField>> FlowFieldCache::GetFields() const {
+    std::vector<Entry> entries = m_entries;
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+    std::vector<std::shared_ptr<const FlowField>> fields;
+    fields.reserve(entries.size());
+    for (const Entry& entry : entries) fields.push_back(entry.field);
+    return fields;
+}
+
+size_t FlowFieldCache::GetMemoryBytes() const {
+    size_t bytes = 0;
+    for (const Entry& entry : m_entries) bytes += entry.field->GetMemoryBytes();
+    return bytes;
+}
+
+}
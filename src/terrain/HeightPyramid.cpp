@@ -0,0 +1,162 @@
+#include "terrain/HeightPyramid.h"
+#include "core/WorkerPool.h"
+#include <algorithm>
+#include <functional>
+
+namespace TS {
+
+HeightPyramid::HeightPyramid() : m_heights(nullptr), m_width(0), m_height(0), m_baseLevel(1) {}
+
+void HeightPyramid::Clear() {
+    m_heights = nullptr;
+    m_width = m_height = 0;
+    m_baseLevel = 1;
+    m_levels.clear();
+}
+
+void HeightPyramid::Build(const float* heights, int width, int height, WorkerPool* workers, int baseLevel) {
+    Clear();
+    if (!heights || width < 2 || height < 2) return;
+    m_heights = heights;
+    m_width = width;
+    m_height = height;
+    m_baseLevel = std::clamp(baseLevel, 1, 16);
+    
+    auto forRows = [&](size_t rows, const std::function<void(size_t, size_t)>& fn) {
+        if (workers) {
+            workers->ParallelFor(rows, fn);
+        } else {
+            fn(0, rows);
+        }
+    };
+    
+    // Base level straight from the heights: up to (2^L + 1)^2 vertices per node
+    const int size = 1 << m_baseLevel;
+    Level first;
+    first.nodesX = (width - 2 + size) >> m_baseLevel;   // ceil((width - 1) / size)
+    first.nodesZ = (height - 2 + size) >> m_baseLevel;
+    first.nodes.resize((size_t)first.nodesX * first.nodesZ);
+    forRows(first.nodesZ, [&](size_t begin, size_t end) {
+        for (size_t nz = begin; nz < end; ++nz) {
+            const int z0 = (int)nz * size;
+            const int z1 = std::min(z0 + size, height - 1);
+            Range* out = &first.nodes[nz * first.nodesX];
+            for (int nx = 0; nx < first.nodesX; ++nx) {
+                const int x0 = nx * size;
+                const int x1 = std::min(x0 + size, width - 1);
+                Range range{heights[(size_t)z0 * width + x0], heights[(size_t)z0 * width + x0]};
+                for (int z = z0; z <= z1; ++z) {
+                    const float* row = heights + (size_t)z * width;
+                    for (int x = x0; x <= x1; ++x) {
+                        range.min = std::min(range.min, row[x]);
+                        range.max = std::max(range.max, row[x]);
+                    }
+                }
+                out[nx] = range;
+            }
+        }
+    });
+    m_levels.push_back(std::move(first));
+    
+    // Each level up merges 2 x 2 children until one node covers the grid
+    while (m_levels.back().nodesX > 1 || m_levels.back().nodesZ > 1) {
+        const Level& child = m_levels.back();
+        Level parent;
+        parent.nodesX = (child.nodesX + 1) / 2;
+        parent.nodesZ = (child.nodesZ + 1) / 2;
+        parent.nodes.resize((size_t)parent.nodesX * parent.nodesZ);
+        forRows(parent.nodesZ, [&](size_t begin, size_t end) {
+            for (size_t nz = begin; nz < end; ++nz) {
+                const int cz0 = (int)nz * 2;
+                const int cz1 = std::min(cz0 + 1, child.nodesZ - 1);
+                for (int nx = 0; nx < parent.nodesX; ++nx) {
+                    const int cx0 = nx * 2;
+                    const int cx1 = std::min(cx0 + 1, child.nodesX - 1);
+                    Range range = child.nodes[(size_t)cz0 * child.nodesX + cx0];
+                    for (int cz = cz0; cz <= cz1; ++cz) {
+                        for (int cx = cx0; cx <= cx1; ++cx) {
+                            const Range& c = child.nodes[(size_t)cz * child.nodesX + cx];
+                            range.min = std::min(range.min, c.min);
+                            range.max = std::max(range.max, c.max);
+                        }
+                    }
+                    parent.nodes[nz * parent.nodesX + nx] = range;
+                }
+            }
+        });
+        m_levels.push_back(std::move(parent));
+    }
+}
+
+void HeightPyramid::Visit(int level, int nodeX, int nodeZ, const GridRect& rect, Range& out) const {
+    // Nodes inside the range found so far cannot widen it
+    const Range& node = GetNode(level, nodeX, nodeZ);
+    if (node.min >= out.min && node.max <= out.max) return;
+    
+    const int x0 = nodeX << level;
+    const int z0 = nodeZ << level;
+    const int x1 = std::min((nodeX + 1) << level, m_width - 1);
+    const int z1 = std::min((nodeZ + 1) << level, m_height - 1);
+    if (level == m_baseLevel) {
+        // Partly covered leaf: at most (2^L + 1)^2 vertices
+        for (int z = std::max(z0, rect.z0); z <= std::min(z1, rect.z1); ++z) {
+            const float* row = m_heights + (size_t)z * m_width;
+            for (int x = std::max(x0, rect.x0); x <= std::min(x1, rect.x1); ++x) {
+                out.min = std::min(out.min, row[x]);
+                out.max = std::max(out.max, row[x]);
+            }
+        }
+        return;
+    }
+    
+    // Children wholly inside the rectangle first, so their ranges prune the partial ones
+    const int child = level - 1;
+    const int cx0 = nodeX * 2, cx1 = std::min(cx0 + 1, GetNodesX(child) - 1);
+    const int cz0 = nodeZ * 2, cz1 = std::min(cz0 + 1, GetNodesZ(child) - 1);
+    int partial[4][2], partialCount = 0;
+    for (int cz = cz0; cz <= cz1; ++cz) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            const int vx0 = cx << child, vz0 = cz << child;
+            const int vx1 = std::min((cx + 1) << child, m_width - 1);
+            const int vz1 = std::min((cz + 1) << child, m_height - 1);
+            if (vx0 > rect.x1 || vz0 > rect.z1 || vx1 < rect.x0 || vz1 < rect.z0) continue;
+            if (vx0 >= rect.x0 && vx1 <= rect.x1 && vz0 >= rect.z0 && vz1 <= rect.z1) {
+                const Range& inside = GetNode(child, cx, cz);
+                out.min = std::min(out.min, inside.min);
+                out.max = std::max(out.max, inside.max);
+            } else {
+                partial[partialCount][0] = cx;
+                partial[partialCount++][1] = cz;
+            }
+        }
+    }
+    for (int i = 0; i < partialCount; ++i) Visit(child, partial[i][0], partial[i][1], rect, out);
+}
+
+bool HeightPyramid::RegionMinMax(const GridRect& rect, float& minHeight, float& maxHeight) const {
+    if (m_levels.empty()) return false;
+    GridRect clipped{std::max(rect.x0, 0), std::max(rect.z0, 0),
+                     std::min(rect.x1, m_width - 1), std::min(rect.z1, m_height - 1)};
+    if (clipped.x0 > clipped.x1 || clipped.z0 > clipped.z1) return false;
+    
+    // Descends only along the rectangle's border; whole nodes inside it are taken as they are
+    const float corner = m_heights[(size_t)clipped.z0 * m_width + clipped.x0];
+    Range range{corner, corner};
+    const int top = GetLevelCount();
+    if (clipped.x0 == 0 && clipped.z0 == 0 && clipped.x1 == m_width - 1 && clipped.z1 == m_height - 1) {
+        range = GetNode(top, 0, 0);
+    } else {
+        Visit(top, 0, 0, clipped, range);
+    }
+    minHeight = range.min;
+    maxHeight = range.max;
+    return true;
+}
+
+size_t HeightPyramid::GetMemoryBytes() const {
+    size_t bytes = 0;
+    for (const Level& level : m_levels) bytes += level.nodes.capacity() * sizeof(Range);
+    return bytes;
+}
+
+}
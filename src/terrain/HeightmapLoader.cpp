@@ -0,0 +1,398 @@
+#include "terrain/HeightmapLoader.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace TS {
+
+namespace {
+
+void ComputeRange(Heightmap& map) {
+    size_t count = (size_t)map.width * map.height;
+    float lo = std::numeric_limits<float>::max();
+    float hi = std::numeric_limits<float>::lowest();
+    for (size_t i = 0; i < count; ++i) {
+        lo = std::min(lo, map.data[i]);
+        hi = std::max(hi, map.data[i]);
+    }
+    map.minHeight = lo;
+    map.maxHeight = hi;
+    map.hasRange = true;
+}
+
+bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+void SkipSpace(const char*& p, const char* end) {
+    while (p < end && IsSpace(*p)) ++p;
+}
+
+void SkipToken(const char*& p, const char* end) {
+    SkipSpace(p, end);
+    while (p < end && !IsSpace(*p)) ++p;
+}
+
+// Decimal parser for grid values: strtof needs a terminated buffer and honours the locale,
+// neither of which suits a mapped file
+bool ParseFloat(const char*& p, const char* end, float& value) {
+    SkipSpace(p, end);
+    if (p >= end) return false;
+    
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        ++p;
+    }
+    
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p, ++digits) {
+        if (mantissa < 100000000000000000ull) mantissa = mantissa * 10 + (*p - '0');
+        else exponent++;
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, ++digits) {
+            if (mantissa < 100000000000000000ull) {
+                mantissa = mantissa * 10 + (*p - '0');
+                exponent--;
+            }
+        }
+    }
+    if (digits == 0) return false;
+    
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            ++p;
+        }
+        int e = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p) e = std::min(e * 10 + (*p - '0'), 400);
+        exponent += negativeExponent ? -e : e;
+    }
+    
+    double result = (double)mantissa;
+    if (exponent != 0) result *= std::pow(10.0, exponent);
+    value = (float)(negative ? -result : result);
+    return true;
+}
+
+}
+
+MappedFile::MappedFile() : m_data(nullptr), m_size(0) {
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+    
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    
+    void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps its own reference
+    if (mapped == MAP_FAILED) return false;
+    
+    m_data = static_cast<const uint8_t*>(mapped);
+    m_size = (size_t)info.st_size;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_data) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
+
+void MappedFile::AdviseSequential(size_t offset, size_t length) const {
+    if (!m_data || offset >= m_size) return;
+    
+    // madvise wants a page-aligned start
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t begin = offset / page * page;
+    size_t end = std::min(m_size, offset + length);
+    madvise(const_cast<uint8_t*>(m_data) + begin, end - begin, MADV_SEQUENTIAL);
+    madvise(const_cast<uint8_t*>(m_data) + begin, end - begin, MADV_WILLNEED);
+}
+
+void MappedFile::AdviseRandom(size_t offset, size_t length) const {
+    if (!m_data || offset >= m_size) return;
+    
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t begin = offset / page * page;
+    size_t end = std::min(m_size, offset + length);
+    madvise(const_cast<uint8_t*>(m_data) + begin, end - begin, MADV_RANDOM);
+}
+
+HeightmapFormat HeightmapLoader::FormatFromExtension(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    
+    if (extension == "r16" || extension == "raw") return HeightmapFormat::RAW_UINT16;
+    if (extension == "r32" || extension == "f32" || extension == "flt") return HeightmapFormat::RAW_FLOAT32;
+    if (extension == "asc") return HeightmapFormat::ESRI_ASCII;
+    return HeightmapFormat::AUTO;
+}
+
+bool HeightmapLoader::ResolveRawDimensions(size_t fileBytes, HeightmapFormat format, const HeightmapLoadOptions& options,
+                                           int& width, int& height) {
+    const size_t sampleSize = format == HeightmapFormat::RAW_UINT16 ? 2 : 4;
+    const size_t samples = fileBytes / sampleSize;
+    
+    width = options.width;
+    height = options.height;
+    if (width <= 0) {
+        width = (int)std::llround(std::sqrt((double)samples));
+        height = width;
+        if ((size_t)width * width != samples) {
+            std::cerr << "Raw heightmap is not square, dimensions required" << std::endl;
+            return false;
+        }
+    } else if (height <= 0) {
+        height = (int)(samples / width);
+    }
+    if ((size_t)width * height > samples) {
+        std::cerr << "Raw heightmap smaller than " << width << "x" << height << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool HeightmapLoader::ResolveWindow(const HeightmapLoadOptions& options, int fileWidth, int fileHeight,
+                                    int& x0, int& z0, int& width, int& height) {
+    x0 = std::max(0, options.windowX);
+    z0 = std::max(0, options.windowZ);
+    width = options.windowWidth > 0 ? options.windowWidth : fileWidth - x0;
+    height = options.windowHeight > 0 ? options.windowHeight : fileHeight - z0;
+    width = std::min(width, fileWidth - x0);
+    height = std::min(height, fileHeight - z0);
+    return width >= 2 && height >= 2;
+}
+
+size_t HeightmapLoader::PeakResidentBytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;          // Bytes on macOS
+#else
+    return (size_t)usage.ru_maxrss * 1024;   // Kilobytes on Linux
+#endif
+}
+
+bool HeightmapLoader::Load(const std::string& path, const HeightmapLoadOptions& options, Heightmap& out,
+                           HeightmapLoadStats* stats) {
+    HeightmapFormat format = options.format;
+    if (format == HeightmapFormat::AUTO) {
+        format = FormatFromExtension(path);
+    }
+    
+    HeightmapLoadStats local;
+    auto start = std::chrono::steady_clock::now();
+    
+    bool loaded = false;
+    switch (format) {
+        case HeightmapFormat::RAW_UINT16:
+        case HeightmapFormat::RAW_FLOAT32:
+            loaded = LoadRaw(path, format, options, out, local);
+            break;
+        case HeightmapFormat::ESRI_ASCII:
+            loaded = LoadEsriAscii(path, options, out, local);
+            break;
+        case HeightmapFormat::AUTO:
+            std::cerr << "Unrecognised heightmap format: " << path << std::endl;
+            return false;
+    }
+    if (!loaded) return false;
+    
+    local.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    local.peakResidentBytes = PeakResidentBytes();
+    if (stats) *stats = local;
+    return true;
+}
+
+bool HeightmapLoader::LoadRaw(const std::string& path, HeightmapFormat format, const HeightmapLoadOptions& options,
+                              Heightmap& out, HeightmapLoadStats& stats) {
+    auto file = std::make_unique<MappedFile>();
+    if (!file->Open(path)) {
+        std::cerr << "Cannot map heightmap: " << path << std::endl;
+        return false;
+    }
+    
+    const size_t sampleSize = format == HeightmapFormat::RAW_UINT16 ? 2 : 4;
+    int fileWidth, fileHeight;
+    if (!ResolveRawDimensions(file->GetSize(), format, options, fileWidth, fileHeight)) {
+        std::cerr << "Cannot size raw heightmap: " << path << std::endl;
+        return false;
+    }
+    
+    int x0, z0, width, height;
+    if (!ResolveWindow(options, fileWidth, fileHeight, x0, z0, width, height)) {
+        std::cerr << "Heightmap window is outside the file: " << path << std::endl;
+        return false;
+    }
+    
+    const size_t rowBytes = (size_t)fileWidth * sampleSize;
+    const size_t firstByte = (size_t)z0 * rowBytes;
+    // Read-ahead only pays off when whole rows are wanted; narrow windows touch a slice per row
+    if (width == fileWidth) {
+        file->AdviseSequential(firstByte, (size_t)height * rowBytes);
+    } else {
+        file->AdviseRandom(firstByte, (size_t)height * rowBytes);
+    }
+    
+    out.width = width;
+    out.height = height;
+    out.owned.clear();
+    stats.bytesRead = (size_t)width * height * sampleSize;
+    
+    // Host is little-endian (x86-64 and Apple silicon), so float rows can be used in place
+    if (format == HeightmapFormat::RAW_FLOAT32 && x0 == 0 && width == fileWidth) {
+        out.data = reinterpret_cast<const float*>(file->GetData() + firstByte);
+        out.mapping = std::move(file);
+        stats.zeroCopy = true;
+        out.hasRange = false;
+        return true;
+    }
+    
+    // Narrow windows and 16-bit samples are copied row by row; untouched rows are never paged in
+    out.owned.resize((size_t)width * height);
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* source = file->GetData() + (size_t)(z0 + row) * rowBytes + (size_t)x0 * sampleSize;
+        float* target = &out.owned[(size_t)row * width];
+        if (format == HeightmapFormat::RAW_FLOAT32) {
+            std::memcpy(target, source, (size_t)width * sizeof(float));
+        } else {
+            const uint16_t* samples16 = reinterpret_cast<const uint16_t*>(source);
+            for (int x = 0; x < width; ++x) {
+                target[x] = samples16[x] * options.heightScale;
+            }
+        }
+    }
+    
+    out.mapping.reset();
+    out.data = out.owned.data();
+    ComputeRange(out);
+    return true;
+}
+
+bool HeightmapLoader::LoadEsriAscii(const std::string& path, const HeightmapLoadOptions& options,
+                                    Heightmap& out, HeightmapLoadStats& stats) {
+    MappedFile file;
+    if (!file.Open(path)) {
+        std::cerr << "Cannot map heightmap: " << path << std::endl;
+        return false;
+    }
+    file.AdviseSequential(0, file.GetSize());
+    
+    const char* begin = reinterpret_cast<const char*>(file.GetData());
+    const char* end = begin + file.GetSize();
+    const char* p = begin;
+    
+    // Header: "key value" lines until the first numeric token
+    int fileWidth = 0, fileHeight = 0;
+    bool hasNoData = false;
+    float noData = 0.0f;
+    while (true) {
+        SkipSpace(p, end);
+        if (p >= end) break;
+        if ((*p >= '0' && *p <= '9') || *p == '-' || *p == '+' || *p == '.') break;
+        
+        const char* keyStart = p;
+        while (p < end && !IsSpace(*p)) ++p;
+        std::string key(keyStart, p);
+        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+        
+        float value = 0.0f;
+        if (!ParseFloat(p, end, value)) {
+            std::cerr << "Malformed ESRI grid header (" << key << "): " << path << std::endl;
+            return false;
+        }
+        if (key == "ncols") fileWidth = (int)value;
+        else if (key == "nrows") fileHeight = (int)value;
+        else if (key == "nodata_value") {
+            hasNoData = true;
+            noData = value;
+        }
+        // xllcorner/yllcorner/cellsize are accepted but the grid is always one unit per cell
+    }
+    
+    int x0, z0, width, height;
+    if (fileWidth < 2 || fileHeight < 2 || !ResolveWindow(options, fileWidth, fileHeight, x0, z0, width, height)) {
+        std::cerr << "ESRI grid missing dimensions or window outside it: " << path << std::endl;
+        return false;
+    }
+    
+    out.width = width;
+    out.height = height;
+    out.mapping.reset();
+    out.owned.assign((size_t)width * height, 0.0f);
+    
+    // Text cannot be seeked, so rows before the window are skipped token by token and
+    // parsing stops after the window's last row
+    bool sawNoData = false;
+    for (int z = 0; z < z0 + height; ++z) {
+        if (z < z0) {
+            for (int x = 0; x < fileWidth; ++x) SkipToken(p, end);
+            continue;
+        }
+        float* target = &out.owned[(size_t)(z - z0) * width];
+        for (int x = 0; x < fileWidth; ++x) {
+            if (x < x0 || x >= x0 + width) {
+                SkipToken(p, end);
+                continue;
+            }
+            float value;
+            if (!ParseFloat(p, end, value)) {
+                std::cerr << "ESRI grid truncated at row " << z << ": " << path << std::endl;
+                return false;
+            }
+            if (hasNoData && value == noData) {
+                value = std::numeric_limits<float>::quiet_NaN();
+                sawNoData = true;
+            }
+            target[x - x0] = value;
+        }
+    }
+    stats.bytesRead = (size_t)(p - begin);
+    
+    // Holes take the lowest valid height so they read as open ground rather than spikes
+    if (sawNoData) {
+        float lowest = std::numeric_limits<float>::max();
+        for (float h : out.owned) {
+            if (!std::isnan(h)) lowest = std::min(lowest, h);
+        }
+        if (lowest == std::numeric_limits<float>::max()) lowest = 0.0f;
+        for (float& h : out.owned) {
+            if (std::isnan(h)) h = lowest;
+        }
+    }
+    
+    out.data = out.owned.data();
+    ComputeRange(out);
+    return true;
+}
+
+}
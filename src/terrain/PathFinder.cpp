@@ -0,0 +1,567 @@
+#include "terrain/PathFinder.h"
+#include "core/WorkerPool.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+namespace TS {
+
+namespace {
+
+const float Infinity = std::numeric_limits<float>::infinity();
+const float Diagonal = 1.41421356f;
+// Step k moves by (StepX[k], StepZ[k]); Opposite[k] undoes it
+const int StepX[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+const int StepZ[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+const uint8_t Opposite[8] = {1, 0, 3, 2, 7, 6, 5, 4};
+
+// Every step costs at least its length, so octile distance never overestimates
+float Octile(int ax, int az, int bx, int bz) {
+    const int dx = std::abs(ax - bx), dz = std::abs(az - bz);
+    return (float)std::max(dx, dz) + (Diagonal - 1.0f) * (float)std::min(dx, dz);
+}
+
+using OpenEntry = std::pair<float, int>;
+using OpenList = std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>>;
+
+// Dijkstra, or A* when given a goal, over the vertices of one rectangle of a cost raster. The
+// rectangle is copied with a border of impassable vertices, so the inner loop needs no bounds
+// checks. Vertices are addressed by their index in the full raster.
+class RectSearch {
+public:
+    RectSearch(const float* cost, int width) : m_cost(cost), m_width(width), m_rect{0, 0, -1, -1}, m_paddedWidth(0) {}
+    
+    void SetRect(const GridRect& rect) {
+        if (rect.x0 == m_rect.x0 && rect.z0 == m_rect.z0 && rect.x1 == m_rect.x1 && rect.z1 == m_rect.z1) return;
+        m_rect = rect;
+        m_paddedWidth = rect.x1 - rect.x0 + 3;
+        const size_t count = (size_t)m_paddedWidth * (rect.z1 - rect.z0 + 3);
+        m_local.assign(count, Infinity);
+        for (int z = rect.z0; z <= rect.z1; ++z) {
+            std::copy(m_cost + (size_t)z * m_width + rect.x0, m_cost + (size_t)z * m_width + rect.x1 + 1,
+                      &m_local[Local(z * m_width + rect.x0)]);
+        }
+        m_g.resize(count);
+        m_parent.resize(count);
+        m_closed.resize(count);
+        // Steps in StepX/StepZ order; a diagonal needs both orthogonal steps it cuts past open
+        for (int k = 0; k < 8; ++k) m_offsets[k] = StepZ[k] * m_paddedWidth + StepX[k];
+        for (int k = 4; k < 8; ++k) {
+            m_sides[k - 4][0] = StepX[k];
+            m_sides[k - 4][1] = StepZ[k] * m_paddedWidth;
+        }
+    }
+    
+    // Settles vertices from source until goal is settled, or when goal < 0 until settled(vertex)
+    // returns true or the rectangle is exhausted. False when goal cannot be reached.
+    template<typename Settled>
+    bool Run(int source, int goal, Settled settled) {
+        std::fill(m_g.begin(), m_g.end(), Infinity);
+        std::fill(m_parent.begin(), m_parent.end(), -1);
+        std::fill(m_closed.begin(), m_closed.end(), 0);
+        const int localSource = Local(source);
+        const int localGoal = goal >= 0 ? Local(goal) : -1;
+        const int goalX = localGoal % m_paddedWidth, goalZ = localGoal / m_paddedWidth;
+        
+        OpenList open;
+        m_g[localSource] = 0.0f;
+        open.push({0.0f, localSource});
+        while (!open.empty()) {
+            const int v = open.top().second;
+            open.pop();
+            if (m_closed[v]) continue;
+            m_closed[v] = 1;
+            if (v == localGoal) return true;
+            if (localGoal < 0 && settled(Global(v))) return true;
+            
+            // Only the source can be impassable itself; leaving it costs what the next vertex does
+            const float own = m_local[v];
+            for (int k = 0; k < 8; ++k) {
+                const int n = v + m_offsets[k];
+                const float next = m_local[n];
+                if (std::isinf(next)) continue;
+                if (k >= 4 && (std::isinf(m_local[v + m_sides[k - 4][0]]) || std::isinf(m_local[v + m_sides[k - 4][1]]))) {
+                    continue;
+                }
+                const float step = (k < 4 ? 1.0f : Diagonal) * 0.5f * ((std::isinf(own) ? next : own) + next);
+                const float g = m_g[v] + step;
+                if (g < m_g[n]) {
+                    m_g[n] = g;
+                    m_parent[n] = v;
+                    float priority = g;
+                    if (localGoal >= 0) priority += Octile(n % m_paddedWidth, n / m_paddedWidth, goalX, goalZ);
+                    open.push({priority, n});
+                }
+            }
+        }
+        return localGoal < 0;
+    }
+    
+    float GetCost(int vertex) const { return m_g[Local(vertex)]; }
+    
+    // Vertices after the source up to and including vertex, appended in walking order
+    void AppendPath(int vertex, std::vector<int>& out) const {
+        const size_t first = out.size();
+        for (int v = Local(vertex); m_parent[v] >= 0; v = m_parent[v]) out.push_back(Global(v));
+        std::reverse(out.begin() + first, out.end());
+    }
+    // The same path walked back: the vertices after vertex up to and including the source
+    void AppendPathToSource(int vertex, std::vector<int>& out) const {
+        for (int v = m_parent[Local(vertex)]; v >= 0; v = m_parent[v]) out.push_back(Global(v));
+    }
+    // For every vertex of the rectangle, row-major, the step code back toward the source along
+    // the tree; NoDirection at the source and wherever the search did not reach
+    void ExportDirections(std::vector<uint8_t>& out) const {
+        const int width = m_rect.x1 - m_rect.x0 + 1;
+        out.assign((size_t)width * (m_rect.z1 - m_rect.z0 + 1), FlowField::NoDirection);
+        for (int z = m_rect.z0; z <= m_rect.z1; ++z) {
+            uint8_t* row = &out[(size_t)(z - m_rect.z0) * width];
+            const int first = Local(z * m_width + m_rect.x0);
+            for (int x = 0; x < width; ++x) {
+                const int parent = m_parent[first + x];
+                if (parent < 0) continue;
+                const int k = (int)(std::find(m_offsets, m_offsets + 8, first + x - parent) - m_offsets);
+                row[x] = Opposite[k];
+            }
+        }
+    }
+    // The path from the source to vertex as step codes
+    void AppendSteps(int vertex, std::vector<uint8_t>& out) const {
+        const size_t first = out.size();
+        for (int v = Local(vertex); m_parent[v] >= 0; v = m_parent[v]) {
+            out.push_back((uint8_t)(std::find(m_offsets, m_offsets + 8, v - m_parent[v]) - m_offsets));
+        }
+        std::reverse(out.begin() + first, out.end());
+    }
+    
+private:
+    const float* m_cost;
+    int m_width;
+    GridRect m_rect;
+    int m_paddedWidth;
+    int m_offsets[8];
+    int m_sides[4][2];
+    std::vector<float> m_local;
+    std::vector<float> m_g;
+    std::vector<int> m_parent;
+    std::vector<uint8_t> m_closed;
+    
+    int Local(int vertex) const {
+        return (vertex / m_width - m_rect.z0 + 1) * m_paddedWidth + (vertex % m_width - m_rect.x0 + 1);
+    }
+    int Global(int local) const {
+        return (local / m_paddedWidth - 1 + m_rect.z0) * m_width + (local % m_paddedWidth - 1 + m_rect.x0);
+    }
+};
+
+// Per-thread search state over the abstract graph, sized once and reset by bumping generation
+struct AbstractScratch {
+    std::vector<float> g;
+    std::vector<int> parent;
+    std::vector<uint32_t> seen, closed;
+    uint32_t generation = 0;
+};
+
+}
+
+PathFinder::PathFinder()
+    : m_width(0), m_height(0), m_clusterSize(DefaultClusterSize), m_clustersX(0), m_clustersZ(0) {}
+
+int PathFinder::ClusterOf(int vertex) const {
+    return (vertex / m_width) / m_clusterSize * m_clustersX + (vertex % m_width) / m_clusterSize;
+}
+
+GridRect PathFinder::ClusterRect(int cluster) const {
+    const int x0 = cluster % m_clustersX * m_clusterSize;
+    const int z0 = cluster / m_clustersX * m_clusterSize;
+    return {x0, z0, std::min(x0 + m_clusterSize, m_width) - 1, std::min(z0 + m_clusterSize, m_height) - 1};
+}
+
+int PathFinder::NearestVertex(const glm::vec3& position) const {
+    const int x = std::clamp((int)std::lround(position.x + m_width * 0.5f), 0, m_width - 1);
+    const int z = std::clamp((int)std::lround(position.z + m_height * 0.5f), 0, m_height - 1);
+    return z * m_width + x;
+}
+
+void PathFinder::Build(std::shared_ptr<const TerrainRasters> rasters, int clusterSize, WorkerPool* workers) {
+    m_rasters = std::move(rasters);
+    for (Graph& graph : m_graphs) graph = Graph();
+    if (IsEmpty()) return;
+    m_width = m_rasters->GetWidth();
+    m_height = m_rasters->GetHeight();
+    m_clusterSize = std::clamp(clusterSize, 2, 255);  // Region labels are 16-bit
+    m_clustersX = (m_width + m_clusterSize - 1) / m_clusterSize;
+    m_clustersZ = (m_height + m_clusterSize - 1) / m_clusterSize;
+    for (int m = 0; m < MobilityCount; ++m) BuildGraph((Mobility)m, workers);
+}
+
+void PathFinder::BuildGraph(Mobility mobility, WorkerPool* workers) {
+    const float* cost = m_rasters->GetCost(mobility).data();
+    const int width = m_width, size = m_clusterSize;
+    Graph& graph = m_graphs[(int)mobility];
+    
+    // Passable regions of each cluster (4-connected; a diagonal step needs both sides it cuts
+    // past open, so it never links regions that are not already touching)
+    const int clusterCount = m_clustersX * m_clustersZ;
+    std::vector<uint16_t> region((size_t)width * m_height, 0);
+    auto labelClusters = [&](size_t begin, size_t end) {
+        std::vector<int> stack;
+        for (size_t c = begin; c < end; ++c) {
+            const GridRect rect = ClusterRect((int)c);
+            uint16_t next = 0;
+            for (int z = rect.z0; z <= rect.z1; ++z) {
+                for (int x = rect.x0; x <= rect.x1; ++x) {
+                    const int seed = z * width + x;
+                    if (std::isinf(cost[seed]) || region[seed]) continue;
+                    region[seed] = ++next;
+                    stack.push_back(seed);
+                    while (!stack.empty()) {
+                        const int v = stack.back();
+                        stack.pop_back();
+                        const int vx = v % width, vz = v / width;
+                        for (int k = 0; k < 4; ++k) {
+                            const int nx = vx + StepX[k], nz = vz + StepZ[k];
+                            if (nx < rect.x0 || nx > rect.x1 || nz < rect.z0 || nz > rect.z1) continue;
+                            const int n = nz * width + nx;
+                            if (std::isinf(cost[n]) || region[n]) continue;
+                            region[n] = next;
+                            stack.push_back(n);
+                        }
+                    }
+                }
+            }
+        }
+    };
+    if (workers) {
+        workers->ParallelFor((size_t)clusterCount, labelClusters);
+    } else {
+        labelClusters(0, (size_t)clusterCount);
+    }
+    
+    // Entrances: a node on each side of every transition, shared where borders meet
+    std::unordered_map<int, int> nodeOf;
+    std::vector<std::pair<int, int>> transitions;
+    auto addNode = [&](int vertex) {
+        auto [it, inserted] = nodeOf.emplace(vertex, (int)graph.nodes.size());
+        if (inserted) graph.nodes.push_back(vertex);
+        return it->second;
+    };
+    auto addTransition = [&](std::pair<int, int> across) {
+        transitions.push_back({addNode(across.first), addNode(across.second)});
+    };
+    // pairAt(i) gives the two vertices facing each other across the border at position i. Runs
+    // joining the same pair of regions are interchangeable, so only the longest one of each pair
+    // becomes a transition; rough ground splits borders into many such short runs.
+    struct Run {
+        uint16_t regionA, regionB;
+        int first, last;
+    };
+    std::vector<Run> runs;
+    auto scanBorder = [&](int begin, int end, auto pairAt) {
+        runs.clear();
+        int runStart = -1;
+        for (int i = begin; i <= end; ++i) {
+            bool open = false;
+            if (i < end) {
+                auto [a, b] = pairAt(i);
+                open = !std::isinf(cost[a]) && !std::isinf(cost[b]);
+            }
+            if (open && runStart < 0) runStart = i;
+            if (!open && runStart >= 0) {
+                auto [a, b] = pairAt(runStart);
+                Run run{region[a], region[b], runStart, i - 1};
+                auto same = std::find_if(runs.begin(), runs.end(), [&](const Run& r) {
+                    return r.regionA == run.regionA && r.regionB == run.regionB;
+                });
+                if (same == runs.end()) {
+                    runs.push_back(run);
+                } else if (run.last - run.first > same->last - same->first) {
+                    *same = run;
+                }
+                runStart = -1;
+            }
+        }
+        for (const Run& run : runs) addTransition(pairAt((run.first + run.last) / 2));
+    };
+    for (int cx = 0; cx + 1 < m_clustersX; ++cx) {
+        const int x = (cx + 1) * size - 1;
+        for (int cz = 0; cz < m_clustersZ; ++cz) {
+            scanBorder(cz * size, std::min((cz + 1) * size, m_height),
+                       [&](int z) { return std::make_pair(z * width + x, z * width + x + 1); });
+        }
+    }
+    for (int cz = 0; cz + 1 < m_clustersZ; ++cz) {
+        const int z = (cz + 1) * size - 1;
+        for (int cx = 0; cx < m_clustersX; ++cx) {
+            scanBorder(cx * size, std::min((cx + 1) * size, m_width),
+                       [&](int x) { return std::make_pair(z * width + x, (z + 1) * width + x); });
+        }
+    }
+    
+    // Group the nodes by cluster, keeping node order within each
+    const size_t nodeCount = graph.nodes.size();
+    graph.nodeCluster.resize(nodeCount);
+    graph.clusterFirst.assign(clusterCount + 1, 0);
+    for (size_t n = 0; n < nodeCount; ++n) {
+        graph.nodeCluster[n] = ClusterOf(graph.nodes[n]);
+        graph.clusterFirst[graph.nodeCluster[n] + 1]++;
+    }
+    for (int c = 0; c < clusterCount; ++c) graph.clusterFirst[c + 1] += graph.clusterFirst[c];
+    graph.clusterNodes.resize(nodeCount);
+    std::vector<uint32_t> fill(graph.clusterFirst.begin(), graph.clusterFirst.end() - 1);
+    for (size_t n = 0; n < nodeCount; ++n) graph.clusterNodes[fill[graph.nodeCluster[n]]++] = (int)n;
+    
+    std::vector<std::vector<Edge>> adjacency(nodeCount);
+    for (const auto& [a, b] : transitions) {
+        const float step = 0.5f * (cost[graph.nodes[a]] + cost[graph.nodes[b]]);
+        adjacency[a].push_back({b, step, 0, 0, false});
+        adjacency[b].push_back({a, step, 0, 0, false});
+    }
+    
+    // Costs are symmetric, so one Dijkstra per entrance settles every later entrance of its
+    // cluster, and each path is stored once and walked backwards the other way. Each cluster
+    // only writes its own nodes' lists and its own steps, offset once they are merged below.
+    std::vector<std::vector<uint8_t>> clusterSteps(clusterCount);
+    auto connectClusters = [&](size_t begin, size_t end) {
+        RectSearch search(cost, width);
+        for (size_t c = begin; c < end; ++c) {
+            const int* local = &graph.clusterNodes[graph.clusterFirst[c]];
+            const int count = (int)(graph.clusterFirst[c + 1] - graph.clusterFirst[c]);
+            if (count < 2) continue;
+            search.SetRect(ClusterRect((int)c));
+            std::vector<uint8_t>& steps = clusterSteps[c];
+            for (int i = 0; i + 1 < count; ++i) {
+                int remaining = count - 1 - i;
+                search.Run(graph.nodes[local[i]], -1, [&](int vertex) {
+                    for (int j = i + 1; j < count; ++j) {
+                        if (graph.nodes[local[j]] == vertex) return --remaining == 0;
+                    }
+                    return false;
+                });
+                for (int j = i + 1; j < count; ++j) {
+                    const float pathCost = search.GetCost(graph.nodes[local[j]]);
+                    if (std::isinf(pathCost)) continue;
+                    const uint32_t firstStep = (uint32_t)steps.size();
+                    search.AppendSteps(graph.nodes[local[j]], steps);
+                    const uint16_t stepCount = (uint16_t)(steps.size() - firstStep);
+                    adjacency[local[i]].push_back({local[j], pathCost, firstStep, stepCount, false});
+                    adjacency[local[j]].push_back({local[i], pathCost, firstStep, stepCount, true});
+                }
+            }
+        }
+    };
+    if (workers) {
+        workers->ParallelFor((size_t)clusterCount, connectClusters);
+    } else {
+        connectClusters(0, (size_t)clusterCount);
+    }
+    
+    std::vector<uint32_t> stepBase(clusterCount, 0);
+    for (int c = 0; c < clusterCount; ++c) {
+        stepBase[c] = (uint32_t)graph.steps.size();
+        graph.steps.insert(graph.steps.end(), clusterSteps[c].begin(), clusterSteps[c].end());
+    }
+    graph.firstEdge.resize(nodeCount + 1);
+    graph.firstEdge[0] = 0;
+    for (size_t n = 0; n < nodeCount; ++n) {
+        graph.firstEdge[n + 1] = graph.firstEdge[n] + (uint32_t)adjacency[n].size();
+        for (Edge edge : adjacency[n]) {
+            edge.firstStep += stepBase[graph.nodeCluster[n]];
+            graph.edges.push_back(edge);
+        }
+    }
+}
+
+bool PathFinder::FindPath(Mobility mobility, const glm::vec3& from, const glm::vec3& to,
+                          std::vector<glm::vec3>& waypoints, float* cost) const {
+    waypoints.clear();
+    if (IsEmpty()) return false;
+    const float* costs = m_rasters->GetCost(mobility).data();
+    const Graph& graph = m_graphs[(int)mobility];
+    const int start = NearestVertex(from), goal = NearestVertex(to);
+    if (std::isinf(costs[goal])) return false;
+    
+    // Start and goal join the abstract graph as two extra nodes, linked to the entrances of
+    // their clusters (and to each other when they share one) by a Dijkstra inside the cluster.
+    // Both searches are kept: their trees are the first and last legs of the path.
+    const int nodeCount = (int)graph.nodes.size();
+    const int startNode = nodeCount, goalNode = nodeCount + 1;
+    const int startCluster = ClusterOf(start), goalCluster = ClusterOf(goal);
+    auto connect = [&](RectSearch& search, int vertex, int cluster, bool withGoal, std::vector<Edge>& out) {
+        const int* local = &graph.clusterNodes[graph.clusterFirst[cluster]];
+        const int count = (int)(graph.clusterFirst[cluster + 1] - graph.clusterFirst[cluster]);
+        int remaining = count + (withGoal ? 1 : 0);
+        search.SetRect(ClusterRect(cluster));
+        search.Run(vertex, -1, [&](int v) {
+            if (withGoal && v == goal) return --remaining == 0;
+            for (int j = 0; j < count; ++j) {
+                if (graph.nodes[local[j]] == v) return --remaining == 0;
+            }
+            return false;
+        });
+        for (int j = 0; j < count; ++j) {
+            const float c = search.GetCost(graph.nodes[local[j]]);
+            if (!std::isinf(c)) out.push_back({local[j], c, 0, 0, false});
+        }
+        if (withGoal && !std::isinf(search.GetCost(goal))) out.push_back({goalNode, search.GetCost(goal), 0, 0, false});
+    };
+    RectSearch startSearch(costs, m_width), goalSearch(costs, m_width);
+    std::vector<Edge> startEdges, goalEdges;
+    connect(startSearch, start, startCluster, startCluster == goalCluster, startEdges);
+    connect(goalSearch, goal, goalCluster, false, goalEdges);
+    
+    thread_local AbstractScratch scratch;
+    const size_t scratchSize = (size_t)nodeCount + 2;
+    if (scratch.g.size() < scratchSize) {
+        scratch.g.resize(scratchSize);
+        scratch.parent.resize(scratchSize);
+        scratch.seen.assign(scratchSize, 0);
+        scratch.closed.assign(scratchSize, 0);
+    }
+    if (++scratch.generation == 0) {
+        std::fill(scratch.seen.begin(), scratch.seen.end(), 0);
+        std::fill(scratch.closed.begin(), scratch.closed.end(), 0);
+        scratch.generation = 1;
+    }
+    const uint32_t generation = scratch.generation;
+    
+    auto vertexOf = [&](int node) {
+        return node < nodeCount ? graph.nodes[node] : (node == startNode ? start : goal);
+    };
+    const int goalX = goal % m_width, goalZ = goal / m_width;
+    OpenList open;
+    auto relax = [&](int from, int node, float g) {
+        if (scratch.seen[node] == generation && g >= scratch.g[node]) return;
+        scratch.seen[node] = generation;
+        scratch.g[node] = g;
+        scratch.parent[node] = from;
+        const int v = vertexOf(node);
+        open.push({g + Octile(v % m_width, v / m_width, goalX, goalZ), node});
+    };
+    relax(-1, startNode, 0.0f);
+    bool found = false;
+    while (!open.empty()) {
+        const int node = open.top().second;
+        open.pop();
+        if (scratch.closed[node] == generation) continue;
+        scratch.closed[node] = generation;
+        if (node == goalNode) {
+            found = true;
+            break;
+        }
+        const float g = scratch.g[node];
+        if (node == startNode) {
+            for (const Edge& e : startEdges) relax(node, e.to, g + e.cost);
+            continue;
+        }
+        for (uint32_t e = graph.firstEdge[node]; e < graph.firstEdge[node + 1]; ++e) {
+            relax(node, graph.edges[e].to, g + graph.edges[e].cost);
+        }
+        if (graph.nodeCluster[node] == goalCluster) {
+            for (const Edge& e : goalEdges) {
+                if (e.to == node) relax(node, goalNode, g + e.cost);
+            }
+        }
+    }
+    if (!found) return false;
+    
+    // Unpack the route: the first and last legs from the cluster searches, hops between
+    // entrances from their stored steps, border crossings as the single step they are
+    std::vector<int> route;
+    for (int node = goalNode; node >= 0; node = scratch.parent[node]) route.push_back(node);
+    std::reverse(route.begin(), route.end());
+    std::vector<int> vertices{start};
+    for (size_t i = 0; i + 1 < route.size(); ++i) {
+        const int a = route[i], b = route[i + 1];
+        if (a == startNode) {
+            startSearch.AppendPath(vertexOf(b), vertices);
+            continue;
+        }
+        if (b == goalNode) {
+            goalSearch.AppendPathToSource(vertexOf(a), vertices);
+            continue;
+        }
+        const Edge* edge = &graph.edges[graph.firstEdge[a]];
+        while (edge->to != b) ++edge;
+        if (edge->stepCount == 0) {
+            vertices.push_back(vertexOf(b));
+            continue;
+        }
+        const uint8_t* steps = &graph.steps[edge->firstStep];
+        int v = vertexOf(a);
+        for (int s = 0; s < edge->stepCount; ++s) {
+            const uint8_t k = edge->reversed ? Opposite[steps[edge->stepCount - 1 - s]] : steps[s];
+            v += StepZ[k] * m_width + StepX[k];
+            vertices.push_back(v);
+        }
+    }
+    if (cost) *cost = scratch.g[goalNode];
+    ToWaypoints(vertices, to, waypoints);
+    return true;
+}
+
+bool PathFinder::BuildFlowField(Mobility mobility, const glm::vec3& goal, FlowField& field) const {
+    field = FlowField();
+    if (IsEmpty()) return false;
+    const float* costs = m_rasters->GetCost(mobility).data();
+    const int vertex = NearestVertex(goal);
+    if (std::isinf(costs[vertex])) return false;
+    
+    // Costs are symmetric, so the tree of cheapest paths out of the goal holds the cheapest
+    // way back to it from everywhere
+    RectSearch search(costs, m_width);
+    search.SetRect(GridRect{0, 0, m_width - 1, m_height - 1});
+    search.Run(vertex, -1, [](int) { return false; });
+    field.width = m_width;
+    field.height = m_height;
+    field.goalVertex = vertex;
+    field.mobility = mobility;
+    field.terrainRevision = GetRevision();
+    search.ExportDirections(field.directions);
+    return true;
+}
+
+bool PathFinder::FindGridPath(Mobility mobility, const glm::vec3& from, const glm::vec3& to,
+                              std::vector<glm::vec3>& waypoints, float* cost) const {
+    waypoints.clear();
+    if (IsEmpty()) return false;
+    const int start = NearestVertex(from), goal = NearestVertex(to);
+    RectSearch search(m_rasters->GetCost(mobility).data(), m_width);
+    search.SetRect(GridRect{0, 0, m_width - 1, m_height - 1});
+    if (!search.Run(start, goal, [](int) { return false; })) return false;
+    
+    std::vector<int> vertices{start};
+    search.AppendPath(goal, vertices);
+    if (cost) *cost = search.GetCost(goal);
+    ToWaypoints(vertices, to, waypoints);
+    return true;
+}
+
+void PathFinder::ToWaypoints(const std::vector<int>& vertices, const glm::vec3& to,
+                             std::vector<glm::vec3>& waypoints) const {
+    // Keep only the vertices where the direction changes; the last one is replaced by to itself
+    for (size_t i = 1; i + 1 < vertices.size(); ++i) {
+        const int in = vertices[i] - vertices[i - 1];
+        const int out = vertices[i + 1] - vertices[i];
+        if (in == out) continue;
+        const int x = vertices[i] % m_width, z = vertices[i] / m_width;
+        waypoints.push_back(glm::vec3(x - m_width * 0.5f, to.y, z - m_height * 0.5f));
+    }
+    waypoints.push_back(to);
+}
+
+size_t PathFinder::GetMemoryBytes() const {
+    size_t bytes = 0;
+    for (const Graph& graph : m_graphs) {
+        bytes += (graph.nodes.capacity() + graph.nodeCluster.capacity() + graph.clusterNodes.capacity()) * sizeof(int);
+        bytes += (graph.firstEdge.capacity() + graph.clusterFirst.capacity()) * sizeof(uint32_t);
+        bytes += graph.edges.capacity() * sizeof(Edge) + graph.steps.capacity();
+    }
+    return bytes;
+}
+
+}
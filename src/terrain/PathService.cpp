@@ -0,0 +1,114 @@
+#include "terrain/PathService.h"
+#include <algorithm>
+
+namespace TS {
+
+PathService::PathService(int threadCount) : m_nextTicket(1), m_stopping(false) {
+    int threads = std::max(threadCount, 1);
+    m_threads.reserve(threads);
+    for (int i = 0; i < threads; ++i) {
+        m_threads.emplace_back(&PathService::WorkerLoop, this);
+    }
+}
+
+PathService::~PathService() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+uint64_t PathService::Submit(std::shared_ptr<const PathFinder> finder, Mobility mobility,
+                             const glm::vec3& from, const glm::vec3& to) {
+    return Enqueue({0, std::move(finder), mobility, from, to, false, nullptr});
+}
+
+uint64_t PathService::SubmitFlowField(std::shared_ptr<const PathFinder> finder, Mobility mobility, const glm::vec3& to) {
+    return Enqueue({0, std::move(finder), mobility, to, to, true, nullptr});
+}
+
+uint64_t PathService::SubmitPathFinder(std::shared_ptr<const TerrainRasters> rasters) {
+    Job job{};
+    job.rasters = std::move(rasters);
+    return Enqueue(std::move(job));
+}
+
+uint64_t PathService::Enqueue(Job job) {
+    uint64_t ticket;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ticket = job.ticket = m_nextTicket++;
+        m_queue.push_back(std::move(job));
+    }
+    m_wake.notify_one();
+    return ticket;
+}
+
+bool PathService::IsReady(uint64_t ticket) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_results.count(ticket) != 0;
+}
+
+PathResult PathService::Take(uint64_t ticket) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [&] { return m_results.count(ticket) != 0; });
+    auto it = m_results.find(ticket);
+    PathResult result = std::move(it->second);
+    m_results.erase(it);
+    return result;
+}
+
+void PathService::Discard(uint64_t ticket) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_results.erase(ticket)) return;
+    auto queued = std::find_if(m_queue.begin(), m_queue.end(), [ticket](const Job& job) { return job.ticket == ticket; });
+    if (queued != m_queue.end()) {
+        m_queue.erase(queued);
+    } else {
+        m_discarded.insert(ticket);
+    }
+}
+
+size_t PathService::GetQueuedCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size();
+}
+
+void PathService::WorkerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_stopping) return;
+            job = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        
+        PathResult result;
+        if (job.rasters) {
+            auto finder = std::make_shared<PathFinder>();
+            finder->Build(job.rasters);
+            result.found = !finder->IsEmpty();
+            result.finder = std::move(finder);
+        } else if (job.finder && job.flowField) {
+            auto field = std::make_shared<FlowField>();
+            result.found = job.finder->BuildFlowField(job.mobility, job.to, *field);
+            if (result.found) result.flowField = std::move(field);
+        } else if (job.finder) {
+            result.found = job.finder->FindPath(job.mobility, job.from, job.to, result.waypoints, &result.cost);
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_discarded.erase(job.ticket)) m_results.emplace(job.ticket, std::move(result));
+        }
+        m_done.notify_all();
+    }
+}
+
+}
@@ -1,35 +1,224 @@
 #include "terrain/TerrainEngine.h"
-#include <OpenGL/gl.h>
+#include "terrain/TerrainGenerator.h"
+#include "terrain/TerrainLOD.h"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
 #include <random>
+#include <limits>
 #include <ctime>
 #include <unistd.h>  // for getpid()
 
 namespace TS {
 
+namespace {
+
+// Pyramid base over mapped grids: 8 x 8 cell leaves keep it at 1/32 of the grid instead of half,
+// in anonymous memory that cannot be paged back to the file
+const int MappedPyramidBaseLevel = 3;
+
+// Height accessors for the templated queries: one over the in-memory grid, one over the tile cache
+struct DenseHeights {
+    const float* data;
+    int width;
+    
+    float At(int x, int z) const { return data[(size_t)z * width + x]; }
+    void Cell(int x, int z, float h[4]) const {
+        const float* row0 = &data[(size_t)z * width + x];
+        const float* row1 = row0 + width;
+        h[0] = row0[0];
+        h[1] = row0[1];
+        h[2] = row1[0];
+        h[3] = row1[1];
+    }
+};
+
+// Lookups that do not pull whole tiles into the cache, for isolated samples
+struct SampledHeights {
+    const TileStore* store;
+    
+    float At(int x, int z) const { return store->Sample(x, z); }
+    void Cell(int x, int z, float h[4]) const {
+        h[0] = store->Sample(x, z);
+        h[1] = store->Sample(x + 1, z);
+        h[2] = store->Sample(x, z + 1);
+        h[3] = store->Sample(x + 1, z + 1);
+    }
+};
+
+struct TiledHeights {
+    TileStore::Reader reader;
+    
+    float At(int x, int z) { return reader.At(x, z); }
+    void Cell(int x, int z, float h[4]) { reader.Cell(x, z, h); }
+};
+
+// Ray in grid space (vertex (i, j) at x = i, z = j), with 1 / direction for the slab tests
+struct GridRay {
+    glm::vec3 origin, direction, inverse;
+};
+
+// Narrows [t0, t1] to the part of the ray inside the box; false when nothing is left
+inline bool ClipToBox(const GridRay& ray, const glm::vec3& lo, const glm::vec3& hi, float& t0, float& t1) {
+    for (int axis = 0; axis < 3; ++axis) {
+        const float origin = axis == 0 ? ray.origin.x : axis == 1 ? ray.origin.y : ray.origin.z;
+        const float delta = axis == 0 ? ray.direction.x : axis == 1 ? ray.direction.y : ray.direction.z;
+        const float inverse = axis == 0 ? ray.inverse.x : axis == 1 ? ray.inverse.y : ray.inverse.z;
+        const float a = axis == 0 ? lo.x : axis == 1 ? lo.y : lo.z;
+        const float b = axis == 0 ? hi.x : axis == 1 ? hi.y : hi.z;
+        if (delta == 0.0f) {
+            if (origin < a || origin > b) return false;
+            continue;
+        }
+        float ta = (a - origin) * inverse;
+        float tb = (b - origin) * inverse;
+        if (ta > tb) std::swap(ta, tb);
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+    }
+    return t0 <= t1;
+}
+
+// Smallest t in [t0, t1] (the ray's span over cell (x, z)) at which it is on or below the cell's
+// bilinear surface. Along the ray that surface is quadratic in t, so this is a root of
+// ray height - surface height, taken relative to t0 to keep the coefficients small.
+template<typename Heights>
+bool IntersectCell(Heights& heights, int x, int z, const GridRay& ray, float t0, float t1, float& tHit) {
+    float h[4];
+    heights.Cell(x, z, h);
+    const double a = h[1] - h[0], b = h[2] - h[0], c = (double)h[0] - h[1] - h[2] + h[3];
+    const double du = ray.direction.x, dv = ray.direction.z;
+    const double u = ray.origin.x + du * t0 - x;
+    const double v = ray.origin.z + dv * t0 - z;
+    
+    const double c0 = ray.origin.y + (double)ray.direction.y * t0 - (h[0] + a * u + b * v + c * u * v);
+    if (c0 <= 0.0) {
+        tHit = t0;
+        return true;
+    }
+    const double c1 = ray.direction.y - (a * du + b * dv + c * (u * dv + v * du));
+    const double c2 = -c * du * dv;
+    const double span = (double)t1 - t0;
+    
+    double s = -1.0;
+    if (std::abs(c2) < 1e-12) {
+        if (c1 < 0.0) s = -c0 / c1;
+    } else {
+        const double discriminant = c1 * c1 - 4.0 * c2 * c0;
+        if (discriminant < 0.0) return false;
+        const double q = -0.5 * (c1 + std::copysign(std::sqrt(discriminant), c1));
+        double r0 = q / c2, r1 = q != 0.0 ? c0 / q : r0;
+        if (r0 > r1) std::swap(r0, r1);
+        s = r0 >= 0.0 ? r0 : r1;
+    }
+    if (s < 0.0 || s > span) return false;
+    tHit = (float)(t0 + s);
+    return true;
+}
+
+// Front-to-back descent: a node is entered only where the ray crosses its bounding box (xz
+// extent, min to max height). Siblings split the ground plane, so their spans along the ray
+// do not overlap and the first child with a hit holds the nearest one.
+bool RaycastNode(const HeightPyramid& pyramid, const DenseHeights& heights, int width, int height,
+                 int level, int nodeX, int nodeZ, const GridRay& ray, float t0, float t1, float& tHit) {
+    const HeightPyramid::Range& range = pyramid.GetNode(level, nodeX, nodeZ);
+    const int x0 = nodeX << level, z0 = nodeZ << level;
+    const int x1 = std::min((nodeX + 1) << level, width - 1);
+    const int z1 = std::min((nodeZ + 1) << level, height - 1);
+    if (!ClipToBox(ray, glm::vec3(x0, range.min, z0), glm::vec3(x1, range.max, z1), t0, t1)) return false;
+    
+    if (level == pyramid.GetBaseLevel()) {
+        // Up to 2^L x 2^L cells, each solved exactly; keep the nearest
+        bool found = false;
+        for (int z = z0; z < z1; ++z) {
+            for (int x = x0; x < x1; ++x) {
+                float c0 = t0, c1 = t1, t;
+                if (ClipToBox(ray, glm::vec3(x, range.min, z), glm::vec3(x + 1, range.max, z + 1), c0, c1) &&
+                    IntersectCell(heights, x, z, ray, c0, c1, t) && (!found || t < tHit)) {
+                    tHit = t;
+                    found = true;
+                }
+            }
+        }
+        return found;
+    }
+    
+    struct Child {
+        int x, z;
+        float entry;
+    };
+    Child children[4];
+    int count = 0;
+    const int child = level - 1;
+    for (int cz = nodeZ * 2; cz <= std::min(nodeZ * 2 + 1, pyramid.GetNodesZ(child) - 1); ++cz) {
+        for (int cx = nodeX * 2; cx <= std::min(nodeX * 2 + 1, pyramid.GetNodesX(child) - 1); ++cx) {
+            const HeightPyramid::Range& r = pyramid.GetNode(child, cx, cz);
+            float c0 = t0, c1 = t1;
+            glm::vec3 lo(cx << child, r.min, cz << child);
+            glm::vec3 hi(std::min((cx + 1) << child, width - 1), r.max, std::min((cz + 1) << child, height - 1));
+            if (!ClipToBox(ray, lo, hi, c0, c1)) continue;
+            // Insertion keeps the (at most four) children in entry order
+            int slot = count++;
+            for (; slot > 0 && children[slot - 1].entry > c0; --slot) {
+                children[slot] = children[slot - 1];
+            }
+            children[slot] = {cx, cz, c0};
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        if (RaycastNode(pyramid, heights, width, height, child, children[i].x, children[i].z, ray, t0, t1, tHit)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+const glm::vec3 TerrainPalette[TerrainPaletteSize] = {
+    glm::vec3(0.0f, 0.1f, 0.6f),    // Deep water - dark blue
+    glm::vec3(0.1f, 0.3f, 0.7f),    // Shallow water - medium blue
+    glm::vec3(0.8f, 0.7f, 0.4f),    // Beach/sand - tan
+    glm::vec3(0.2f, 0.6f, 0.1f),    // Low grassland - bright green
+    glm::vec3(0.1f, 0.4f, 0.05f),   // Hills - dark green
+    glm::vec3(0.5f, 0.4f, 0.2f),    // Low mountains - brown
+    glm::vec3(0.4f, 0.3f, 0.2f),    // High mountains - dark brown
+    glm::vec3(0.9f, 0.9f, 0.95f)    // Snow peaks - light gray
+};
+
+uint8_t TerrainPaletteIndex(float height) {
+    // Realistic terrain colors with strong contrast
+    float normalizedHeight = (height + 50.0f) / 150.0f;
+    normalizedHeight = std::clamp(normalizedHeight, 0.0f, 1.0f);
+    
+    static const float bandTops[TerrainPaletteSize - 1] = {0.1f, 0.2f, 0.25f, 0.4f, 0.6f, 0.75f, 0.9f};
+    uint8_t band = 0;
+    while (band < TerrainPaletteSize - 1 && normalizedHeight >= bandTops[band]) ++band;
+    return band;
+}
+
 TerrainMesh::TerrainMesh() : m_VAO(0), m_VBO(0), m_EBO(0), m_width(0), m_height(0) {}
 
 TerrainMesh::~TerrainMesh() {
-    if (m_VAO) glDeleteVertexArraysAPPLE(1, &m_VAO);
-    if (m_VBO) glDeleteBuffers(1, &m_VBO);
-    if (m_EBO) glDeleteBuffers(1, &m_EBO);
+    ReleaseBuffers();
 }
 
-void TerrainMesh::GenerateFromHeightmap(const std::vector<float>& heightData, int width, int height, float scale) {
+void TerrainMesh::BuildGeometry(const float* heightData, int width, int height, float scale) {
     m_width = width;
     m_height = height;
-    m_vertices.clear();
-    m_indices.clear();
+    
+    // Sized once and written in place; no per-vertex push_back growth
+    m_vertices.resize((size_t)width * height);
+    m_indices.resize(GridStripLength(width, height));
     
     // Generate vertices
     for (int z = 0; z < height; ++z) {
+        TerrainVertex* row = &m_vertices[(size_t)z * width];
         for (int x = 0; x < width; ++x) {
-            TerrainVertex vertex;
+            TerrainVertex& vertex = row[x];
             
             vertex.position.x = (float)x - width * 0.5f;
-            vertex.position.y = heightData[z * width + x] * scale;
+            vertex.position.y = heightData[(size_t)z * width + x] * scale;
             vertex.position.z = (float)z - height * 0.5f;
             
             vertex.texCoord.x = (float)x / (width - 1);
@@ -38,10 +227,10 @@ void TerrainMesh::GenerateFromHeightmap(const std::vector<float>& heightData, in
             // Calculate proper normals for lighting
             glm::vec3 normal(0.0f, 1.0f, 0.0f);
             if (x > 0 && x < width - 1 && z > 0 && z < height - 1) {
-                float hL = heightData[(z) * width + (x - 1)];
-                float hR = heightData[(z) * width + (x + 1)];
-                float hD = heightData[(z - 1) * width + x];
-                float hU = heightData[(z + 1) * width + x];
+                float hL = heightData[(size_t)z * width + (x - 1)];
+                float hR = heightData[(size_t)z * width + (x + 1)];
+                float hD = heightData[(size_t)(z - 1) * width + x];
+                float hU = heightData[(size_t)(z + 1) * width + x];
                 
                 normal.x = (hL - hR) * 0.5f;
                 normal.z = (hD - hU) * 0.5f;
@@ -49,308 +238,687 @@ void TerrainMesh::GenerateFromHeightmap(const std::vector<float>& heightData, in
                 normal = glm::normalize(normal);
             }
             vertex.normal = normal;
-            
-                        // Realistic terrain colors with strong contrast
-            float normalizedHeight = (vertex.position.y + 50.0f) / 150.0f;
-            normalizedHeight = std::clamp(normalizedHeight, 0.0f, 1.0f);
-            
-            if (normalizedHeight < 0.1f) {
-                vertex.color = glm::vec3(0.0f, 0.1f, 0.6f); // Deep water - dark blue
-            } else if (normalizedHeight < 0.2f) {
-                vertex.color = glm::vec3(0.1f, 0.3f, 0.7f); // Shallow water - medium blue
-            } else if (normalizedHeight < 0.25f) {
-                vertex.color = glm::vec3(0.8f, 0.7f, 0.4f); // Beach/sand - tan
-            } else if (normalizedHeight < 0.4f) {
-                vertex.color = glm::vec3(0.2f, 0.6f, 0.1f); // Low grassland - bright green
-            } else if (normalizedHeight < 0.6f) {
-                vertex.color = glm::vec3(0.1f, 0.4f, 0.05f); // Hills - dark green
-            } else if (normalizedHeight < 0.75f) {
-                vertex.color = glm::vec3(0.5f, 0.4f, 0.2f); // Low mountains - brown
-            } else if (normalizedHeight < 0.9f) {
-                vertex.color = glm::vec3(0.4f, 0.3f, 0.2f); // High mountains - dark brown
-            } else {
-                vertex.color = glm::vec3(0.9f, 0.9f, 0.95f); // Snow peaks - light gray
-            }
-            
-            m_vertices.push_back(vertex);
+            vertex.color = TerrainPalette[TerrainPaletteIndex(vertex.position.y)];
         }
     }
     
-    // Generate indices
-    for (int z = 0; z < height - 1; ++z) {
-        for (int x = 0; x < width - 1; ++x) {
-            int topLeft = z * width + x;
-            int topRight = topLeft + 1;
-            int bottomLeft = (z + 1) * width + x;
-            int bottomRight = bottomLeft + 1;
-            
-            m_indices.push_back(topLeft);
-            m_indices.push_back(bottomLeft);
-            m_indices.push_back(topRight);
-            
-            m_indices.push_back(topRight);
-            m_indices.push_back(bottomLeft);
-            m_indices.push_back(bottomRight);
-        }
+    // One strip instead of 6 indices per quad: about 2 indices per vertex
+    WriteGridStrip(width, height, m_indices.data());
+}
+
+TerrainEngine::TerrainEngine() 
+    : m_width(0), m_height(0), m_minHeight(0.0f), m_maxHeight(0.0f), m_terrainScale(1.0f), m_meshDirty(false), m_revision(0),
+      m_heights(nullptr), m_seed(0), m_workers(std::make_unique<WorkerPool>(1)), m_hierarchicalLOS(true),
+      m_rasters(std::make_shared<TerrainRasters>()), m_contourInterval(5.0f), m_contourVBO(0),
+      m_contourVBORevision(0), m_minorContourCount(0) {
+    m_terrainMesh = std::make_unique<TerrainMesh>();
+}
+
+TerrainEngine::~TerrainEngine() {
+    ReleaseBuffers();
+}
+
+void TerrainEngine::SetThreadCount(int threads) {
+    threads = std::max(threads, 1);
+    if (threads != m_workers->GetThreadCount()) {
+        m_workers = std::make_unique<WorkerPool>(threads);
     }
-    
-    SetupMesh();
 }
 
-void TerrainMesh::SetupMesh() {
-    glGenVertexArraysAPPLE(1, &m_VAO);
-    glGenBuffers(1, &m_VBO);
-    glGenBuffers(1, &m_EBO);
-    
-    glBindVertexArrayAPPLE(m_VAO);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(TerrainVertex), 
-                 m_vertices.data(), GL_STATIC_DRAW);
+bool TerrainEngine::LoadTerrain(const std::string& filepath) {
+    return LoadTerrain(filepath, HeightmapLoadOptions());
+}
+
+bool TerrainEngine::LoadTerrain(const std::string& filepath, const HeightmapLoadOptions& options,
+                                HeightmapLoadStats* stats) {
+    std::cout << "Loading terrain from: " << filepath << std::endl;
     
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int),
-                 m_indices.data(), GL_STATIC_DRAW);
+    Heightmap map;
+    HeightmapLoadStats loadStats;
+    if (!HeightmapLoader::Load(filepath, options, map, &loadStats)) {
+        std::cerr << "Failed to load terrain, keeping current heightfield" << std::endl;
+        return false;
+    }
     
-    // Position attribute
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(TerrainVertex), (void*)0);
+    m_lod.reset();  // Its builder threads read the old heights
+    m_pyramid.Clear();
+    ClearRasters();
+    m_tiles.reset();
+    m_width = map.width;
+    m_height = map.height;
     
-    // Normal attribute
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TerrainVertex), 
-                         (void*)offsetof(TerrainVertex, normal));
+    // Mapped float32 grids are used in place; everything else arrives as an owned copy
+    if (map.mapping) {
+        m_heightData.clear();
+        m_heightData.shrink_to_fit();
+        m_mappedHeights = std::move(map.mapping);
+        m_heights = map.data;
+    } else {
+        m_mappedHeights.reset();
+        m_heightData = std::move(map.owned);
+        m_heights = m_heightData.data();
+    }
+    // One pass over the heights; a mapped grid's range comes from the pyramid's top node
+    m_pyramid.Build(m_heights, m_width, m_height, m_workers.get(), m_mappedHeights ? MappedPyramidBaseLevel : 1);
+    m_minHeight = map.hasRange || m_pyramid.IsEmpty() ? map.minHeight : m_pyramid.GetRange().min;
+    m_maxHeight = map.hasRange || m_pyramid.IsEmpty() ? map.maxHeight : m_pyramid.GetRange().max;
     
-    // Color attribute
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(TerrainVertex), 
-                         (void*)offsetof(TerrainVertex, color));
+    std::cout << "🗺️  Terrain loaded (" << m_width << "x" << m_height << ") - Height range: "
+              << m_minHeight << " to " << m_maxHeight << std::endl;
+    std::cout << "📦 " << loadStats.bytesRead / (1024.0 * 1024.0) << " MB at " << loadStats.MegabytesPerSecond()
+              << " MB/s, peak RSS " << loadStats.peakResidentBytes / (1024 * 1024) << " MB"
+              << (loadStats.zeroCopy ? " (memory-mapped)" : "") << std::endl;
+    if (stats) *stats = loadStats;
     
-    glBindVertexArrayAPPLE(0);
+    m_meshDirty = true;
+    m_revision++;
+    return true;
 }
 
-void TerrainMesh::Render() {
-    if (m_VAO && !m_indices.empty()) {
-        glBindVertexArrayAPPLE(m_VAO);
-        glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, 0);
-        glBindVertexArrayAPPLE(0);
+bool TerrainEngine::LoadTiledTerrain(const std::string& filepath, const HeightmapLoadOptions& options,
+                                     size_t cacheBytes, int tileSize) {
+    std::cout << "Opening tiled terrain: " << filepath << std::endl;
+    
+    auto source = std::make_unique<RawTileSource>();
+    if (!source->Open(filepath, options)) {
+        std::cerr << "Failed to open tiled terrain, keeping current heightfield" << std::endl;
+        return false;
     }
+    
+    UseTileStore(std::move(source), cacheBytes, tileSize);
+    return true;
 }
 
-TerrainEngine::TerrainEngine() 
-    : m_width(0), m_height(0), m_minHeight(0.0f), m_maxHeight(0.0f), m_terrainScale(1.0f) {
-    m_terrainMesh = std::make_unique<TerrainMesh>();
+void TerrainEngine::GenerateProceduralTerrain(int width, int height, uint64_t seed, size_t cacheBytes, int tileSize) {
+    std::cout << "Procedural terrain (" << width << "x" << height << ") with seed " << seed
+              << ", generated on demand" << std::endl;
+    
+    m_seed = seed;
+    UseTileStore(std::make_unique<ProceduralTileSource>(seed, width, height), cacheBytes, tileSize);
 }
 
-TerrainEngine::~TerrainEngine() = default;
-
-bool TerrainEngine::LoadTerrain(const std::string& filepath) {
-    std::cout << "Loading terrain from: " << filepath << std::endl;
-    std::cout << "File loading not yet implemented, generating random terrain instead" << std::endl;
-    GenerateRandomTerrain(256, 256);
-    return true;
+void TerrainEngine::UseTileStore(std::unique_ptr<TileSource> source, size_t cacheBytes, int tileSize) {
+    m_lod.reset();
+    m_pyramid.Clear();
+    ClearRasters();
+    m_tiles = std::make_unique<TileStore>(std::move(source), tileSize, cacheBytes);
+    m_width = m_tiles->GetWidth();
+    m_height = m_tiles->GetHeight();
+    m_minHeight = m_maxHeight = 0.0f;  // Widened as tiles page in, see GetTerrainSize
+    m_mappedHeights.reset();
+    m_heightData.clear();
+    m_heightData.shrink_to_fit();
+    m_heights = nullptr;
+    
+    std::cout << "🧱 Tiled terrain (" << m_width << "x" << m_height << ") in " << tileSize << "^2 tiles, cache "
+              << m_tiles->GetCapacity() << " tiles (" << (cacheBytes >> 20) << " MB)" << std::endl;
+    
+    m_meshDirty = true;
+    m_revision++;
 }
 
 void TerrainEngine::GenerateRandomTerrain(int width, int height) {
+    // Enhanced randomization - ensure completely different terrain each launch
+    std::random_device rd;
+    uint64_t seed = ((uint64_t)rd() << 32 | rd()) ^ (uint64_t)std::time(nullptr) ^ (uint64_t)getpid();
+    GenerateRandomTerrain(width, height, seed);
+}
+
+void TerrainEngine::GenerateRandomTerrain(int width, int height, uint64_t seed) {
     std::cout << "Generating high-resolution terrain (" << width << "x" << height << ")" << std::endl;
+    std::cout << "🌱 Generating unique terrain with seed: " << seed << std::endl;
     
     m_width = width;
     m_height = height;
-    m_heightData.resize(width * height);
-    
-    // Enhanced randomization - ensure completely different terrain each launch
-    std::random_device rd;
-    auto seed = rd() ^ static_cast<unsigned>(std::time(nullptr)) ^ static_cast<unsigned>(getpid());
-    std::mt19937 gen(seed);
-    std::uniform_real_distribution<float> dis(-1.0f, 1.0f);  // Normalized for better randomization
-    std::uniform_real_distribution<float> feature_dis(0.6f, 1.4f);
-    
-    std::cout << "🌱 Generating unique terrain with seed: " << seed << std::endl;
+    m_seed = seed;
+    m_lod.reset();
+    m_pyramid.Clear();
+    ClearRasters();
+    m_tiles.reset();
+    m_mappedHeights.reset();
+    m_heightData.resize((size_t)width * height);
+    m_heights = m_heightData.data();
     
-    // Enhanced terrain characteristics for VERY dramatic slopes with extreme elevation
-    float base_amplitude = 120.0f + dis(gen) * 80.0f;  // EXTREMELY dramatic terrain (120-200 for massive mountains)
-    float base_frequency = 0.0008f + (rd() % 5000) * 0.0000003f;  // Very low frequency for massive mountain ranges
-    float terrain_complexity = 1.2f + feature_dis(gen) * 0.5f;  // Very high complexity for extreme terrain
+    TerrainGenerator generator(seed);
+    std::cout << "�️  Enhanced terrain: amplitude=" << generator.GetAmplitude()
+              << ", frequency=" << generator.GetFrequency()
+              << ", complexity=" << generator.GetComplexity() << " (dramatic slopes)" << std::endl;
     
-    std::cout << "�️  Enhanced terrain: amplitude=" << base_amplitude 
-              << ", frequency=" << base_frequency 
-              << ", complexity=" << terrain_complexity << " (dramatic slopes)" << std::endl;
+    // Every height depends only on the seed and its vertex, so the result is the same on any thread count
+    generator.GenerateBlock(0, 0, width, height, m_heightData.data(), (size_t)width, m_workers.get());
     
-    // Generate much more detailed heightmap with multiple octaves
-    for (int z = 0; z < height; ++z) {
-        for (int x = 0; x < width; ++x) {
-            float height_val = 0.0f;
-            
-            // Primary terrain features with randomized parameters
-            float amplitude = base_amplitude;
-            float frequency = base_frequency;
-            
-            // Generate varied terrain with randomized characteristics
-            for (int octave = 0; octave < 5; ++octave) {
-                float sample_x = x * frequency;
-                float sample_z = z * frequency;
-                
-                // Enhanced terrain generation with EXTREME variation and steep gradients
-                height_val += sin(sample_x * terrain_complexity) * cos(sample_z) * amplitude;
-                height_val += cos(sample_x * 1.3f) * sin(sample_z * 0.9f * terrain_complexity) * amplitude * 0.9f;
-                height_val += sin(sample_x * 2.1f + terrain_complexity) * amplitude * 0.7f;
-                height_val += cos(sample_z * 1.7f + terrain_complexity) * amplitude * 0.6f;  // Additional steepness
-                
-                // Add sharp ridges and valleys for extreme terrain
-                height_val += sin(sample_x * 4.0f) * cos(sample_z * 4.0f) * amplitude * 0.4f;
-                
-                // Add randomized noise for steep terrain features
-                height_val += (dis(gen) * 0.15f) * amplitude * 0.3f;
-                
-                amplitude *= 0.5f;
-                frequency *= 2.0f;
-            }
-            
-            // Add moderate detail noise
-            height_val += dis(gen) * 0.15f;
-            
-            m_heightData[z * width + x] = height_val;
-            
-            if (x == 0 && z == 0) {
-                m_minHeight = m_maxHeight = height_val;
-            } else {
-                m_minHeight = std::min(m_minHeight, height_val);
-                m_maxHeight = std::max(m_maxHeight, height_val);
-            }
+    std::vector<float> rowMin(height), rowMax(height);
+    m_workers->ParallelFor((size_t)height, [&](size_t begin, size_t end) {
+        for (size_t z = begin; z < end; ++z) {
+            auto [lo, hi] = std::minmax_element(&m_heightData[z * width], &m_heightData[z * width] + width);
+            rowMin[z] = *lo;
+            rowMax[z] = *hi;
         }
-    }
+    });
+    m_minHeight = *std::min_element(rowMin.begin(), rowMin.end());
+    m_maxHeight = *std::max_element(rowMax.begin(), rowMax.end());
+    m_pyramid.Build(m_heights, m_width, m_height, m_workers.get());
     
     std::cout << "High-resolution terrain generated - Height range: " << m_minHeight << " to " << m_maxHeight << std::endl;
     
-    // Use enhanced vertical scale for steeper appearance
-    float steepScale = 3.0f;  // Triple the vertical scale for extremely steep terrain
-    m_terrainMesh->GenerateFromHeightmap(m_heightData, width, height, steepScale);
+    // Mesh is built on the next Render() so heightfield queries never need a GL context
+    m_meshDirty = true;
+    m_revision++;
 }
 
-void TerrainEngine::Render() {
-    if (m_terrainMesh) {
-        // Render the base terrain mesh
-        m_terrainMesh->Render();
-        
-        // Render contour lines on top
-        RenderContourLines();
+const ContourSet& TerrainEngine::GetContours() {
+    if (!m_heights) {
+        m_contours.levels.clear();
+        return m_contours;
+    }
+    if (!m_contours.levels.empty() && m_contours.revision == m_revision) return m_contours;
+    
+    int numContours = (int)((m_maxHeight - m_minHeight) / m_contourInterval) + 1;
+    ContourExtractor::ExtractEvenlySpaced(m_heights, m_width, m_height, m_minHeight, m_contourInterval, numContours,
+                                          m_contours, m_workers.get());
+    for (int c = 0; c < numContours; ++c) {
+        m_contours.levels[c].major = c % 5 == 0;  // Every 25 units at the default interval
     }
+    m_contours.revision = m_revision;
+    return m_contours;
 }
 
-void TerrainEngine::RenderContourLines() const {
-    if (m_heightData.empty()) return;
+void TerrainEngine::SetContourInterval(float interval) {
+    if (interval > 0.0f && interval != m_contourInterval) {
+        m_contourInterval = interval;
+        m_contours.levels.clear();
+        m_contourVBORevision = 0;  // Re-uploaded on the next frame
+    }
+}
+
+float TerrainEngine::GetElevationAt(float x, float z) const {
+    if (!IsLoaded() || m_width < 2 || m_height < 2) return 0.0f;
+    
+    // Bilinear between the four surrounding vertices; positions off the map take the edge height
+    float gx = std::clamp(x + m_width * 0.5f, 0.0f, (float)(m_width - 1));
+    float gz = std::clamp(z + m_height * 0.5f, 0.0f, (float)(m_height - 1));
+    if (m_tiles) {
+        SampledHeights heights{m_tiles.get()};
+        return SampleGrid(heights, gx, gz);
+    }
+    DenseHeights heights{m_heights, m_width};
+    return SampleGrid(heights, gx, gz);
+}
+
+void TerrainEngine::GetElevationBatch(const float* xs, const float* zs, float* out, size_t n) const {
+    if (!IsLoaded() || m_width < 2 || m_height < 2) {
+        std::fill(out, out + n, 0.0f);
+        return;
+    }
     
-    glDisable(GL_LIGHTING);
-    glDisable(GL_DEPTH_TEST);
-    glLineWidth(1.5f);
+    if (m_tiles) {
+        // Batches are usually spatially coherent (units of one formation), so one reader
+        // keeps hitting the same tile
+        TiledHeights heights{TileStore::Reader(*m_tiles)};
+        for (size_t i = 0; i < n; ++i) {
+            float gx = std::clamp(xs[i] + m_width * 0.5f, 0.0f, (float)(m_width - 1));
+            float gz = std::clamp(zs[i] + m_height * 0.5f, 0.0f, (float)(m_height - 1));
+            out[i] = SampleGrid(heights, gx, gz);
+        }
+        return;
+    }
     
-    // Calculate contour interval (every 5 units for detailed mapping)
-    float contourInterval = 5.0f;
-    int numContours = (int)((m_maxHeight - m_minHeight) / contourInterval) + 1;
+    // Blocks of points go through two straight-line passes over stack arrays: clamp and cell
+    // index, then the four height loads and the blend. Neither pass branches, and the stack
+    // buffers cannot alias the heightfield, so the compiler vectorizes both (the loads as
+    // gathers where the target has them). 32-bit indices keep the address math in full-width
+    // lanes; grids too large for them are far beyond memory anyway.
+    const int Block = 256;
+    int index[Block];
+    float fx[Block], fz[Block], result[Block];
     
-    for (int c = 0; c < numContours; ++c) {
-        float elevation = m_minHeight + c * contourInterval;
+    const float* heights = m_heights;
+    const int width = m_width;
+    const float offsetX = m_width * 0.5f;
+    const float offsetZ = m_height * 0.5f;
+    const float maxX = (float)(m_width - 1);
+    const float maxZ = (float)(m_height - 1);
+    const int lastCellX = m_width - 2;
+    const int lastCellZ = m_height - 2;
+    
+    for (size_t begin = 0; begin < n; begin += Block) {
+        const int count = (int)std::min<size_t>(Block, n - begin);
+        const float* blockX = xs + begin;
+        const float* blockZ = zs + begin;
         
-        // Use different colors for major vs minor contours
-        if (c % 5 == 0) {
-            // Major contour lines (every 25 units) in brown
-            glColor3f(0.6f, 0.3f, 0.1f);
-            glLineWidth(2.5f);
-        } else {
-            // Minor contour lines in lighter brown
-            glColor3f(0.4f, 0.25f, 0.1f);
-            glLineWidth(1.5f);
+        for (int i = 0; i < count; ++i) {
+            float gx = blockX[i] + offsetX;
+            float gz = blockZ[i] + offsetZ;
+            gx = gx > 0.0f ? gx : 0.0f;
+            gz = gz > 0.0f ? gz : 0.0f;
+            gx = gx < maxX ? gx : maxX;
+            gz = gz < maxZ ? gz : maxZ;
+            int x0 = (int)gx;
+            int z0 = (int)gz;
+            x0 = x0 < lastCellX ? x0 : lastCellX;
+            z0 = z0 < lastCellZ ? z0 : lastCellZ;
+            fx[i] = gx - (float)x0;
+            fz[i] = gz - (float)z0;
+            index[i] = z0 * width + x0;
         }
         
-        // Draw contour lines by sampling the heightmap
-        for (int z = 0; z < m_height - 1; ++z) {
-            for (int x = 0; x < m_width - 1; ++x) {
-                float h1 = m_heightData[z * m_width + x];
-                float h2 = m_heightData[z * m_width + (x + 1)];
-                float h3 = m_heightData[(z + 1) * m_width + x];
-                float h4 = m_heightData[(z + 1) * m_width + (x + 1)];
-                
-                // Check if contour line crosses any edge of this quad
-                bool crosses = false;
-                glBegin(GL_LINES);
-                
-                // Check horizontal edge (top)
-                if ((h1 <= elevation && h2 >= elevation) || (h1 >= elevation && h2 <= elevation)) {
-                    float t = (elevation - h1) / (h2 - h1);
-                    float worldX = (x + t - m_width * 0.5f) * m_terrainScale;
-                    float worldZ = (z - m_height * 0.5f) * m_terrainScale;
-                    glVertex3f(worldX, elevation * m_terrainScale, worldZ);
-                    crosses = true;
-                }
-                
-                // Check vertical edge (left)
-                if ((h1 <= elevation && h3 >= elevation) || (h1 >= elevation && h3 <= elevation)) {
-                    float t = (elevation - h1) / (h3 - h1);
-                    float worldX = (x - m_width * 0.5f) * m_terrainScale;
-                    float worldZ = (z + t - m_height * 0.5f) * m_terrainScale;
-                    if (crosses) {
-                        glVertex3f(worldX, elevation * m_terrainScale, worldZ);
-                    } else {
-                        glVertex3f(worldX, elevation * m_terrainScale, worldZ);
-                        crosses = true;
-                    }
-                }
-                
-                // Check horizontal edge (bottom)
-                if ((h3 <= elevation && h4 >= elevation) || (h3 >= elevation && h4 <= elevation)) {
-                    float t = (elevation - h3) / (h4 - h3);
-                    float worldX = (x + t - m_width * 0.5f) * m_terrainScale;
-                    float worldZ = (z + 1 - m_height * 0.5f) * m_terrainScale;
-                    if (crosses) {
-                        glVertex3f(worldX, elevation * m_terrainScale, worldZ);
-                    } else {
-                        glVertex3f(worldX, elevation * m_terrainScale, worldZ);
-                        crosses = true;
-                    }
-                }
-                
-                // Check vertical edge (right)
-                if ((h2 <= elevation && h4 >= elevation) || (h2 >= elevation && h4 <= elevation)) {
-                    float t = (elevation - h2) / (h4 - h2);
-                    float worldX = (x + 1 - m_width * 0.5f) * m_terrainScale;
-                    float worldZ = (z + t - m_height * 0.5f) * m_terrainScale;
-                    if (crosses) {
-                        glVertex3f(worldX, elevation * m_terrainScale, worldZ);
+        for (int i = 0; i < count; ++i) {
+            int k = index[i];
+            float h00 = heights[k];
+            float h10 = heights[k + 1];
+            float h01 = heights[k + width];
+            float h11 = heights[k + width + 1];
+            float top = h00 + (h10 - h00) * fx[i];
+            float bottom = h01 + (h11 - h01) * fx[i];
+            result[i] = top + (bottom - top) * fz[i];
+        }
+        
+        std::copy(result, result + count, out + begin);
+    }
+}
+
+template<typename Heights>
+float TerrainEngine::SampleGrid(Heights& heights, float gx, float gz) const {
+    int x0 = std::min((int)gx, m_width - 2);
+    int z0 = std::min((int)gz, m_height - 2);
+    float fx = gx - x0;
+    float fz = gz - z0;
+    
+    float h[4];
+    heights.Cell(x0, z0, h);
+    float top = h[0] + (h[1] - h[0]) * fx;
+    float bottom = h[2] + (h[3] - h[2]) * fx;
+    return top + (bottom - top) * fz;
+}
+
+template<typename Heights>
+bool TerrainEngine::TraceLineOfSight(Heights& heights, const glm::vec3& from, const glm::vec3& to,
+                                     const HeightPyramid* pyramid) const {
+    // Work in grid space: vertex (i, j) holds heights.At(i, j)
+    float x0 = from.x + m_width * 0.5f;
+    float z0 = from.z + m_height * 0.5f;
+    float dx = to.x - from.x;
+    float dz = to.z - from.z;
+    float dy = to.y - from.y;
+    
+    // Clip the segment to the heightfield; anything outside cannot occlude
+    float maxX = (float)(m_width - 1);
+    float maxZ = (float)(m_height - 1);
+    float tEnter = 0.0f;
+    float tExit = 1.0f;
+    auto clip = [&](float origin, float delta, float hi) {
+        if (delta == 0.0f) {
+            return origin >= 0.0f && origin <= hi;
+        }
+        float ta = (0.0f - origin) / delta;
+        float tb = (hi - origin) / delta;
+        if (ta > tb) std::swap(ta, tb);
+        tEnter = std::max(tEnter, ta);
+        tExit = std::min(tExit, tb);
+        return tEnter < tExit;
+    };
+    if (!clip(x0, dx, maxX) || !clip(z0, dz, maxZ)) {
+        return true;
+    }
+    
+    // Amanatides-Woo traversal, testing the ray against the surface at every cell edge it crosses
+    float ex = x0 + dx * tEnter;
+    float ez = z0 + dz * tEnter;
+    int cellX = std::clamp((int)ex, 0, m_width - 2);
+    int cellZ = std::clamp((int)ez, 0, m_height - 2);
+    int stepX = dx > 0.0f ? 1 : -1;
+    int stepZ = dz > 0.0f ? 1 : -1;
+    
+    const float inf = std::numeric_limits<float>::infinity();
+    float tDeltaX = dx != 0.0f ? std::abs(1.0f / dx) : inf;
+    float tDeltaZ = dz != 0.0f ? std::abs(1.0f / dz) : inf;
+    float tMaxX = dx != 0.0f ? ((cellX + (dx > 0.0f ? 1 : 0)) - x0) / dx : inf;
+    float tMaxZ = dz != 0.0f ? ((cellZ + (dz > 0.0f ? 1 : 0)) - z0) / dz : inf;
+    float tCell = tEnter;  // Where the ray entered the current cell
+    int blockedX = -1, blockedZ = -1;  // Base-level node the ray was last found to dip into
+    const int baseLevel = pyramid ? pyramid->GetBaseLevel() : 1;
+    const float invDx = 1.0f / dx, invDz = 1.0f / dz;
+    
+    while (true) {
+        float t = std::min(tMaxX, tMaxZ);
+        if (t >= tExit) break;
+        
+        // Hierarchical early-out: the surface inside a node never rises above its highest vertex, so
+        // when that lies below the ray's lowest point across the node, none of its cells can occlude.
+        // Climb while that holds (a parent covers more of the ray and is at least as high), then
+        // jump to where the ray leaves the largest such node.
+        if (pyramid && (cellX >> baseLevel != blockedX || cellZ >> baseLevel != blockedZ) &&
+            cellX >= 0 && cellX <= m_width - 2 && cellZ >= 0 && cellZ <= m_height - 2) {
+            int skipLevel = 0;
+            float skipX = inf, skipZ = inf;
+            for (int level = baseLevel; level <= pyramid->GetLevelCount(); ++level) {
+                int nodeX = cellX >> level;
+                int nodeZ = cellZ >> level;
+                float leaveX = dx != 0.0f ? (((nodeX + (dx > 0.0f ? 1 : 0)) << level) - x0) * invDx : inf;
+                float leaveZ = dz != 0.0f ? (((nodeZ + (dz > 0.0f ? 1 : 0)) << level) - z0) * invDz : inf;
+                float tLeave = std::min(std::min(leaveX, leaveZ), tExit);
+                float rayLow = from.y + dy * (dy < 0.0f ? tLeave : tCell);
+                if (pyramid->GetNode(level, nodeX, nodeZ).max > rayLow) {
+                    if (level == baseLevel) {
+                        // Step through this node's cells without asking again
+                        blockedX = nodeX;
+                        blockedZ = nodeZ;
                     }
+                    break;
                 }
+                skipLevel = level;
+                skipX = leaveX;
+                skipZ = leaveZ;
+            }
+            if (skipLevel > 0) {
+                float tLeave = std::min(skipX, skipZ);
+                if (tLeave >= tExit) break;
                 
-                glEnd();
+                // First cell past the node's exit edge; the other axis stays inside the node's span
+                const int size = 1 << skipLevel;
+                const int nodeX0 = cellX & -size;
+                const int nodeZ0 = cellZ & -size;
+                cellX = std::clamp((int)(x0 + dx * tLeave), nodeX0, nodeX0 + size - 1);
+                cellZ = std::clamp((int)(z0 + dz * tLeave), nodeZ0, nodeZ0 + size - 1);
+                if (skipX <= skipZ) cellX = dx > 0.0f ? nodeX0 + size : nodeX0 - 1;
+                if (skipZ <= skipX) cellZ = dz > 0.0f ? nodeZ0 + size : nodeZ0 - 1;
+                if (cellX < 0 || cellX > m_width - 2 || cellZ < 0 || cellZ > m_height - 2) break;
+                tMaxX = dx != 0.0f ? ((cellX + (dx > 0.0f ? 1 : 0)) - x0) / dx : inf;
+                tMaxZ = dz != 0.0f ? ((cellZ + (dz > 0.0f ? 1 : 0)) - z0) / dz : inf;
+                tCell = tLeave;
+                continue;
+            }
+        }
+        
+        if (t > tEnter) {
+            float gx = std::clamp(x0 + dx * t, 0.0f, maxX);
+            float gz = std::clamp(z0 + dz * t, 0.0f, maxZ);
+            if (SampleGrid(heights, gx, gz) > from.y + dy * t) {
+                return false;
             }
         }
+        
+        if (tMaxX < tMaxZ) {
+            cellX += stepX;
+            tMaxX += tDeltaX;
+        } else {
+            cellZ += stepZ;
+            tMaxZ += tDeltaZ;
+        }
+        tCell = t;
     }
+    return true;
+}
+
+bool TerrainEngine::HasLineOfSight(const glm::vec3& from, const glm::vec3& to) const {
+    if (m_width < 2 || m_height < 2) return true;
+    if (m_tiles) {
+        TiledHeights heights{TileStore::Reader(*m_tiles)};
+        return TraceLineOfSight(heights, from, to, nullptr);
+    }
+    DenseHeights heights{m_heights, m_width};
+    return TraceLineOfSight(heights, from, to, m_hierarchicalLOS ? &m_pyramid : nullptr);
+}
+
+void TerrainEngine::HasLineOfSight(std::span<const std::pair<glm::vec3, glm::vec3>> rays, std::span<uint8_t> out) const {
+    size_t count = std::min(rays.size(), out.size());
+    if (m_width < 2 || m_height < 2) {
+        std::fill(out.begin(), out.begin() + count, uint8_t(1));
+        return;
+    }
+    if (m_tiles) {
+        // Trace in Morton order of the origin tile so each tile is paged in about once per batch
+        // instead of once per ray, however the caller ordered the rays
+        const int tileSize = m_tiles->GetTileSize();
+        std::vector<std::pair<uint64_t, uint32_t>> order(count);
+        for (size_t i = 0; i < count; ++i) {
+            int tx = std::clamp((int)(rays[i].first.x + m_width * 0.5f), 0, m_width - 1) / tileSize;
+            int tz = std::clamp((int)(rays[i].first.z + m_height * 0.5f), 0, m_height - 1) / tileSize;
+            uint64_t key = 0;
+            for (int bit = 0; bit < 16; ++bit) {
+                key |= (uint64_t)((tx >> bit) & 1) << (2 * bit) | (uint64_t)((tz >> bit) & 1) << (2 * bit + 1);
+            }
+            order[i] = {key, (uint32_t)i};
+        }
+        std::sort(order.begin(), order.end());
+        
+        TiledHeights heights{TileStore::Reader(*m_tiles)};
+        for (const auto& entry : order) {
+            size_t i = entry.second;
+            out[i] = TraceLineOfSight(heights, rays[i].first, rays[i].second, nullptr) ? 1 : 0;
+        }
+        return;
+    }
+    DenseHeights heights{m_heights, m_width};
+    const HeightPyramid* pyramid = m_hierarchicalLOS ? &m_pyramid : nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = TraceLineOfSight(heights, rays[i].first, rays[i].second, pyramid) ? 1 : 0;
+    }
+}
+
+bool TerrainEngine::Raycast(const glm::vec3& origin, const glm::vec3& direction, glm::vec3& hit, float maxDistance,
+                            const GroundPlacement& placement) const {
+    const float length = glm::length(direction);
+    if (!IsLoaded() || m_width < 2 || m_height < 2 || length == 0.0f || placement.scale <= 0.0f) return false;
+    
+    // Undo the placement on the ray rather than the heights. The map is affine, so t is the same
+    // in both spaces and the hit maps back through the original ray.
+    GridRay ray;
+    ray.origin = glm::vec3(origin.x + m_width * 0.5f, (origin.y - placement.offset) / placement.scale,
+                           origin.z + m_height * 0.5f);
+    ray.direction = glm::vec3(direction.x, direction.y / placement.scale, direction.z);
+    ray.inverse = glm::vec3(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+    float t0 = 0.0f;
+    float t1 = maxDistance / length;
+    float tHit = 0.0f;
     
-    // Draw elevation labels for major contours
-    glColor3f(0.8f, 0.4f, 0.2f);
-    for (int c = 0; c < numContours; c += 5) {
-        float elevation = m_minHeight + c * contourInterval;
-        // Add elevation text rendering here if needed
+    bool found = false;
+    if (!m_pyramid.IsEmpty()) {
+        DenseHeights heights{m_heights, m_width};
+        found = RaycastNode(m_pyramid, heights, m_width, m_height, m_pyramid.GetLevelCount(), 0, 0, ray, t0, t1, tHit);
+    } else {
+        // No pyramid over tiles: walk the cells under the ray from where it enters the map
+        const float inf = std::numeric_limits<float>::infinity();
+        glm::vec3 lo(0.0f, -inf, 0.0f), hi((float)(m_width - 1), inf, (float)(m_height - 1));
+        if (!ClipToBox(ray, lo, hi, t0, t1)) return false;
+        
+        TiledHeights heights{TileStore::Reader(*m_tiles)};
+        int cellX = std::clamp((int)(ray.origin.x + direction.x * t0), 0, m_width - 2);
+        int cellZ = std::clamp((int)(ray.origin.z + direction.z * t0), 0, m_height - 2);
+        float t = t0;
+        while (!found && t <= t1 && cellX >= 0 && cellX <= m_width - 2 && cellZ >= 0 && cellZ <= m_height - 2) {
+            float tNextX = direction.x != 0.0f ? ((cellX + (direction.x > 0.0f ? 1 : 0)) - ray.origin.x) * ray.inverse.x : inf;
+            float tNextZ = direction.z != 0.0f ? ((cellZ + (direction.z > 0.0f ? 1 : 0)) - ray.origin.z) * ray.inverse.z : inf;
+            float tLeave = std::min(std::min(tNextX, tNextZ), t1);
+            found = IntersectCell(heights, cellX, cellZ, ray, t, std::max(t, tLeave), tHit);
+            if (tNextX < tNextZ) {
+                cellX += direction.x > 0.0f ? 1 : -1;
+            } else {
+                cellZ += direction.z > 0.0f ? 1 : -1;
+            }
+            t = std::max(t, tLeave);
+            if (tLeave >= t1) break;
+        }
     }
+    if (!found) return false;
     
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_LIGHTING);
-    glLineWidth(1.0f);
+    hit = origin + direction * tHit;
+    return true;
 }
 
-float TerrainEngine::GetElevationAt(float x, float z) const {
-    int gridX = (int)(x + m_width * 0.5f);
-    int gridZ = (int)(z + m_height * 0.5f);
+template<typename Heights>
+void TerrainEngine::SweepViewshed(Heights& heights, const glm::vec3& observer, Viewshed& out) const {
+    const int radius = out.radius;
+    const int side = out.Side();
+    const int cx = out.centerX;
+    const int cz = out.centerZ;
+    const float eye = observer.y;
     
-    if (gridX >= 0 && gridX < m_width && gridZ >= 0 && gridZ < m_height) {
-        return m_heightData[gridZ * m_width + gridX];
+    // Cast one ray from the observer to each vertex on the square's perimeter. Along a ray the
+    // horizon is the steepest elevation angle seen so far, interpolated across the minor axis;
+    // a vertex is visible when it rises to or above that horizon.
+    auto sweep = [&](int px, int pz) {
+        int dx = px - cx;
+        int dz = pz - cz;
+        bool majorX = std::abs(dx) >= std::abs(dz);
+        int steps = majorX ? std::abs(dx) : std::abs(dz);
+        float minorStep = (float)(majorX ? dz : dx) / steps;
+        int majorDir = (majorX ? dx : dz) > 0 ? 1 : -1;
+        float stepLength = std::sqrt(1.0f + minorStep * minorStep);
+        float horizon = -std::numeric_limits<float>::infinity();
+        
+        for (int k = 1; k <= steps; ++k) {
+            float minor = (majorX ? cz : cx) + minorStep * k;
+            int major = (majorX ? cx : cz) + majorDir * k;
+            int lo = (int)std::floor(minor);
+            float frac = minor - lo;
+            int gx0 = majorX ? major : lo;
+            int gz0 = majorX ? lo : major;
+            int gx1 = majorX ? major : lo + 1;
+            int gz1 = majorX ? lo + 1 : major;
+            if (gx0 < 0 || gz0 < 0 || gx0 >= m_width || gz0 >= m_height) break;
+            
+            float h0 = heights.At(gx0, gz0);
+            float h1 = (gx1 < m_width && gz1 < m_height) ? heights.At(gx1, gz1) : h0;
+            float distance = stepLength * k;
+            
+            // Nearest vertex to the ray decides this step's visibility
+            int nx = frac < 0.5f ? gx0 : gx1;
+            int nz = frac < 0.5f ? gz0 : gz1;
+            if (nx < m_width && nz < m_height) {
+                float nearest = (heights.At(nx, nz) - eye) / distance;
+                if (nearest >= horizon) {
+                    out.mask[(nz - cz + radius) * side + (nx - cx + radius)] = 1;
+                }
+            }
+            
+            float slope = (h0 + (h1 - h0) * frac - eye) / distance;
+            horizon = std::max(horizon, slope);
+        }
+    };
+    
+    for (int i = -radius; i <= radius; ++i) {
+        sweep(cx + i, cz - radius);
+        sweep(cx + i, cz + radius);
+    }
+    for (int i = -radius + 1; i < radius; ++i) {
+        sweep(cx - radius, cz + i);
+        sweep(cx + radius, cz + i);
     }
-    return 0.0f;
 }
 
-bool TerrainEngine::HasLineOfSight(const glm::vec3& from, const glm::vec3& to) const {
-    return true; // Simplified for now
+void TerrainEngine::ComputeViewshed(const glm::vec3& observer, int radius, Viewshed& out) const {
+    radius = std::max(radius, 1);
+    out.radius = radius;
+    out.centerX = (int)std::lround(observer.x + m_width * 0.5f);
+    out.centerZ = (int)std::lround(observer.z + m_height * 0.5f);
+    out.observerHeight = observer.y;
+    out.gridOffsetX = m_width * 0.5f;
+    out.gridOffsetZ = m_height * 0.5f;
+    out.terrainRevision = m_revision;
+    
+    const int side = out.Side();
+    out.mask.assign((size_t)side * side, 0);
+    
+    if (out.centerX < 0 || out.centerZ < 0 || out.centerX >= m_width || out.centerZ >= m_height) return;
+    out.mask[radius * side + radius] = 1;
+    
+    if (m_tiles) {
+        TiledHeights heights{TileStore::Reader(*m_tiles)};
+        SweepViewshed(heights, observer, out);
+    } else {
+        DenseHeights heights{m_heights, m_width};
+        SweepViewshed(heights, observer, out);
+    }
+}
+
+bool TerrainEngine::UpdateViewshed(const glm::vec3& observer, int radius, Viewshed& viewshed) const {
+    int cx = (int)std::lround(observer.x + m_width * 0.5f);
+    int cz = (int)std::lround(observer.z + m_height * 0.5f);
+    
+    bool stale = viewshed.mask.empty() ||
+                 viewshed.radius != std::max(radius, 1) ||
+                 viewshed.terrainRevision != m_revision ||
+                 std::abs(cx - viewshed.centerX) > 1 ||
+                 std::abs(cz - viewshed.centerZ) > 1 ||
+                 std::abs(observer.y - viewshed.observerHeight) > 1.0f;
+    if (!stale) return false;
+    
+    ComputeViewshed(observer, radius, viewshed);
+    return true;
+}
+
+void TerrainEngine::RefreshRasters() const {
+    if (m_heights && (m_rasters->IsEmpty() || m_rasters->GetRevision() != m_revision)) {
+        auto rasters = std::make_shared<TerrainRasters>();
+        rasters->Build(m_heights, m_width, m_height, m_workers.get());
+        rasters->SetRevision(m_revision);
+        m_rasters = std::move(rasters);
+    }
+}
+
+const TerrainRasters& TerrainEngine::GetRasters() const {
+    std::lock_guard<std::mutex> lock(m_rastersMutex);
+    RefreshRasters();
+    return *m_rasters;
+}
+
+std::shared_ptr<const TerrainRasters> TerrainEngine::GetSharedRasters() const {
+    std::lock_guard<std::mutex> lock(m_rastersMutex);
+    RefreshRasters();
+    return m_rasters;
+}
+
+std::shared_ptr<const PathFinder> TerrainEngine::GetPathFinder() const {
+    std::lock_guard<std::mutex> lock(m_rastersMutex);
+    RefreshRasters();
+    if (m_rasters->IsEmpty()) return nullptr;
+    if (!m_pathFinder || m_pathFinder->GetRevision() != m_rasters->GetRevision()) {
+        auto finder = std::make_shared<PathFinder>();
+        finder->Build(m_rasters, PathFinder::DefaultClusterSize, m_workers.get());
+        m_pathFinder = std::move(finder);
+    }
+    return m_pathFinder;
+}
+
+void TerrainEngine::AdoptPathFinder(std::shared_ptr<const PathFinder> finder) const {
+    std::lock_guard<std::mutex> lock(m_rastersMutex);
+    if (finder && !m_rasters->IsEmpty() && finder->GetRevision() == m_rasters->GetRevision()) {
+        m_pathFinder = std::move(finder);
+    }
+}
+
+void TerrainEngine::ClearRasters() {
+    std::lock_guard<std::mutex> lock(m_rastersMutex);
+    m_rasters = std::make_shared<TerrainRasters>();
+    m_pathFinder.reset();
+}
+
+bool TerrainEngine::RegionMinMax(const GridRect& rect, float& minHeight, float& maxHeight) const {
+    if (!m_tiles) return m_pyramid.RegionMinMax(rect, minHeight, maxHeight);
+    
+    // Tiled terrain has no pyramid: scan the rectangle through the tile cache
+    GridRect clipped{std::max(rect.x0, 0), std::max(rect.z0, 0), std::min(rect.x1, m_width - 1), std::min(rect.z1, m_height - 1)};
+    if (clipped.x0 > clipped.x1 || clipped.z0 > clipped.z1) return false;
+    TileStore::Reader reader(*m_tiles);
+    minHeight = std::numeric_limits<float>::infinity();
+    maxHeight = -minHeight;
+    for (int z = clipped.z0; z <= clipped.z1; ++z) {
+        for (int x = clipped.x0; x <= clipped.x1; ++x) {
+            float h = reader.At(x, z);
+            minHeight = std::min(minHeight, h);
+            maxHeight = std::max(maxHeight, h);
+        }
+    }
+    return true;
 }
 
 glm::vec3 TerrainEngine::GetTerrainSize() const {
+    if (m_tiles) {
+        float lo, hi;
+        m_tiles->GetHeightRange(lo, hi);
+        return glm::vec3(m_width, hi - lo, m_height);
+    }
     return glm::vec3(m_width, m_maxHeight - m_minHeight, m_height);
 }
 
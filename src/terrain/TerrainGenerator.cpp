@@ -0,0 +1,115 @@
+#include "terrain/TerrainGenerator.h"
+#include "core/Random.h"
+#include "core/WorkerPool.h"
+#include <cmath>
+#include <vector>
+
+namespace TS {
+
+namespace {
+
+const uint64_t ParameterStream = 0x7e44a1ull;
+
+// 10-bit field of a hash mapped to [-1, 1]
+inline float SignedField(uint64_t hash, int field) {
+    return (float)((hash >> (10 * field)) & 1023u) * (2.0f / 1023.0f) - 1.0f;
+}
+
+}
+
+TerrainGenerator::TerrainGenerator(uint64_t seed) : m_seed(seed) {
+    // Same ranges the generator always used: very low base frequency for massive mountain ranges,
+    // 120-200 amplitude for steep slopes
+    m_amplitude = 120.0f + (HashToUnitFloat(CounterHash(seed, ParameterStream, 0)) * 2.0f - 1.0f) * 80.0f;
+    m_frequency = 0.0008f + std::floor(HashToUnitFloat(CounterHash(seed, ParameterStream, 1)) * 5000.0f) * 0.0000003f;
+    m_complexity = 1.2f + (0.6f + HashToUnitFloat(CounterHash(seed, ParameterStream, 2)) * 0.8f) * 0.5f;
+}
+
+float TerrainGenerator::Noise(int x, int z) const {
+    // One hash per vertex feeds the per-octave jitter (shrinking with the amplitude) and the
+    // final detail noise
+    uint64_t hash = CounterHash(m_seed, (uint32_t)z, (uint32_t)x);
+    float octaves = SignedField(hash, 0) + SignedField(hash, 1) * 0.5f + SignedField(hash, 2) * 0.25f +
+                    SignedField(hash, 3) * 0.125f + SignedField(hash, 4) * 0.0625f;
+    return octaves * 0.045f * m_amplitude + SignedField(hash, 5) * 0.15f;
+}
+
+void TerrainGenerator::GenerateBlock(int x0, int z0, int width, int height, float* out, size_t stride,
+                                     WorkerPool* workers) const {
+    if (width <= 0 || height <= 0) return;
+    
+    // Each octave's terms are products of a function of x and a function of z, so the trig
+    // runs once per column and once per row. Per cell the sum is a multiply-add over
+    // contiguous column tables, which the compiler vectorizes.
+    const int productTerms = 3 * Octaves;
+    std::vector<float> columns((size_t)(productTerms + 1) * width);
+    float* columnSum = &columns[(size_t)productTerms * width];
+    for (int x = 0; x < width; ++x) columnSum[x] = 0.0f;
+    
+    float amplitude = m_amplitude;
+    float frequency = m_frequency;
+    for (int octave = 0; octave < Octaves; ++octave) {
+        float* ridges = &columns[(size_t)(3 * octave) * width];
+        float* swells = ridges + width;
+        float* peaks = swells + width;
+        for (int x = 0; x < width; ++x) {
+            float sx = (x0 + x) * frequency;
+            ridges[x] = std::sin(sx * m_complexity);
+            swells[x] = std::cos(sx * 1.3f);
+            peaks[x] = std::sin(sx * 4.0f);
+            columnSum[x] += std::sin(sx * 2.1f + m_complexity) * amplitude * 0.7f;
+        }
+        amplitude *= 0.5f;
+        frequency *= 2.0f;
+    }
+    
+    auto generateRows = [&](size_t begin, size_t end) {
+        float rowTerms[3 * Octaves];
+        for (size_t row = begin; row < end; ++row) {
+            const int z = z0 + (int)row;
+            
+            float rowSum = 0.0f;
+            float a = m_amplitude;
+            float f = m_frequency;
+            for (int octave = 0; octave < Octaves; ++octave) {
+                float sz = z * f;
+                rowTerms[3 * octave] = std::cos(sz) * a;
+                rowTerms[3 * octave + 1] = std::sin(sz * 0.9f * m_complexity) * a * 0.9f;
+                rowTerms[3 * octave + 2] = std::cos(sz * 4.0f) * a * 0.4f;
+                rowSum += std::cos(sz * 1.7f + m_complexity) * a * 0.6f;  // Additional steepness
+                a *= 0.5f;
+                f *= 2.0f;
+            }
+            
+            float* target = out + row * stride;
+            for (int x = 0; x < width; ++x) {
+                target[x] = columnSum[x] + rowSum;
+            }
+            for (int term = 0; term < productTerms; ++term) {
+                const float* column = &columns[(size_t)term * width];
+                const float k = rowTerms[term];
+                for (int x = 0; x < width; ++x) {
+                    target[x] += column[x] * k;
+                }
+            }
+            for (int x = 0; x < width; ++x) {
+                target[x] += Noise(x0 + x, z);
+            }
+        }
+    };
+    
+    if (workers) {
+        workers->ParallelFor((size_t)height, generateRows);
+    } else {
+        generateRows(0, (size_t)height);
+    }
+}
+
+float TerrainGenerator::HeightAt(int x, int z) const {
+    // A 1x1 block runs the same arithmetic in the same order as any larger one
+    float height;
+    GenerateBlock(x, z, 1, 1, &height, 1);
+    return height;
+}
+
+}
@@ -0,0 +1,416 @@
+#include "terrain/TerrainLOD.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace TS {
+
+namespace {
+
+struct NodeRef {
+    int level, x, z;
+};
+
+const int NeighbourX[4] = {-1, 1, 0, 0};   // West, east, north, south: matches the stitch bits
+const int NeighbourZ[4] = {0, 0, -1, 1};
+
+}
+
+TerrainLOD::TerrainLOD(const float* heights, int width, int height, float scale, const TerrainLODSettings& settings,
+                       WorkerPool* workers)
+    : m_heights(heights), m_width(width), m_height(height), m_scale(scale), m_settings(settings),
+      m_errorToPixels(0.0f), m_ebos(), m_frame(0), m_building(0), m_stopping(false) {
+    // Power of two so every odd edge vertex has even neighbours; at most 256^2 vertices for 16-bit indices
+    int cells = 2;
+    while (cells < settings.chunkCells && cells < 128) cells *= 2;
+    m_settings.chunkCells = cells;
+    SetProjection(settings.fovY, settings.viewportHeight);
+    
+    const int extent = std::max(std::max(width, height) - 1, 1);
+    for (int level = 0;; ++level) {
+        const int span = cells << level;
+        Level info;
+        info.nodesX = std::max((width - 1 + span - 1) / span, 1);
+        info.nodesZ = std::max((height - 1 + span - 1) / span, 1);
+        const size_t nodes = (size_t)info.nodesX * info.nodesZ;
+        info.error.assign(nodes, 0.0f);
+        info.minY.assign(nodes, 0.0f);
+        info.maxY.assign(nodes, 0.0f);
+        info.split.assign(nodes, 0);
+        m_levels.push_back(std::move(info));
+        if (span >= extent) break;
+    }
+    
+    ComputeErrors(workers);
+    BuildIndices();
+    
+    // The root is always drawable, so a selection is never empty
+    const int root = (int)m_levels.size() - 1;
+    m_chunks[MakeKey(root, 0, 0)] = BuildChunk(root, 0, 0);
+    
+    for (int i = 0; i < std::max(settings.builderThreads, 1); ++i) {
+        m_builders.emplace_back(&TerrainLOD::BuilderLoop, this);
+    }
+}
+
+TerrainLOD::~TerrainLOD() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& builder : m_builders) {
+        builder.join();
+    }
+    
+    ReleaseBuffers();
+}
+
+void TerrainLOD::SetProjection(float fovY, float viewportHeight) {
+    m_settings.fovY = fovY;
+    m_settings.viewportHeight = viewportHeight;
+    m_errorToPixels = viewportHeight / (2.0f * std::tan(fovY * 0.5f));
+}
+
+float TerrainLOD::HeightAt(int x, int z) const {
+    x = std::clamp(x, 0, m_width - 1);
+    z = std::clamp(z, 0, m_height - 1);
+    return m_heights[(size_t)z * m_width + x] * m_scale;
+}
+
+float TerrainLOD::GetGeometricError(int level, int nodeX, int nodeZ) const {
+    const Level& info = m_levels[level];
+    return info.error[(size_t)nodeZ * info.nodesX + nodeX];
+}
+
+void TerrainLOD::ComputeErrors(WorkerPool* workers) {
+    const int cells = m_settings.chunkCells;
+    
+    // Level 0 matches the grid exactly; only its height bounds are needed
+    Level& finest = m_levels[0];
+    for (int nz = 0; nz < finest.nodesZ; ++nz) {
+        for (int nx = 0; nx < finest.nodesX; ++nx) {
+            float lo = HeightAt(nx * cells, nz * cells), hi = lo;
+            for (int z = 0; z <= cells; ++z) {
+                for (int x = 0; x <= cells; ++x) {
+                    float h = HeightAt(nx * cells + x, nz * cells + z);
+                    lo = std::min(lo, h);
+                    hi = std::max(hi, h);
+                }
+            }
+            finest.minY[(size_t)nz * finest.nodesX + nx] = lo;
+            finest.maxY[(size_t)nz * finest.nodesX + nx] = hi;
+        }
+    }
+    
+    for (size_t level = 1; level < m_levels.size(); ++level) {
+        Level& info = m_levels[level];
+        const Level& child = m_levels[level - 1];
+        const int step = 1 << level;
+        const float toLocal = 1.0f / step;
+        
+        auto measureRows = [&](size_t begin, size_t end) {
+            for (int nz = (int)begin; nz < (int)end; ++nz) {
+                for (int nx = 0; nx < info.nodesX; ++nx) {
+                    // Largest gap between this chunk's triangles and every full-resolution vertex under them
+                    float deviation = 0.0f;
+                    for (int qz = 0; qz < cells; ++qz) {
+                        for (int qx = 0; qx < cells; ++qx) {
+                            const int x0 = nx * (cells << level) + qx * step;
+                            const int z0 = nz * (cells << level) + qz * step;
+                            if (x0 >= m_width - 1 || z0 >= m_height - 1) continue;
+                            const float topLeft = HeightAt(x0, z0), topRight = HeightAt(x0 + step, z0);
+                            const float bottomLeft = HeightAt(x0, z0 + step), bottomRight = HeightAt(x0 + step, z0 + step);
+                            for (int z = 0; z <= step; ++z) {
+                                for (int x = 0; x <= step; ++x) {
+                                    // Same diagonal as the index lists: top-right to bottom-left
+                                    float u = x * toLocal, v = z * toLocal;
+                                    float surface = u + v <= 1.0f
+                                        ? topLeft + u * (topRight - topLeft) + v * (bottomLeft - topLeft)
+                                        : bottomRight + (1.0f - u) * (bottomLeft - bottomRight) + (1.0f - v) * (topRight - bottomRight);
+                                    deviation = std::max(deviation, std::fabs(HeightAt(x0 + x, z0 + z) - surface));
+                                }
+                            }
+                        }
+                    }
+                    
+                    float childError = 0.0f;
+                    float lo = std::numeric_limits<float>::max(), hi = std::numeric_limits<float>::lowest();
+                    for (int c = 0; c < 4; ++c) {
+                        int cx = 2 * nx + (c & 1), cz = 2 * nz + (c >> 1);
+                        if (cx >= child.nodesX || cz >= child.nodesZ) continue;
+                        size_t index = (size_t)cz * child.nodesX + cx;
+                        childError = std::max(childError, child.error[index]);
+                        lo = std::min(lo, child.minY[index]);
+                        hi = std::max(hi, child.maxY[index]);
+                    }
+                    
+                    const size_t index = (size_t)nz * info.nodesX + nx;
+                    info.error[index] = std::max(deviation, childError);
+                    info.minY[index] = lo;
+                    info.maxY[index] = hi;
+                }
+            }
+        };
+        
+        // Every level reads the whole grid once; rows of chunks are independent
+        if (workers) {
+            workers->ParallelFor((size_t)info.nodesZ, measureRows);
+        } else {
+            measureRows(0, (size_t)info.nodesZ);
+        }
+    }
+}
+
+void TerrainLOD::BuildIndices() {
+    const int cells = m_settings.chunkCells;
+    const int side = cells + 1;
+    
+    for (int stitch = 0; stitch < 16; ++stitch) {
+        // Odd vertices on a stitched edge collapse onto an even neighbour, leaving that edge with
+        // the coarser chunk's vertices only. The direction keeps every triangle's winding.
+        auto vertex = [&](int i, int j) {
+            if ((stitch & StitchWest) && i == 0 && (j & 1)) j -= 1;
+            if ((stitch & StitchEast) && i == cells && (j & 1)) j += 1;
+            if ((stitch & StitchNorth) && j == 0 && (i & 1)) i -= 1;
+            if ((stitch & StitchSouth) && j == cells && (i & 1)) i += 1;
+            return (uint16_t)(j * side + i);
+        };
+        auto emit = [&](uint16_t a, uint16_t b, uint16_t c) {
+            if (a == b || b == c || a == c) return;
+            m_indices[stitch].push_back(a);
+            m_indices[stitch].push_back(b);
+            m_indices[stitch].push_back(c);
+        };
+        
+        m_indices[stitch].reserve((size_t)cells * cells * 6);
+        for (int j = 0; j < cells; ++j) {
+            for (int i = 0; i < cells; ++i) {
+                // Same split as TerrainMesh: top-left, bottom-left, top-right / top-right, bottom-left, bottom-right
+                emit(vertex(i, j), vertex(i, j + 1), vertex(i + 1, j));
+                emit(vertex(i + 1, j), vertex(i, j + 1), vertex(i + 1, j + 1));
+            }
+        }
+    }
+}
+
+std::unique_ptr<TerrainLOD::Chunk> TerrainLOD::BuildChunk(int level, int nodeX, int nodeZ) const {
+    const int cells = m_settings.chunkCells;
+    const int step = 1 << level;
+    
+    auto chunk = std::make_unique<Chunk>();
+    chunk->level = level;
+    chunk->x0 = nodeX * (cells << level);
+    chunk->z0 = nodeZ * (cells << level);
+    chunk->vertices.resize((size_t)(cells + 1) * (cells + 1));
+    
+    TerrainVertex* vertex = chunk->vertices.data();
+    for (int j = 0; j <= cells; ++j) {
+        // Chunks past the grid's far edge are clamped onto it
+        const int z = std::min(chunk->z0 + j * step, m_height - 1);
+        for (int i = 0; i <= cells; ++i, ++vertex) {
+            const int x = std::min(chunk->x0 + i * step, m_width - 1);
+            
+            vertex->position = glm::vec3((float)x - m_width * 0.5f, HeightAt(x, z), (float)z - m_height * 0.5f);
+            vertex->texCoord = glm::vec2((float)x / (m_width - 1), (float)z / (m_height - 1));
+            
+            // Full-resolution normals, as TerrainMesh computes them, so lighting does not pop between levels
+            glm::vec3 normal(0.0f, 1.0f, 0.0f);
+            if (x > 0 && x < m_width - 1 && z > 0 && z < m_height - 1) {
+                const float* row = m_heights + (size_t)z * m_width;
+                normal = glm::normalize(glm::vec3((row[x - 1] - row[x + 1]) * 0.5f, 2.0f,
+                                                  (row[x - m_width] - row[x + m_width]) * 0.5f));
+            }
+            vertex->normal = normal;
+            vertex->color = TerrainPalette[TerrainPaletteIndex(vertex->position.y)];
+        }
+    }
+    return chunk;
+}
+
+void TerrainLOD::BuilderLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+        if (m_stopping) return;
+        
+        uint64_t key = m_queue.front();
+        m_queue.pop_front();
+        m_building++;
+        lock.unlock();
+        
+        auto chunk = BuildChunk((int)(key >> 56), (int)(key & 0xfffffff), (int)((key >> 28) & 0xfffffff));
+        
+        lock.lock();
+        m_chunks[key] = std::move(chunk);
+        m_queued.erase(key);
+        m_building--;
+        if (m_queue.empty() && m_building == 0) m_idle.notify_all();
+    }
+}
+
+void TerrainLOD::WaitForBuilds() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_queue.empty() && m_building == 0; });
+}
+
+bool TerrainLOD::IsSplit(int level, int nodeX, int nodeZ) const {
+    const Level& info = m_levels[level];
+    if (nodeX < 0 || nodeZ < 0 || nodeX >= info.nodesX || nodeZ >= info.nodesZ) return false;
+    return info.split[(size_t)nodeZ * info.nodesX + nodeX] != 0;
+}
+
+bool TerrainLOD::Exists(int level, int nodeX, int nodeZ) const {
+    const Level& info = m_levels[level];
+    if (nodeX < 0 || nodeZ < 0 || nodeX >= info.nodesX || nodeZ >= info.nodesZ) return false;
+    // Split bits below an unsplit node are stale, so walk all the way up
+    for (int parent = level + 1; parent < (int)m_levels.size(); ++parent) {
+        nodeX >>= 1;
+        nodeZ >>= 1;
+        if (!IsSplit(parent, nodeX, nodeZ)) return false;
+    }
+    return true;
+}
+
+float TerrainLOD::ProjectedError(int level, int nodeX, int nodeZ, const glm::vec3& eye) const {
+    const Level& info = m_levels[level];
+    const size_t index = (size_t)nodeZ * info.nodesX + nodeX;
+    const int span = m_settings.chunkCells << level;
+    
+    // Distance from the eye to the chunk's bounding box
+    glm::vec3 lo((float)(nodeX * span) - m_width * 0.5f, info.minY[index], (float)(nodeZ * span) - m_height * 0.5f);
+    glm::vec3 hi(lo.x + span, info.maxY[index], lo.z + span);
+    glm::vec3 nearest(std::clamp(eye.x, lo.x, hi.x), std::clamp(eye.y, lo.y, hi.y), std::clamp(eye.z, lo.z, hi.z));
+    float distance = glm::length(eye - nearest);
+    return info.error[index] * m_errorToPixels / std::max(distance, 1e-3f);
+}
+
+const std::vector<TerrainLOD::DrawItem>& TerrainLOD::Select(const glm::vec3& eye) {
+    auto start = std::chrono::steady_clock::now();
+    m_frame++;
+    const int root = (int)m_levels.size() - 1;
+    for (Level& info : m_levels) std::fill(info.split.begin(), info.split.end(), 0);
+    
+    // 1. Split wherever the projected error is too large
+    std::vector<std::vector<NodeRef>> splits(m_levels.size());
+    std::vector<NodeRef> stack = {{root, 0, 0}};
+    while (!stack.empty()) {
+        NodeRef node = stack.back();
+        stack.pop_back();
+        if (node.level == 0 || ProjectedError(node.level, node.x, node.z, eye) <= m_settings.pixelTolerance) continue;
+        
+        Level& info = m_levels[node.level];
+        info.split[(size_t)node.z * info.nodesX + node.x] = 1;
+        splits[node.level].push_back(node);
+        const Level& child = m_levels[node.level - 1];
+        for (int c = 0; c < 4; ++c) {
+            int cx = 2 * node.x + (c & 1), cz = 2 * node.z + (c >> 1);
+            if (cx < child.nodesX && cz < child.nodesZ) stack.push_back({node.level - 1, cx, cz});
+        }
+    }
+    
+    // 2. A split chunk needs all its same-level neighbours, so adjacent chunks end up at most one
+    // level apart. Splitting a neighbour's parent splits its ancestors too; each is balanced in turn.
+    auto forceSplit = [&](int level, int x, int z) {
+        for (; level <= root; ++level, x >>= 1, z >>= 1) {
+            Level& info = m_levels[level];
+            uint8_t& split = info.split[(size_t)z * info.nodesX + x];
+            if (split) return;
+            split = 1;
+            splits[level].push_back({level, x, z});
+        }
+    };
+    for (int level = 1; level < root; ++level) {
+        const Level& info = m_levels[level];
+        for (const NodeRef& node : splits[level]) {
+            for (int n = 0; n < 4; ++n) {
+                int x = node.x + NeighbourX[n], z = node.z + NeighbourZ[n];
+                if (x >= 0 && z >= 0 && x < info.nodesX && z < info.nodesZ) forceSplit(level + 1, x >> 1, z >> 1);
+            }
+        }
+    }
+    
+    // 3. Coarse to fine: keep a split only when its children's meshes are built and it still has all
+    // of its neighbours, queue what is missing and emit the leaves
+    m_selection.clear();
+    m_stats = FrameStats();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (uint64_t key : m_queue) m_queued.erase(key);
+    m_queue.clear();
+    auto request = [this](uint64_t key) {
+        if (m_queued.insert(key).second) m_queue.push_back(key);
+    };
+    
+    std::deque<NodeRef> pending = {{root, 0, 0}};
+    while (!pending.empty()) {
+        NodeRef node = pending.front();
+        pending.pop_front();
+        Level& info = m_levels[node.level];
+        uint8_t& split = info.split[(size_t)node.z * info.nodesX + node.x];
+        // Only nodes whose mesh is built get this far
+        Chunk* chunk = m_chunks.find(MakeKey(node.level, node.x, node.z))->second.get();
+        chunk->lastUsedFrame = m_frame;
+        
+        if (split) {
+            const Level& child = m_levels[node.level - 1];
+            for (int c = 0; c < 4; ++c) {
+                int cx = 2 * node.x + (c & 1), cz = 2 * node.z + (c >> 1);
+                if (cx >= child.nodesX || cz >= child.nodesZ) continue;
+                uint64_t key = MakeKey(node.level - 1, cx, cz);
+                if (m_chunks.find(key) == m_chunks.end()) {
+                    request(key);
+                    split = 0;
+                }
+            }
+            for (int n = 0; n < 4 && split; ++n) {
+                int x = node.x + NeighbourX[n], z = node.z + NeighbourZ[n];
+                if (x >= 0 && z >= 0 && x < info.nodesX && z < info.nodesZ && !Exists(node.level, x, z)) split = 0;
+            }
+        }
+        
+        if (split) {
+            const Level& child = m_levels[node.level - 1];
+            for (int c = 0; c < 4; ++c) {
+                int cx = 2 * node.x + (c & 1), cz = 2 * node.z + (c >> 1);
+                if (cx < child.nodesX && cz < child.nodesZ) pending.push_back({node.level - 1, cx, cz});
+            }
+            continue;
+        }
+        
+        uint8_t stitch = 0;
+        for (int n = 0; n < 4; ++n) {
+            int x = node.x + NeighbourX[n], z = node.z + NeighbourZ[n];
+            if (x >= 0 && z >= 0 && x < info.nodesX && z < info.nodesZ && !Exists(node.level, x, z)) stitch |= 1 << n;
+        }
+        m_selection.push_back({chunk, stitch});
+        m_stats.triangles += m_indices[stitch].size() / 3;
+        m_stats.finestLevel = m_stats.chunks == 0 ? node.level : std::min(m_stats.finestLevel, node.level);
+        m_stats.chunks++;
+    }
+    
+    // Least recently used chunks go first once the cache is over budget
+    if (m_chunks.size() > m_settings.maxCachedChunks) {
+        std::vector<std::pair<uint64_t, uint64_t>> stale;
+        for (auto& entry : m_chunks) {
+            if (entry.second->lastUsedFrame < m_frame) stale.emplace_back(entry.second->lastUsedFrame, entry.first);
+        }
+        std::sort(stale.begin(), stale.end());
+        size_t excess = std::min(m_chunks.size() - m_settings.maxCachedChunks, stale.size());
+        for (size_t i = 0; i < excess; ++i) {
+            auto it = m_chunks.find(stale[i].second);
+            if (it->second->vbo) m_retiredBuffers.push_back(it->second->vbo);
+            m_chunks.erase(it);
+        }
+    }
+    
+    m_stats.queuedBuilds = m_queue.size();
+    m_stats.cachedChunks = m_chunks.size();
+    lock.unlock();
+    if (!m_queue.empty()) m_wake.notify_all();
+    
+    m_stats.selectSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return m_selection;
+}
+
+}
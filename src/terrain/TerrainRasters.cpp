@@ -0,0 +1,97 @@
+#include "terrain/TerrainRasters.h"
+#include "core/WorkerPool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace TS {
+
+TerrainRasters::TerrainRasters() : m_width(0), m_height(0), m_revision(0) {}
+
+void TerrainRasters::Clear() {
+    m_width = m_height = 0;
+    m_revision = 0;
+    m_slope.clear();
+    m_aspect.clear();
+    for (std::vector<float>& cost : m_cost) cost.clear();
+}
+
+void TerrainRasters::Build(const float* heights, int width, int height, WorkerPool* workers) {
+    Clear();
+    if (!heights || width < 2 || height < 2) return;
+    m_width = width;
+    m_height = height;
+    const size_t count = (size_t)width * height;
+    m_slope.resize(count);
+    m_aspect.resize(count);
+    for (std::vector<float>& cost : m_cost) cost.resize(count);
+    
+    // Each row runs as a handful of straight loops over contiguous floats, so the compiler
+    // vectorizes everything but atan2
+    auto buildRows = [&](size_t begin, size_t end) {
+        std::vector<float> gradientX(width), gradientZ(width);
+        float* gx = gradientX.data();
+        float* gz = gradientZ.data();
+        const float inf = std::numeric_limits<float>::infinity();
+        
+        for (size_t z = begin; z < end; ++z) {
+            const float* row = heights + z * width;
+            // Central differences inside, one-sided on the border
+            const float* previous = z > 0 ? row - width : row;
+            const float* next = z + 1 < (size_t)height ? row + width : row;
+            const float zScale = z > 0 && z + 1 < (size_t)height ? 0.5f : 1.0f;
+            
+            for (int x = 1; x < width - 1; ++x) gx[x] = (row[x + 1] - row[x - 1]) * 0.5f;
+            gx[0] = row[1] - row[0];
+            gx[width - 1] = row[width - 1] - row[width - 2];
+            for (int x = 0; x < width; ++x) gz[x] = (next[x] - previous[x]) * zScale;
+            
+            float* slope = &m_slope[z * width];
+            for (int x = 0; x < width; ++x) slope[x] = std::sqrt(gx[x] * gx[x] + gz[x] * gz[x]);
+            
+            for (int m = 0; m < MobilityCount; ++m) {
+                const float maxSlope = MobilityProfiles[m].maxSlope;
+                const float slopeCost = MobilityProfiles[m].slopeCost;
+                float* cost = &m_cost[m][z * width];
+                // Arithmetic and threshold in separate loops: a select between the computed cost
+                // and infinity is not vectorized while floating-point compares may trap, a blend is
+                for (int x = 0; x < width; ++x) cost[x] = 1.0f + slopeCost * slope[x];
+                for (int x = 0; x < width; ++x) cost[x] = slope[x] > maxSlope ? inf : cost[x];
+            }
+            
+            // 0 - g rather than -g keeps flat ground at atan2(+0, +0) = 0 instead of -pi
+            float* aspect = &m_aspect[z * width];
+            for (int x = 0; x < width; ++x) aspect[x] = std::atan2(0.0f - gz[x], 0.0f - gx[x]);
+        }
+    };
+    
+    if (workers) {
+        workers->ParallelFor((size_t)height, buildRows);
+    } else {
+        buildRows(0, (size_t)height);
+    }
+}
+
+size_t TerrainRasters::NearestVertex(float x, float z) const {
+    int ix = std::clamp((int)std::lround(x + m_width * 0.5f), 0, m_width - 1);
+    int iz = std::clamp((int)std::lround(z + m_height * 0.5f), 0, m_height - 1);
+    return (size_t)iz * m_width + ix;
+}
+
+float TerrainRasters::CostAt(Mobility mobility, float x, float z) const {
+    if (IsEmpty()) return 1.0f;
+    return m_cost[(int)mobility][NearestVertex(x, z)];
+}
+
+float TerrainRasters::SlopeAt(float x, float z) const {
+    if (IsEmpty()) return 0.0f;
+    return m_slope[NearestVertex(x, z)];
+}
+
+size_t TerrainRasters::GetMemoryBytes() const {
+    size_t bytes = (m_slope.capacity() + m_aspect.capacity()) * sizeof(float);
+    for (const std::vector<float>& cost : m_cost) bytes += cost.capacity() * sizeof(float);
+    return bytes;
+}
+
+}
@@ -0,0 +1,220 @@
+#include "terrain/TerrainEngine.h"
+#include "terrain/TerrainLOD.h"
+#include "graphics/Camera.h"
+#include <OpenGL/gl.h>
+#include <cstddef>
+
+// Everything that talks to OpenGL. The windowed app links this file; the headless runner and
+// the benchmarks link TerrainRenderHeadless.cpp instead and need no GL headers or libraries.
+
+namespace TS {
+
+namespace {
+
+// Use enhanced vertical scale for steeper appearance
+const float MeshHeightScale = 3.0f;  // Triple the vertical scale for extremely steep terrain
+
+}
+
+void TerrainMesh::ReleaseBuffers() {
+    if (m_VAO) glDeleteVertexArraysAPPLE(1, &m_VAO);
+    if (m_VBO) glDeleteBuffers(1, &m_VBO);
+    if (m_EBO) glDeleteBuffers(1, &m_EBO);
+    m_VAO = m_VBO = m_EBO = 0;
+}
+
+void TerrainMesh::GenerateFromHeightmap(const float* heightData, int width, int height, float scale) {
+    BuildGeometry(heightData, width, height, scale);
+    SetupMesh();
+}
+
+void TerrainMesh::SetupMesh() {
+    // Regenerated terrain replaces the previous buffers instead of leaking them
+    ReleaseBuffers();
+    
+    glGenVertexArraysAPPLE(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    glGenBuffers(1, &m_EBO);
+    
+    glBindVertexArrayAPPLE(m_VAO);
+    
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(TerrainVertex), 
+                 m_vertices.data(), GL_STATIC_DRAW);
+    
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int),
+                 m_indices.data(), GL_STATIC_DRAW);
+    
+    // Position attribute
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(TerrainVertex), (void*)0);
+    
+    // Normal attribute
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TerrainVertex), 
+                         (void*)offsetof(TerrainVertex, normal));
+    
+    // Color attribute
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(TerrainVertex), 
+                         (void*)offsetof(TerrainVertex, color));
+    
+    glBindVertexArrayAPPLE(0);
+}
+
+void TerrainMesh::Render() {
+    if (m_VAO && !m_indices.empty()) {
+        glBindVertexArrayAPPLE(m_VAO);
+        glDrawElements(GL_TRIANGLE_STRIP, m_indices.size(), GL_UNSIGNED_INT, 0);
+        glBindVertexArrayAPPLE(0);
+    }
+}
+
+void TerrainEngine::Render() {
+    // Tiled terrain is far too large for a single mesh
+    if (m_terrainMesh && m_heights) {
+        if (m_meshDirty) {
+            m_terrainMesh->GenerateFromHeightmap(m_heights, m_width, m_height, MeshHeightScale);
+            m_meshDirty = false;
+        }
+        
+        // Render the base terrain mesh
+        m_terrainMesh->Render();
+        
+        // Render contour lines on top
+        RenderContourLines();
+    }
+}
+
+void TerrainEngine::Render(const Camera& camera, float viewportHeight) {
+    if (!m_heights) return;
+    
+    // Dropped whenever the heights change, see GenerateRandomTerrain and LoadTerrain
+    if (!m_lod) {
+        m_lod = std::make_unique<TerrainLOD>(m_heights, m_width, m_height, MeshHeightScale, TerrainLODSettings(),
+                                             m_workers.get());
+    }
+    m_lod->SetProjection(glm::radians(camera.GetZoom()), viewportHeight);
+    m_lod->Select(camera.GetPosition());
+    m_lod->Render();
+    
+    RenderContourLines();
+}
+
+void TerrainEngine::RenderContourLines() {
+    if (!m_heights) return;
+    
+    const ContourSet& contours = GetContours();
+    if (!m_contourVBO || m_contourVBORevision != contours.revision) {
+        // One buffer for every level; minor and major polylines differ only in color and width
+        std::vector<glm::vec3> vertices;
+        vertices.reserve(contours.PointCount());
+        m_contourFirsts.clear();
+        m_contourCounts.clear();
+        for (int pass = 0; pass < 2; ++pass) {
+            if (pass == 1) m_minorContourCount = m_contourFirsts.size();
+            for (const ContourLevel& level : contours.levels) {
+                if (level.major != (pass == 1)) continue;
+                for (size_t i = 0; i < level.PolylineCount(); ++i) {
+                    m_contourFirsts.push_back((int)vertices.size());
+                    m_contourCounts.push_back((int)(level.PolylineEnd(i) - level.starts[i]));
+                    for (uint32_t p = level.starts[i]; p < level.PolylineEnd(i); ++p) {
+                        vertices.emplace_back((level.points[p].x - m_width * 0.5f) * m_terrainScale,
+                                              level.elevation * m_terrainScale,
+                                              (level.points[p].y - m_height * 0.5f) * m_terrainScale);
+                    }
+                }
+            }
+        }
+        
+        if (!m_contourVBO) glGenBuffers(1, &m_contourVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_contourVBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
+        m_contourVBORevision = contours.revision;
+    }
+    
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glBindBuffer(GL_ARRAY_BUFFER, m_contourVBO);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, (void*)0);
+    
+    // Minor contour lines in lighter brown
+    glColor3f(0.4f, 0.25f, 0.1f);
+    glLineWidth(1.5f);
+    glMultiDrawArrays(GL_LINE_STRIP, m_contourFirsts.data(), m_contourCounts.data(), (GLsizei)m_minorContourCount);
+    
+    // Major contour lines (every 25 units) in brown
+    glColor3f(0.6f, 0.3f, 0.1f);
+    glLineWidth(2.5f);
+    glMultiDrawArrays(GL_LINE_STRIP, m_contourFirsts.data() + m_minorContourCount,
+                      m_contourCounts.data() + m_minorContourCount,
+                      (GLsizei)(m_contourFirsts.size() - m_minorContourCount));
+    
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_LIGHTING);
+    glLineWidth(1.0f);
+}
+
+void TerrainEngine::ReleaseBuffers() {
+    if (m_contourVBO) glDeleteBuffers(1, &m_contourVBO);
+    m_contourVBO = 0;
+}
+
+void TerrainLOD::Render() {
+    if (!m_retiredBuffers.empty()) {
+        glDeleteBuffers((GLsizei)m_retiredBuffers.size(), m_retiredBuffers.data());
+        m_retiredBuffers.clear();
+    }
+    if (m_selection.empty()) return;
+    
+    if (!m_ebos[0]) {
+        glGenBuffers(16, m_ebos);
+        for (int stitch = 0; stitch < 16; ++stitch) {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebos[stitch]);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices[stitch].size() * sizeof(uint16_t),
+                         m_indices[stitch].data(), GL_STATIC_DRAW);
+        }
+    }
+    
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    for (const DrawItem& item : m_selection) {
+        Chunk* chunk = item.chunk;
+        if (!chunk->vbo) {
+            glGenBuffers(1, &chunk->vbo);
+            glBindBuffer(GL_ARRAY_BUFFER, chunk->vbo);
+            glBufferData(GL_ARRAY_BUFFER, chunk->vertices.size() * sizeof(TerrainVertex),
+                         chunk->vertices.data(), GL_STATIC_DRAW);
+        }
+        
+        glBindBuffer(GL_ARRAY_BUFFER, chunk->vbo);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(TerrainVertex), (void*)0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TerrainVertex), (void*)offsetof(TerrainVertex, normal));
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(TerrainVertex), (void*)offsetof(TerrainVertex, color));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebos[item.stitch]);
+        glDrawElements(GL_TRIANGLES, m_indices[item.stitch].size(), GL_UNSIGNED_SHORT, 0);
+    }
+    glDisableVertexAttribArray(0);
+    glDisableVertexAttribArray(1);
+    glDisableVertexAttribArray(2);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void TerrainLOD::ReleaseBuffers() {
+    for (auto& entry : m_chunks) {
+        if (entry.second->vbo) m_retiredBuffers.push_back(entry.second->vbo);
+    }
+    for (unsigned int ebo : m_ebos) {
+        if (ebo) m_retiredBuffers.push_back(ebo);
+    }
+    if (!m_retiredBuffers.empty()) glDeleteBuffers((GLsizei)m_retiredBuffers.size(), m_retiredBuffers.data());
+    m_retiredBuffers.clear();
+}
+
+}
@@ -0,0 +1,19 @@
+#include "terrain/TerrainEngine.h"
+#include "terrain/TerrainLOD.h"
+
+// Stand-ins for TerrainRender.cpp in builds without a display. Nothing here uploads to a GPU,
+// so there are never buffers to release; the render entry points are left undefined, and
+// calling one fails at link time.
+
+namespace TS {
+
+void TerrainMesh::ReleaseBuffers() {
+}
+
+void TerrainEngine::ReleaseBuffers() {
+}
+
+void TerrainLOD::ReleaseBuffers() {
+}
+
+}
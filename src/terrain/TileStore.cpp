@@ -0,0 +1,246 @@
+#include "terrain/TileStore.h"
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace TS {
+
+RawTileSource::RawTileSource()
+    : m_fd(-1), m_format(HeightmapFormat::RAW_FLOAT32), m_sampleSize(4), m_fileWidth(0),
+      m_originX(0), m_originZ(0), m_width(0), m_height(0), m_heightScale(1.0f) {
+}
+
+RawTileSource::~RawTileSource() {
+    if (m_fd >= 0) close(m_fd);
+}
+
+bool RawTileSource::Open(const std::string& path, const HeightmapLoadOptions& options) {
+    m_format = options.format == HeightmapFormat::AUTO ? HeightmapLoader::FormatFromExtension(path) : options.format;
+    if (m_format != HeightmapFormat::RAW_UINT16 && m_format != HeightmapFormat::RAW_FLOAT32) {
+        std::cerr << "Tiled terrain needs a raw uint16 or float32 heightmap: " << path << std::endl;
+        return false;
+    }
+    m_sampleSize = m_format == HeightmapFormat::RAW_UINT16 ? 2 : 4;
+    m_heightScale = options.heightScale;
+    
+    m_fd = open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+        std::cerr << "Cannot open heightmap: " << path << std::endl;
+        return false;
+    }
+    
+    struct stat info;
+    int fileHeight;
+    if (fstat(m_fd, &info) != 0 ||
+        !HeightmapLoader::ResolveRawDimensions((size_t)info.st_size, m_format, options, m_fileWidth, fileHeight) ||
+        !HeightmapLoader::ResolveWindow(options, m_fileWidth, fileHeight, m_originX, m_originZ, m_width, m_height)) {
+        std::cerr << "Cannot size tiled heightmap: " << path << std::endl;
+        return false;
+    }
+    
+    // Tiles are fetched in whatever order queries touch them
+#ifdef POSIX_FADV_RANDOM
+    posix_fadvise(m_fd, 0, 0, POSIX_FADV_RANDOM);
+#endif
+    return true;
+}
+
+bool RawTileSource::ReadBlock(int x0, int z0, int width, int height, float* out) const {
+    const size_t rowBytes = (size_t)width * m_sampleSize;
+    std::vector<uint16_t> shorts(m_format == HeightmapFormat::RAW_UINT16 ? width : 0);
+    
+    for (int row = 0; row < height; ++row) {
+        off_t offset = (off_t)(((size_t)(m_originZ + z0 + row) * m_fileWidth + m_originX + x0) * m_sampleSize);
+        void* target = m_format == HeightmapFormat::RAW_UINT16 ? (void*)shorts.data() : (void*)(out + (size_t)row * width);
+        if (pread(m_fd, target, rowBytes, offset) != (ssize_t)rowBytes) return false;
+        
+        if (m_format == HeightmapFormat::RAW_UINT16) {
+            float* heights = out + (size_t)row * width;
+            for (int x = 0; x < width; ++x) {
+                heights[x] = shorts[x] * m_heightScale;
+            }
+        }
+    }
+    return true;
+}
+
+bool RawTileSource::ReadPoint(int x, int z, float& height) const {
+    off_t offset = (off_t)(((size_t)(m_originZ + z) * m_fileWidth + m_originX + x) * m_sampleSize);
+    if (m_format == HeightmapFormat::RAW_UINT16) {
+        uint16_t sample;
+        if (pread(m_fd, &sample, sizeof(sample), offset) != (ssize_t)sizeof(sample)) return false;
+        height = sample * m_heightScale;
+        return true;
+    }
+    return pread(m_fd, &height, sizeof(height), offset) == (ssize_t)sizeof(height);
+}
+
+bool ProceduralTileSource::ReadBlock(int x0, int z0, int width, int height, float* out) const {
+    m_generator.GenerateBlock(x0, z0, width, height, out, (size_t)width);
+    return true;
+}
+
+bool ProceduralTileSource::ReadPoint(int x, int z, float& height) const {
+    height = m_generator.HeightAt(x, z);
+    return true;
+}
+
+TileStore::TileStore(std::unique_ptr<TileSource> source, int tileSize, size_t cacheBytes)
+    : m_source(std::move(source)), m_tileSize(std::max(tileSize, 16)), m_stats(),
+      m_minHeight(std::numeric_limits<float>::max()), m_maxHeight(std::numeric_limits<float>::lowest()) {
+    m_width = m_source->GetWidth();
+    m_height = m_source->GetHeight();
+    
+    // A single LOS query can straddle a few tiles; never thrash below that
+    size_t tileBytes = (size_t)(m_tileSize + 1) * (m_tileSize + 1) * sizeof(float);
+    m_capacity = std::max<size_t>(cacheBytes / tileBytes, 4);
+}
+
+std::shared_ptr<TileStore::Tile> TileStore::PageIn(int tileX, int tileZ) const {
+    const int stride = m_tileSize + 1;
+    auto tile = std::make_shared<Tile>();
+    tile->x0 = tileX * m_tileSize;
+    tile->z0 = tileZ * m_tileSize;
+    tile->heights.resize((size_t)stride * stride);
+    
+    // Edge tiles are short of the grid; read what exists and clamp outwards
+    int width = std::min(stride, m_width - tile->x0);
+    int height = std::min(stride, m_height - tile->z0);
+    std::vector<float> block((size_t)width * height);
+    if (!m_source->ReadBlock(tile->x0, tile->z0, width, height, block.data())) {
+        std::cerr << "Failed to page in terrain tile (" << tileX << ", " << tileZ << ")" << std::endl;
+        return nullptr;
+    }
+    
+    for (int z = 0; z < stride; ++z) {
+        const float* source = &block[(size_t)std::min(z, height - 1) * width];
+        float* target = &tile->heights[(size_t)z * stride];
+        std::copy(source, source + width, target);
+        std::fill(target + width, target + stride, source[width - 1]);
+    }
+    return tile;
+}
+
+std::shared_ptr<const TileStore::Tile> TileStore::Acquire(int tileX, int tileZ) const {
+    const uint64_t key = MakeKey(tileX, tileZ);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second);
+            m_stats.hits++;
+            return it->second->second;
+        }
+        m_stats.misses++;
+    }
+    
+    // Paged in without the lock so other threads keep hitting the cache meanwhile
+    std::shared_ptr<Tile> tile = PageIn(tileX, tileZ);
+    if (!tile) return nullptr;
+    
+    auto [lo, hi] = std::minmax_element(tile->heights.begin(), tile->heights.end());
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        // Another thread paged the same tile in first
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return it->second->second;
+    }
+    
+    m_lru.emplace_front(key, tile);
+    m_index[key] = m_lru.begin();
+    m_stats.bytesPagedIn += tile->heights.size() * sizeof(float);
+    m_minHeight = std::min(m_minHeight, *lo);
+    m_maxHeight = std::max(m_maxHeight, *hi);
+    
+    while (m_lru.size() > m_capacity) {
+        m_index.erase(m_lru.back().first);
+        m_lru.pop_back();
+        m_stats.evictions++;
+    }
+    return tile;
+}
+
+float TileStore::Sample(int x, int z) const {
+    const int tileX = TileOf(x, m_width);
+    const int tileZ = TileOf(z, m_height);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(MakeKey(tileX, tileZ));
+        if (it != m_index.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second);
+            m_stats.hits++;
+            const Tile& tile = *it->second->second;
+            return tile.heights[(size_t)(z - tile.z0) * (m_tileSize + 1) + (x - tile.x0)];
+        }
+    }
+    
+    float height;
+    if (m_source->ReadPoint(x, z, height)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.pointReads++;
+        return height;
+    }
+    return Reader(*this).At(x, z);
+}
+
+TileStore::Stats TileStore::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.residentTiles = m_lru.size();
+    stats.residentBytes = m_lru.size() * (size_t)(m_tileSize + 1) * (m_tileSize + 1) * sizeof(float);
+    return stats;
+}
+
+void TileStore::ResetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats = Stats();
+}
+
+void TileStore::GetHeightRange(float& minHeight, float& maxHeight) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool empty = m_minHeight > m_maxHeight;
+    minHeight = empty ? 0.0f : m_minHeight;
+    maxHeight = empty ? 0.0f : m_maxHeight;
+}
+
+void TileStore::Reader::Seek(int tileX, int tileZ) {
+    m_tile = m_store->Acquire(tileX, tileZ);
+    m_tileX = tileX;
+    m_tileZ = tileZ;
+}
+
+void TileStore::Reader::Cell(int x, int z, float h[4]) {
+    const int size = m_store->m_tileSize;
+    // The last row and column of vertices belong to the tile before them
+    int tileX = m_store->TileOf(x, m_store->m_width);
+    int tileZ = m_store->TileOf(z, m_store->m_height);
+    if (tileX != m_tileX || tileZ != m_tileZ) Seek(tileX, tileZ);
+    if (!m_tile) {
+        h[0] = h[1] = h[2] = h[3] = 0.0f;
+        return;
+    }
+    
+    const int stride = size + 1;
+    const float* row0 = &m_tile->heights[(size_t)(z - m_tile->z0) * stride + (x - m_tile->x0)];
+    const float* row1 = row0 + stride;
+    h[0] = row0[0];
+    h[1] = row0[1];
+    h[2] = row1[0];
+    h[3] = row1[1];
+}
+
+float TileStore::Reader::At(int x, int z) {
+    const int size = m_store->m_tileSize;
+    int tileX = m_store->TileOf(x, m_store->m_width);
+    int tileZ = m_store->TileOf(z, m_store->m_height);
+    if (tileX != m_tileX || tileZ != m_tileZ) Seek(tileX, tileZ);
+    if (!m_tile) return 0.0f;
+    return m_tile->heights[(size_t)(z - m_tile->z0) * (size + 1) + (x - m_tile->x0)];
+}
+
+}